@@ -0,0 +1,56 @@
+#include "cobs.h"
+
+
+uint16_t cobs_encode(const uint8_t* src, const uint16_t len, uint8_t* dst) {
+    const uint8_t* end = src + len;
+    uint8_t* start = dst;
+    uint8_t* codePtr = dst++; // position of the code byte of the current block
+    uint8_t code = 1;
+
+    while (src < end) {
+        uint8_t data = *src++;
+        if (data == 0) {
+            // zero byte terminates the current block
+            *codePtr = code;
+            codePtr = dst++;
+            code = 1;
+        } else {
+            *dst++ = data;
+            if (++code == 0xFF) {
+                // block is full, start a new one without implied zero byte
+                *codePtr = code;
+                codePtr = dst++;
+                code = 1;
+            }
+        }
+    }
+
+    // close last block
+    *codePtr = code;
+    return (uint16_t)(dst - start);
+}
+
+
+bool cobs_decode(const uint8_t* src, const uint16_t len, uint8_t* dst, uint16_t* decodedLen) {
+    const uint8_t* end = src + len;
+    uint8_t* start = dst;
+
+    while (src < end) {
+        uint8_t code = *src++;
+        if (code == 0)
+            return false; // zero bytes must not occur in encoded data
+        if (code - 1 > end - src)
+            return false; // block exceeds end of data
+
+        // copy data bytes of the block
+        for (uint8_t i = 1; i < code; i++)
+            *dst++ = *src++;
+
+        // all blocks except the last one and full blocks imply a zero byte
+        if ((code != 0xFF) && (src < end))
+            *dst++ = 0;
+    }
+
+    *decodedLen = (uint16_t)(dst - start);
+    return true;
+}
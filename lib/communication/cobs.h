@@ -0,0 +1,63 @@
+/**
+ * @file cobs.h
+ * @ingroup communication
+ *
+ * Consistent Overhead Byte Stuffing (COBS) as used by the optional COBS framing
+ * of the communication library (see COMM_FRAMING_COBS in
+ * src/cfg/io/uart/uart_cfg.h).
+ *
+ * COBS removes all zero bytes from a block of data, so that a zero byte can be
+ * used as packet delimiter. The overhead is at most one byte per 254 bytes of
+ * data, independent of the content. The encoded data consists of blocks, each
+ * starting with a code byte n (1..255) followed by n-1 non-zero data bytes. All
+ * blocks except the last one and blocks with code 255 imply a zero byte after
+ * their data.
+ *
+ * The functions do not depend on AVR specific headers and are also used by the
+ * host tools in tools/framing.
+ */
+
+#ifndef COBS_H_
+#define COBS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/**
+ * Maximum number of data bytes of a single COBS block
+ */
+#define COBS_BLOCK_SIZE 254
+
+/**
+ * Maximum size of COBS encoded data for <code>len</code> bytes of input data
+ * (excluding the packet delimiter).
+ */
+#define COBS_MAX_ENCODED_SIZE(len) ((len) + (len) / COBS_BLOCK_SIZE + 1)
+
+
+/**
+ * Encode a block of data.
+ *
+ * @param   src   data to be encoded
+ * @param   len   number of bytes in src
+ * @param   dst   buffer for the encoded data, at least
+ *                #COBS_MAX_ENCODED_SIZE(len) bytes
+ * @return  number of bytes written to dst (without packet delimiter)
+ */
+uint16_t cobs_encode(const uint8_t* src, const uint16_t len, uint8_t* dst);
+
+
+/**
+ * Decode a block of COBS encoded data (without packet delimiter).
+ * Decoding in place (src == dst) is allowed.
+ *
+ * @param   src         encoded data
+ * @param   len         number of bytes in src
+ * @param   dst         buffer for the decoded data, at least len bytes
+ * @param   decodedLen  receives the number of decoded bytes
+ * @return  true if src is valid COBS encoded data, false otherwise
+ */
+bool cobs_decode(const uint8_t* src, const uint16_t len, uint8_t* dst, uint16_t* decodedLen);
+
+#endif /* COBS_H_ */
@@ -1,5 +1,10 @@
 #include "communication.h"
+#include "framing.h"
+#include "cobs.h"
 #include <io/uart/uart.h>
+#include <tools/timeTask/timeTask.h>
+
+#include <util/atomic.h>
 
 #include <stdarg.h>
 #include <stdlib.h>
@@ -8,16 +13,37 @@
 #include <string.h>
 
 // Escape character
-#define ESC 17
+#define ESC COMM_ESC
 
 // Packet delimiter character
-#define DELIM '+'
+#define DELIM COMM_DELIM
 
 
 #ifndef COMM_UART
     #error COMM_UART is undefined
 #endif
 
+#if defined(COMM_FRAMING_COBS) && defined(COMM_TX_ISR_FRAMING)
+    #error COMM_FRAMING_COBS can not be combined with COMM_TX_ISR_FRAMING
+#endif
+
+#if defined(COMM_FRAMING_COBS) && defined(COMM_RX_ISR_FRAMING)
+    #error COMM_FRAMING_COBS can not be combined with COMM_RX_ISR_FRAMING
+#endif
+
+#ifdef COMM_RX_ISR_FRAMING
+    // error flags of the framing RX ISR are or'ed to the errors
+    #if (COMM_RX_ERR_BUFFERFULL != COMM_ERR_BUFFERFULL) || (COMM_RX_ERR_TOO_SMALL != COMM_ERR_TOO_SMALL) || \
+        (COMM_RX_ERR_SIZE_MISMATCH != COMM_ERR_SIZE_MISMATCH) || (COMM_RX_ERR_CHECKSUM != COMM_ERR_CHECKSUM)
+        #error COMM_RX_ERR_* values do not match COMM_ERR_* values
+    #endif
+    // the ISR compares the high byte of the payload size with the ring size,
+    // bit 15 of a length prefix marks an entry as handled
+    #if (COMM_RX_RING_SIZE < 256) || (COMM_RX_RING_SIZE > 0x7FFF)
+        #error COMM_RX_RING_SIZE must be in the range 256 to 0x7FFF
+    #endif
+#endif
+
 /**
  * Macro for concatenating two arguments a and b.
  * Used to construct function names including the UART number, see below
@@ -37,6 +63,36 @@
  */
 #define uart_write(b) EXPAND_AND_CONCAT(uart_write, COMM_UART)(b)
 
+/**
+ * Macro for conveniently putting a block of data into the TX buffer for the
+ * configured UART (see COMM_UART).
+ */
+#define uart_writeBlock(d, l) EXPAND_AND_CONCAT(uart_writeBlock, COMM_UART)(d, l)
+
+/**
+ * Macro for conveniently checking the free space in the TX buffer for the
+ * configured UART (see COMM_UART).
+ */
+#define uart_getTXBufSpace() EXPAND_AND_CONCAT(uart_getTXBufSpace, COMM_UART)()
+
+/**
+ * Size of the TX buffer of the configured UART (see COMM_UART).
+ */
+#define COMM_TX_BUFFER_SIZE EXPAND_AND_CONCAT(EXPAND_AND_CONCAT(UART, COMM_UART), _TX_BUFFER_SIZE)
+
+/**
+ * Number of bytes a packet occupies in the TX buffer in addition to its payload.
+ * Without COMM_TX_ISR_FRAMING, escape characters are not taken into account.
+ * With COMM_FRAMING_COBS, the value holds for payloads up to 504 bytes.
+ */
+#if defined(COMM_TX_ISR_FRAMING)
+    #define COMM_FRAME_OVERHEAD 3
+#elif defined(COMM_FRAMING_COBS)
+    #define COMM_FRAME_OVERHEAD 8
+#else
+    #define COMM_FRAME_OVERHEAD 5
+#endif
+
 /**
  * Macro for conveniently checking if data is available for reading from the configured UART (see COMM_UART).
  */
@@ -47,6 +103,11 @@
  */
 #define uart_read()   EXPAND_AND_CONCAT(uart_read, COMM_UART)()
 
+/**
+ * Macro for conveniently checking and clearing the RX buffer overflow flag of the configured UART (see COMM_UART).
+ */
+#define uart_isRXBufOverflow() EXPAND_AND_CONCAT(uart_isRXBufOverflow, COMM_UART)()
+
 // Macro for conveniently transmitting bytes
 // if byte to transmit matches escape or delimiter character, it is automatically
 // escaped
@@ -59,25 +120,285 @@
 // Array with callback functions for each channel
 static ChannelCallback_t communication_ChannelReceivers[COMM_MAX_CHANNELS];
 
+#ifdef COMM_RX_ISR_FRAMING
+
+/**
+ * State of the framing RX complete ISR (see uart_rxFramedISR in uart_isr.S).
+ * The ISR accesses all members by their offset, so do not reorder them.
+ *
+ * Complete packets are stored in comm_rxRing as entries of a 2 byte length
+ * prefix followed by the packet (size, header byte, payload, checksum). The
+ * entries between tail and head (offsets in comm_rxRing) have not been handled
+ * yet. The ISR places an incoming packet behind head as soon as its payload
+ * size is known, either directly at head or, if it does not fit up to the end
+ * of the ring, at the start of the ring behind a length prefix of 0 (wrap
+ * marker) at head. When the packet is complete and its checksum and size are
+ * valid, the ISR writes the length prefix and moves head behind the entry.
+ * communication_readPackets() hands entries back by moving tail. If the ring is
+ * empty (head == tail) when a packet is placed, the ISR resets both to 0.
+ */
+typedef struct __attribute__((__packed__)) {
+    uint8_t flags;     ///< COMM_RX_FLAG_ESC and COMM_RX_FLAG_DISCARD bits
+    uint8_t chksum;    ///< current checksum of incoming packet
+    uint16_t len;      ///< current length of incoming packet
+    uint8_t* ptr;      ///< write position of incoming packet in comm_rxRing
+    uint16_t head;     ///< offset behind the last complete entry, written by the ISR
+    uint16_t tail;     ///< offset of the first entry not yet handled, written by communication_readPackets()
+    uint16_t expected; ///< expected length of incoming packet (low byte of payload size while len < 2)
+    uint8_t errors;    ///< COMM_RX_ERR_* flags
+} commRx_t;
+
+// Ring of entries with complete incoming packets, written by the framing RX ISR
+uint8_t comm_rxRing[COMM_RX_RING_SIZE];
+
+// State of the framing RX ISR
+volatile commRx_t comm_rxState;
+
+// Bit of a length prefix which marks an entry already handled ahead of the
+// order of reception (urgent channels)
+#define RX_ENTRY_HANDLED 0x8000
+
+#else
+
 // Buffer for incoming packets
 static uint8_t inBuf[COMM_RECV_BUFFER_SIZE];
 
 // Length of incoming packet buffer
 static uint16_t inBufLen = 0;
 
+#ifdef COMM_FRAMING_COBS
+// code byte of the current COBS block of the incoming packet
+static uint8_t cobsCode = 0xFF;
+
+// number of remaining data bytes in the current COBS block of the incoming packet
+static uint8_t cobsRemaining = 0;
+#else
 // true if last incoming character was an escape character
 static bool isESC = false;
+#endif
 
 // current checksum while reading incoming packet
 static uint8_t inChksum = 0;
 
+#endif
+
+#ifdef COMM_FRAMING_COBS
+// COBS block of the outgoing packet: code byte followed by up to 254 data bytes
+static uint8_t cobsBlock[COBS_BLOCK_SIZE + 1];
+
+// number of data bytes in cobsBlock
+static uint8_t cobsBlockLen = 0;
+#endif
+
 // Error flags, set by communication_readPackets()
 static uint8_t errors = 0;
 
+// Priorities of outgoing packets for each channel
+static Priority_t priorities[COMM_MAX_CHANNELS];
+
+// Counters of sent, dropped and received packets for each channel
+static ChannelStats_t channelStats[COMM_MAX_CHANNELS];
+
+// Error counters and TX stall time, see communication_getHealth()
+static CommHealth_t health;
+
+// Incoming channels handled ahead of other packets, one bit per channel
+static uint16_t urgentChannels = 0;
+
+// Maximum number of bytes handled by one call of communication_readPackets(),
+// 0 if unlimited
+static uint16_t readBudget = 0;
+
+// Minimum interval between outgoing packets of each channel in ms, see
+// communication_isChannelDue()
+static uint16_t rateIntervals[COMM_MAX_CHANNELS];
+
+// Uptime in ms when communication_isChannelDue() last returned true for each channel
+static uint16_t rateLastDue[COMM_MAX_CHANNELS];
+
+// Outgoing channels disabled by the rate governor, one bit per channel
+static uint16_t disabledChannels = 0;
+
+// Hook executed for every valid incoming packet, see communication_setReceiveHook()
+static ReceiveHook_t receiveHook = NULL;
+
+// Part of the TX buffer which is kept free for packets of higher priority,
+// indexed by Priority_t
+static const uint8_t txReserve[] = { 0, COMM_TX_BUFFER_SIZE / 4, COMM_TX_BUFFER_SIZE / 2 };
+
 
 void communication_init(void) {
     // clear communication_ChannelReceivers
     memset(communication_ChannelReceivers, 0, sizeof(communication_ChannelReceivers));
+
+    // all channels have high priority (blocking like without priorities)
+    // until the application assigns the priorities
+    for (uint8_t i = 0; i < COMM_MAX_CHANNELS; i++)
+        priorities[i] = PRIORITY_HIGH;
+    communication_resetChannelStats();
+    communication_resetHealth();
+
+    // all channels are enabled without rate limit
+    memset(rateIntervals, 0, sizeof(rateIntervals));
+    disabledChannels = 0;
+}
+
+
+void communication_setPriority(const Channel_t channel, const Priority_t priority) {
+    priorities[channel] = priority;
+}
+
+
+Priority_t communication_getPriority(const Channel_t channel) {
+    return priorities[channel];
+}
+
+
+void communication_getChannelStats(const Channel_t channel, ChannelStats_t* stats) {
+    *stats = channelStats[channel];
+}
+
+
+void communication_resetChannelStats(void) {
+    memset(channelStats, 0, sizeof(channelStats));
+}
+
+
+// Set error flags and count each error
+static void setError(const uint8_t error) {
+    errors |= error;
+    uint8_t flags = error;
+    for (uint8_t i = 0; flags; i++, flags >>= 1) {
+        if ((flags & 1) && health.errors[i] < UINT16_MAX)
+            health.errors[i]++;
+    }
+}
+
+
+// Fetch the errors detected by the RX ISR of the UART
+static void fetchRxErrors(void) {
+#ifdef COMM_RX_ISR_FRAMING
+    // errors of the framing RX ISR
+    uint8_t rxErrors;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        rxErrors = comm_rxState.errors;
+        comm_rxState.errors = 0;
+    }
+    if (rxErrors)
+        setError(rxErrors);
+#else
+    if (uart_isRXBufOverflow())
+        setError(COMM_ERR_RX_OVERFLOW);
+#endif
+}
+
+
+void communication_getHealth(CommHealth_t* health_) {
+    fetchRxErrors();
+    *health_ = health;
+}
+
+
+void communication_resetHealth(void) {
+    memset(&health, 0, sizeof(health));
+}
+
+
+void communication_setUrgent(const Channel_t channel, const bool urgent) {
+    if (urgent)
+        urgentChannels |= (uint16_t)1 << channel;
+    else
+        urgentChannels &= ~((uint16_t)1 << channel);
+}
+
+
+void communication_setReadBudget(const uint16_t bytes) {
+    readBudget = bytes;
+}
+
+
+void communication_setRate(const Channel_t channel, const uint16_t interval, const bool enabled) {
+    rateIntervals[channel] = interval;
+    if (enabled)
+        disabledChannels &= ~((uint16_t)1 << channel);
+    else
+        disabledChannels |= (uint16_t)1 << channel;
+}
+
+
+uint16_t communication_getRateInterval(const Channel_t channel) {
+    return rateIntervals[channel];
+}
+
+
+bool communication_isChannelEnabled(const Channel_t channel) {
+    return !(disabledChannels & ((uint16_t)1 << channel));
+}
+
+
+bool communication_isChannelDue(const Channel_t channel) {
+    if (disabledChannels & ((uint16_t)1 << channel))
+        return false;
+    uint16_t uptime = timeTask_getTaskUptime(); // same uptime as the time tasks
+    // unsigned comparison is robust against overflow of the uptime, see TIMETASK
+    if ((uint16_t)(uptime - rateLastDue[channel]) < rateIntervals[channel])
+        return false;
+    rateLastDue[channel] = uptime;
+    return true;
+}
+
+
+// Check if a packet with the given payload size may be put into the TX buffer:
+// its channel must not be disabled by the rate governor and the TX buffer must
+// have enough space according to the priority of the channel
+static bool isSendAllowed(const Channel_t channel, const uint16_t size) {
+    if (disabledChannels & ((uint16_t)1 << channel))
+        return false;
+    Priority_t priority = priorities[channel];
+#ifndef UART_NONBLOCKING_TRANSMIT
+    // packets of high priority wait for free space
+    if (priority == PRIORITY_HIGH)
+        return true;
+#endif
+    return (uint16_t)uart_getTXBufSpace() >= size + COMM_FRAME_OVERHEAD + txReserve[priority];
+}
+
+
+// Check if a packet with the given payload size has to wait for free space in
+// the TX buffer and take the start time of the stall
+static inline bool beginStall(const Channel_t channel, const uint16_t size, timeTask_time_t* start) {
+#ifdef UART_NONBLOCKING_TRANSMIT
+    return false;
+#else
+    if (priorities[channel] != PRIORITY_HIGH || (uint16_t)uart_getTXBufSpace() >= size + COMM_FRAME_OVERHEAD)
+        return false;
+    timeTask_getTimestamp(start);
+    return true;
+#endif
+}
+
+
+// Add the duration of a stall to the health counters
+static void endStall(const timeTask_time_t* start) {
+    timeTask_time_t stop;
+    timeTask_getTimestamp(&stop);
+    uint32_t duration = timeTask_getDuration(start, &stop);
+    if (health.txStalls < UINT16_MAX)
+        health.txStalls++;
+    health.txStallTime = (health.txStallTime + duration < health.txStallTime) ? UINT32_MAX : health.txStallTime + duration;
+}
+
+
+// Compute the size of a log packet, truncated such that it can be put into the
+// TX buffer without touching the reserve of the priority of CH_OUT_DEBUG
+static uint16_t getLogPacketSize(const int size) {
+    uint16_t packetSize = size > 256 ? 257 : (size+1);
+    if (priorities[CH_OUT_DEBUG] != PRIORITY_HIGH) {
+        uint16_t maxSize = (COMM_TX_BUFFER_SIZE - 1) - COMM_FRAME_OVERHEAD - txReserve[priorities[CH_OUT_DEBUG]];
+        if (packetSize > maxSize)
+            packetSize = maxSize;
+    }
+    return packetSize;
 }
 
 
@@ -91,13 +412,22 @@ void communication_clearCallback(const Channel_t channel) {
 }
 
 
+void communication_setReceiveHook(const ReceiveHook_t hook) {
+    receiveHook = hook;
+}
+
+
 void communication_log(const Level_t level, const char* format, ...) {
+    // skip formatting if the debug channel is disabled by the rate governor
+    if (disabledChannels & ((uint16_t)1 << CH_OUT_DEBUG))
+        return;
+
     va_list argp;
     va_start(argp, format);
 
     char* buff = (char*)malloc(258);
     if (buff == 0) {
-    	errors |= COMM_ERR_OUT_OF_MEMORY;
+    	setError(COMM_ERR_OUT_OF_MEMORY);
     	return;
     }
     buff[0] = level;
@@ -106,18 +436,22 @@ void communication_log(const Level_t level, const char* format, ...) {
     va_end(argp);
 
     // send packet to debug channel CH_OUT_DEBUG (0x00)
-    communication_writePacket(CH_OUT_DEBUG, (uint8_t *)buff, size > 256 ? 257 : (size+1));
+    communication_writePacket(CH_OUT_DEBUG, (uint8_t *)buff, getLogPacketSize(size));
     free(buff);
 }
 
 
 void communication_log_P(const Level_t level, const char* format, ...) {
+    // skip formatting if the debug channel is disabled by the rate governor
+    if (disabledChannels & ((uint16_t)1 << CH_OUT_DEBUG))
+        return;
+
     va_list argp;
     va_start(argp, format);
 
     char* buff = (char*)malloc(258);
     if (buff == 0) {
-    	errors |= COMM_ERR_OUT_OF_MEMORY;
+    	setError(COMM_ERR_OUT_OF_MEMORY);
     	return;
     }
     buff[0] = level;
@@ -126,12 +460,129 @@ void communication_log_P(const Level_t level, const char* format, ...) {
     va_end(argp);
 
     // send packet to debug channel CH_OUT_DEBUG (0x00)
-    communication_writePacket(CH_OUT_DEBUG, (uint8_t *)buff, size > 256 ? 257 : (size+1));
+    communication_writePacket(CH_OUT_DEBUG, (uint8_t *)buff, getLogPacketSize(size));
     free(buff);
 }
 
 
+#ifdef COMM_TX_ISR_FRAMING
+
+void communication_writePacket(const Channel_t channel, const uint8_t* packet, const uint16_t size) {
+    // escaping, global checksum and packet delimiter are added by the UDRE ISR,
+    // so only payload size and header byte are placed in front of the payload
+    uint8_t header[3];
+    header[0] = (uint8_t)size;
+    header[1] = (uint8_t)(size >> 8);
+
+    // compute 4-bit checksum of size and place it in high nibble,
+    // place channel number in low nibble
+    register uint8_t chksum = header[0] ^ header[1];
+    header[2] = (((chksum << 4) & 0xFF) ^ (chksum & 0xF0)) | (channel & 0x0F);
+
+    // drop packet if its channel is disabled or the TX buffer has not enough
+    // space for its priority (an incomplete packet in the TX buffer would break the framing of all
+    // following packets, hence the whole packet is dropped)
+    if (!isSendAllowed(channel, size)) {
+        channelStats[channel].dropped++;
+        return;
+    }
+    channelStats[channel].sent++;
+    channelStats[channel].sentBytes += size;
+    timeTask_time_t stallStart;
+    bool stalled = beginStall(channel, size, &stallStart);
+
+    uart_writeBlock(header, sizeof(header));
+
+    // copy payload in blocks, each block waits at most once for free space
+    uint16_t remaining = size;
+    while (remaining > 0) {
+        uint8_t len = remaining > COMM_TX_BLOCK_SIZE ? COMM_TX_BLOCK_SIZE : (uint8_t)remaining;
+        uart_writeBlock(packet, len);
+        packet += len;
+        remaining -= len;
+    }
+    if (stalled)
+        endStall(&stallStart);
+}
+
+#elif defined(COMM_FRAMING_COBS)
+
+// Transmit the current COBS block with its code byte
+static inline void cobsFlush(void) {
+    cobsBlock[0] = cobsBlockLen + 1;
+    uart_writeBlock(cobsBlock, cobsBlockLen + 1);
+    cobsBlockLen = 0;
+}
+
+// Add a byte of the outgoing packet to the current COBS block
+static inline void cobsPut(const uint8_t byte) {
+    if (byte == 0) {
+        // zero byte is implied by the end of the block
+        cobsFlush();
+    } else {
+        cobsBlock[++cobsBlockLen] = byte;
+        if (cobsBlockLen == COBS_BLOCK_SIZE)
+            cobsFlush();
+    }
+}
+
+void communication_writePacket(const Channel_t channel, const uint8_t* packet, const uint16_t size) {
+    // drop packet if its channel is disabled or the TX buffer has not enough
+    // space for its priority
+    if (!isSendAllowed(channel, size)) {
+        channelStats[channel].dropped++;
+        return;
+    }
+    channelStats[channel].sent++;
+    channelStats[channel].sentBytes += size;
+    timeTask_time_t stallStart;
+    bool stalled = beginStall(channel, size, &stallStart);
+
+    // the global checksum is calculated over the whole packet including the
+    // header information, the packet is COBS encoded block by block
+
+    // low and high byte of payload size
+    register uint8_t chksum = (uint8_t)size;
+    cobsPut(chksum);
+    register uint8_t byte = (uint8_t)(size >> 8);
+    cobsPut(byte);
+    chksum ^= byte;
+
+    // compute 4-bit checksum of size and place it in high nibble,
+    // place channel number in low nibble
+    byte = (((chksum << 4) & 0xFF) ^ (chksum & 0xF0)) | (channel & 0x0F);
+    cobsPut(byte);
+    chksum ^= byte;
+
+    // packet payload
+    for (uint16_t i = 0; i < size; i++) {
+        register uint8_t tmp = packet[i];
+        cobsPut(tmp);
+        chksum ^= tmp;
+    }
+
+    // checksum, last block and packet delimiter
+    cobsPut(chksum);
+    cobsFlush();
+    uart_write(0);
+    if (stalled)
+        endStall(&stallStart);
+}
+
+#else
+
 void communication_writePacket(const Channel_t channel, const uint8_t* packet, const uint16_t size) {
+    // drop packet if its channel is disabled or the TX buffer has not enough
+    // space for its priority
+    if (!isSendAllowed(channel, size)) {
+        channelStats[channel].dropped++;
+        return;
+    }
+    channelStats[channel].sent++;
+    channelStats[channel].sentBytes += size;
+    timeTask_time_t stallStart;
+    bool stalled = beginStall(channel, size, &stallStart);
+
     // while writing each byte, the global checksum is calculated over the whole
     // transmitted data including the header information
 
@@ -161,8 +612,202 @@ void communication_writePacket(const Channel_t channel, const uint8_t* packet, c
     uart_writeEscaped(chksum);
     // transmit packet delimiter
     uart_write(DELIM);
+    if (stalled)
+        endStall(&stallStart);
+}
+
+#endif
+
+
+// Check header and checksum of a complete packet in buf and execute the
+// callback function of its channel
+static inline void processPacket(const uint8_t* buf, const uint16_t bufLen, const uint8_t chksum) {
+    if (bufLen >= 4) { // if number of bytes in buffer is at least the minimum size, we might have received a full packet
+
+        register uint8_t chksumSize = buf[0]; // read low byte of payload size
+        register uint8_t data = buf[1]; // read high byte of payload size
+        uint16_t size = chksumSize | ((uint16_t)data << 8); // compute payload size
+
+        // calculate 4-bit checksum for payload size in low nibble
+        chksumSize ^= data;
+        chksumSize = (chksumSize >> 4) ^ (chksumSize & 0x0F);
+
+        data = buf[2]; // read checksum for payload size (bits 7-4) and channel ID (bits 3-0)
+
+        if ((data >> 4) == chksumSize) { // check for mismatch of payload size checksum
+            if (size == bufLen - 4) { // check packet length
+                if (chksum == 0) { // if global checksum is ok
+                    register uint8_t channel = data & 0x0F; // get channel number
+                    channelStats[channel].received++;
+                    channelStats[channel].receivedBytes += size;
+                    if (receiveHook)
+                        receiveHook(channel, buf+3, size);
+                    // execute callback function
+                    if (communication_ChannelReceivers[channel])
+                        (communication_ChannelReceivers[channel])(buf+3, size);
+                    else
+                        setError(COMM_ERR_UNREGISTEREDCHANNEL);
+                } else
+                    setError(COMM_ERR_CHECKSUM);
+            } else
+                setError(COMM_ERR_SIZE_MISMATCH);
+        } else
+            setError(COMM_ERR_HEADER_CHECKSUM);
+    } else
+        setError(COMM_ERR_TOO_SMALL);
+}
+
+
+#if defined(COMM_RX_ISR_FRAMING)
+
+// Get the tail of the ring, or 0xFFFF if the ring is empty
+static inline uint16_t getRxTail(void) {
+    uint16_t tail;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        tail = comm_rxState.tail;
+        if (tail == comm_rxState.head)
+            tail = 0xFFFF;
+    }
+    return tail;
+}
+
+// Get the head of the ring
+static inline uint16_t getRxHead(void) {
+    uint16_t head;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        head = comm_rxState.head;
+    }
+    return head;
+}
+
+// Hand the entries in front of tail back to the ISR
+static inline void setRxTail(const uint16_t tail) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        comm_rxState.tail = tail;
+    }
+}
+
+// Get the length prefix of the entry at offset pos of the ring
+static inline uint16_t getRxEntryLen(const uint16_t pos) {
+    return comm_rxRing[pos] | ((uint16_t)comm_rxRing[pos + 1] << 8);
+}
+
+void communication_readPackets(void) {
+    uint16_t pos;
+    uint16_t len;
+
+    fetchRxErrors();
+
+    // handle complete packets of urgent channels first, independent of the
+    // budget, and mark their entries as handled. The entries are handed back
+    // to the ISR in the order of reception below. Entries up to the head read
+    // here are not changed by the ISR until they are handed back.
+    if (urgentChannels && (pos = getRxTail()) != 0xFFFF) {
+        uint16_t head = getRxHead();
+        while (pos != head) {
+            len = getRxEntryLen(pos);
+            if (len == 0) { // wrap marker, next entry at the start of the ring
+                pos = 0;
+                continue;
+            }
+            uint8_t* buf = comm_rxRing + pos + 2;
+            // the ISR only delivers packets of at least 4 bytes, header byte is complete
+            if (!(len & RX_ENTRY_HANDLED) && (urgentChannels & ((uint16_t)1 << (buf[2] & 0x0F)))) {
+                processPacket(buf, len, 0);
+                comm_rxRing[pos + 1] |= (uint8_t)(RX_ENTRY_HANDLED >> 8);
+            }
+            pos += 2 + (len & ~RX_ENTRY_HANDLED);
+        }
+    }
+
+    // handle the other complete packets in the order of their reception until
+    // the budget is exhausted, but at least one packet. Entries of urgent
+    // packets are always handed back, as they have already been handled.
+    uint16_t handled = 0;
+    while ((pos = getRxTail()) != 0xFFFF) {
+        len = getRxEntryLen(pos);
+        if (len == 0) { // wrap marker
+            setRxTail(0);
+            continue;
+        }
+        if (!(len & RX_ENTRY_HANDLED)) {
+            if (readBudget && (handled >= readBudget))
+                break;
+            // global checksum and size have already been verified by the ISR
+            processPacket(comm_rxRing + pos + 2, len, 0);
+            handled += len;
+        }
+        // hand entry back to the ISR
+        setRxTail(pos + 2 + (len & ~RX_ENTRY_HANDLED));
+    }
+}
+
+#elif defined(COMM_FRAMING_COBS)
+
+static __attribute__ ((noinline)) void readPackets(void) {
+    register uint8_t tmpChksum = inChksum;
+    register uint16_t tmpBufLen = inBufLen;
+    register uint8_t* tmpBuf = inBuf + tmpBufLen;
+    register uint8_t tmpCode = cobsCode;
+    register uint8_t tmpRemaining = cobsRemaining;
+
+    // number of bytes which may still be read in this call
+    register uint16_t remaining = readBudget ? readBudget : UINT16_MAX;
+
+    // while some data is available in the UART RX buffer
+    do {
+        // get the data byte
+        register uint8_t data = uart_read();
+
+        if (data == 0) { // zero byte is the packet delimiter
+            if (tmpRemaining == 0) // last COBS block is complete
+                processPacket(inBuf, tmpBufLen, tmpChksum);
+            else
+                setError(COMM_ERR_SIZE_MISMATCH);
+
+            // clear incoming packet buffer, checksum and COBS state
+            tmpBufLen = 0;
+            tmpChksum = 0;
+            tmpBuf = inBuf;
+            tmpCode = 0xFF;
+            tmpRemaining = 0;
+            continue;
+        }
+
+        if (tmpRemaining == 0) { // data byte is the code byte of the next COBS block
+            tmpRemaining = data - 1;
+            if (tmpCode == 0xFF) { // no zero byte implied by previous block
+                tmpCode = data;
+                continue;
+            }
+            tmpCode = data;
+            data = 0; // place zero byte implied by previous block
+        } else {
+            tmpRemaining--;
+        }
+
+        // place byte in incoming packet buffer
+        *tmpBuf++ = data;
+        tmpChksum ^= data;
+
+        if (++tmpBufLen == COMM_RECV_BUFFER_SIZE) { // if incoming packet buffer is full
+            // clear buffer
+            tmpBufLen = 0;
+            tmpChksum = 0;
+            tmpBuf = inBuf;
+            // set error flag
+            setError(COMM_ERR_BUFFERFULL);
+        }
+    } while (--remaining && uart_available());
+
+    // update current checksum, buffer position and COBS state before exiting
+    inChksum = tmpChksum;
+    inBufLen = tmpBufLen;
+    cobsCode = tmpCode;
+    cobsRemaining = tmpRemaining;
 }
 
+#else
 
 static __attribute__ ((noinline)) void readPackets(void) {
     register uint8_t tmpChksum = inChksum;
@@ -170,6 +815,9 @@ static __attribute__ ((noinline)) void readPackets(void) {
     register uint8_t* tmpBuf = inBuf + tmpBufLen;
     register uint8_t tmpIsESC = isESC;
 
+    // number of bytes which may still be read in this call
+    register uint16_t remaining = readBudget ? readBudget : UINT16_MAX;
+
     // while some data is available in the UART RX buffer
     do {
         // get the data byte
@@ -182,35 +830,7 @@ static __attribute__ ((noinline)) void readPackets(void) {
             tmpIsESC = true; // set flag for indicating an escape sequence
             continue;
         } else if (data == DELIM) { // if data byte is delimiter, we should have a complete packet in the incoming buffer
-            if (tmpBufLen >= 4) { // if number of bytes in buffer is at least the minimum size, we might have received a full packet
-
-                register uint8_t chksumSize = inBuf[0]; // read low byte of payload size
-                data = inBuf[1]; // read high byte of payload size
-                uint16_t size = chksumSize | ((uint16_t)data << 8); // compute payload size
-
-                // calculate 4-bit checksum for payload size in low nibble
-                chksumSize ^= data;
-                chksumSize = (chksumSize >> 4) ^ (chksumSize & 0x0F);
-
-                data = inBuf[2]; // read checksum for payload size (bits 7-4) and channel ID (bits 3-0)
-
-                if ((data >> 4) == chksumSize) { // check for mismatch of payload size checksum
-                    if (size == tmpBufLen - 4) { // check packet length
-                        if (tmpChksum == 0) { // if global checksum is ok
-                            register uint8_t channel = data & 0x0F; // get channel number
-                            // execute callback function
-                            if (communication_ChannelReceivers[channel])
-                                (communication_ChannelReceivers[channel])(inBuf+3, size);
-                            else
-                                errors |= COMM_ERR_UNREGISTEREDCHANNEL;
-                        } else
-                            errors |= COMM_ERR_CHECKSUM;
-                    } else
-                        errors |= COMM_ERR_SIZE_MISMATCH;
-                } else
-                    errors |= COMM_ERR_HEADER_CHECKSUM;
-            } else
-                errors |= COMM_ERR_TOO_SMALL;
+            processPacket(inBuf, tmpBufLen, tmpChksum);
 
             // clear incoming packet buffer and checksum
             tmpBufLen = 0;
@@ -229,9 +849,9 @@ static __attribute__ ((noinline)) void readPackets(void) {
             tmpChksum = 0;
             tmpBuf = inBuf;
             // set error flag
-            errors |= COMM_ERR_BUFFERFULL;
+            setError(COMM_ERR_BUFFERFULL);
         }
-    } while (uart_available());
+    } while (--remaining && uart_available());
 
     // update current checksum and buffer position in memory before exiting
     inChksum = tmpChksum;
@@ -239,14 +859,21 @@ static __attribute__ ((noinline)) void readPackets(void) {
     isESC = tmpIsESC;
 }
 
+#endif
+
 
+#ifndef COMM_RX_ISR_FRAMING
 void communication_readPackets(void) {
+    fetchRxErrors();
     if (uart_available())
         readPackets();
 }
+#endif
 
 
 uint8_t communication_getErrors(void) {
+    // fetch and reset errors of the RX ISR
+    fetchRxErrors();
     // read errors
     uint8_t tmp = errors;
     // reset errors
@@ -37,10 +37,14 @@ typedef enum {
  * Communication errors resulting from communication_readPackets(),
  * communication_log() or communication_log_P ().
  * The errors can be read and cleared by communication_getErrors().
- * Error values can be or'ed.
+ * Error values can be or'ed. Additionally, each error is counted, see
+ * communication_getHealth().
  */
 
-/** Receive buffer is full */
+/**
+ * Receive buffer is full (or, with COMM_RX_ISR_FRAMING, the ring of received
+ * packets had not enough free space and a packet has been discarded)
+ */
 #define COMM_ERR_BUFFERFULL 1
 
 /** Packet is too small */
@@ -67,12 +71,71 @@ typedef enum {
 */
 #define COMM_ERR_OUT_OF_MEMORY 64
 
+/**
+ * Overflow of the UART RX buffer, incoming data has been discarded (only
+ * without COMM_RX_ISR_FRAMING, see uart_isRXBufOverflow0())
+ */
+#define COMM_ERR_RX_OVERFLOW 128
+
+/**
+ * Number of error types, i.e. bits of the error flags
+ */
+#define COMM_ERR_COUNT 8
+
 /**
  * Definition of the number of communication channels
  */
 #define COMM_MAX_CHANNELS 16
 
 
+/**
+ * Priorities of outgoing packets, to be set per channel with
+ * communication_setPriority().
+ *
+ * Packets with priority #PRIORITY_NORMAL or #PRIORITY_LOW are dropped by
+ * communication_writePacket() instead of waiting for the UART, if they would
+ * leave less than the reserved part of the TX buffer free. The reserve keeps
+ * room for packets of higher priority, so that these usually do not block
+ * either. Dropping periodically sent packets (e.g. telemetry) coalesces them,
+ * as the next packet supersedes the dropped one anyway.
+ */
+typedef enum {
+    PRIORITY_HIGH = 0, ///< never dropped, communication_writePacket() blocks if required
+    PRIORITY_NORMAL = 1, ///< dropped if less than a quarter of the TX buffer would remain free
+    PRIORITY_LOW = 2 ///< dropped if less than half of the TX buffer would remain free
+} Priority_t;
+
+
+/**
+ * Counters of outgoing and incoming packets of a channel, see
+ * communication_getChannelStats(). Counters wrap around on overflow.
+ */
+typedef struct {
+    uint16_t sent; ///< number of packets put into the TX buffer
+    uint16_t dropped; ///< number of packets dropped due to insufficient space in the TX buffer
+    uint16_t received; ///< number of valid incoming packets
+    uint32_t sentBytes; ///< payload bytes of the sent packets
+    uint32_t receivedBytes; ///< payload bytes of the valid incoming packets
+} ChannelStats_t;
+
+
+/**
+ * Health counters of the communication, see communication_getHealth().
+ * Counters saturate instead of wrapping around.
+ */
+typedef struct {
+    /**
+     * number of occurrences of each error, indexed by the bit number of the
+     * error flag (e.g. index 4 for #COMM_ERR_CHECKSUM). With COMM_RX_ISR_FRAMING,
+     * errors of the RX ISR are counted at most once per call of
+     * communication_readPackets().
+     */
+    uint16_t errors[COMM_ERR_COUNT];
+    uint16_t txStalls; ///< number of packets which had to wait for free space in the TX buffer
+    uint32_t txStallTime; ///< total time spent waiting for free space in the TX buffer in us
+} CommHealth_t;
+
+
 /**
  * Type definition of a function pointer defining the channel callback functions for
  * incoming packages.
@@ -99,6 +162,19 @@ typedef enum {
 typedef void (*ChannelCallback_t)(const uint8_t*, const uint16_t);
 
 
+/**
+ * Type definition of a function pointer defining a hook which is executed by
+ * communication_readPackets() for every valid incoming packet right before the
+ * callback function of its channel, e.g. for recording the received packets.
+ *
+ * The signature of the hook is:
+ * @param   channel channel of the received packet (Channel_t)
+ * @param   packet  pointer to the received packet (uint8_t*)
+ * @param   size    size of the received packet (uint16_t)
+ */
+typedef void (*ReceiveHook_t)(const Channel_t, const uint8_t*, const uint16_t);
+
+
 /**
  * Initializes the communication protocol library. Must be invoked before any
  * other communication library function.
@@ -128,10 +204,29 @@ void communication_setCallback(const Channel_t channel, const ChannelCallback_t
 void communication_clearCallback(const Channel_t channel);
 
 
+/**
+ * Register a hook with prototype as defined by ReceiveHook_t which is executed
+ * for every valid incoming packet before its channel callback function.
+ *
+ * @param   hook      function pointer to the hook, NULL to remove the hook
+ */
+void communication_setReceiveHook(const ReceiveHook_t hook);
+
+
 /**
  * Send a packet to HWPCS on a specified channel. Blocks until all bytes have
  * been put into the UART transmit buffer.
  *
+ * If COMM_TX_ISR_FRAMING is defined (see src/cfg/io/uart/uart_cfg.h), header
+ * and payload are copied into the transmit buffer as blocks and the UDRE ISR
+ * adds escaping, checksum and delimiter. The function then only blocks if the
+ * packet does not fit into the free space of the transmit buffer.
+ *
+ * Depending on the priority of the channel (see communication_setPriority()),
+ * the packet is dropped instead of blocking if the free space in the transmit
+ * buffer is insufficient. Sent and dropped packets are counted per channel,
+ * see communication_getChannelStats().
+ *
  * Due to blocking, this function must not be called from interrupt context.
  * See documentation of function uart_write0() on how to disable blocking.
  *
@@ -149,16 +244,176 @@ void communication_clearCallback(const Channel_t channel);
 void communication_writePacket(const Channel_t channel, const uint8_t* packet, const uint16_t size);
 
 
+/**
+ * Set the priority of outgoing packets of a communication channel. All channels
+ * have priority #PRIORITY_HIGH after communication_init(), i.e. packets are
+ * never dropped until the priorities are assigned.
+ *
+ * @param   channel   communication channel
+ * @param   priority  one of #Priority_t
+ */
+void communication_setPriority(const Channel_t channel, const Priority_t priority);
+
+
+/**
+ * Get the priority of outgoing packets of a communication channel.
+ *
+ * @param   channel   communication channel
+ * @return  one of #Priority_t
+ */
+Priority_t communication_getPriority(const Channel_t channel);
+
+
+/**
+ * Get the counters of sent, dropped and received packets of a communication
+ * channel.
+ *
+ * @param   channel   communication channel
+ * @param   stats     pointer to the structure receiving the counters
+ */
+void communication_getChannelStats(const Channel_t channel, ChannelStats_t* stats);
+
+
+/**
+ * Reset the counters of sent, dropped and received packets of all channels.
+ */
+void communication_resetChannelStats(void);
+
+
+/**
+ * Get the health counters of the communication: occurrences of each error and
+ * time spent waiting for free space in the TX buffer.
+ *
+ * The stall time is measured for packets which do not fit into the free space
+ * of the TX buffer when communication_writePacket() is called (only channels
+ * with #PRIORITY_HIGH wait, the others drop the packet instead). Without
+ * COMM_TX_ISR_FRAMING, escape characters are not taken into account, so that
+ * some stalls may be missed.
+ *
+ * Unlike communication_getErrors(), this function does not clear anything.
+ *
+ * @param   health    pointer to the structure receiving the counters
+ */
+void communication_getHealth(CommHealth_t* health);
+
+
+/**
+ * Reset the health counters, see communication_getHealth().
+ */
+void communication_resetHealth(void);
+
+
+/**
+ * Configure the rate governor for an outgoing communication channel.
+ *
+ * Periodically sent packets should be guarded by communication_isChannelDue()
+ * instead of a fixed #TIMETASK interval, so that their rate can be changed at
+ * runtime (e.g. by a control packet from HWPCS). Packets on a disabled channel
+ * are dropped by communication_writePacket() (and counted as dropped, see
+ * communication_getChannelStats()), independent of the caller. After
+ * communication_init(), all channels are enabled without minimum interval.
+ *
+ * @param   channel   communication channel
+ * @param   interval  minimum interval between packets in ms (max. 65535)
+ * @param   enabled   false to drop all packets of the channel
+ */
+void communication_setRate(const Channel_t channel, const uint16_t interval, const bool enabled);
+
+
+/**
+ * Get the minimum interval of an outgoing communication channel set with
+ * communication_setRate().
+ *
+ * @param   channel   communication channel
+ * @return  minimum interval between packets in ms
+ */
+uint16_t communication_getRateInterval(const Channel_t channel);
+
+
+/**
+ * Check if an outgoing communication channel is enabled, see
+ * communication_setRate().
+ *
+ * @param   channel   communication channel
+ * @return  true if packets of the channel are sent
+ */
+bool communication_isChannelEnabled(const Channel_t channel);
+
+
+/**
+ * Check if the next periodic packet of an outgoing communication channel is
+ * due. Returns true if the channel is enabled and at least the minimum
+ * interval of the channel (see communication_setRate()) has passed since the
+ * last time the function returned true for this channel.
+ *
+ * Requires initialization via timeTask_init(). Like #TIMETASK, the actual
+ * interval depends on how often the function is called from the main loop.
+ *
+ * <b>Usage:</b>
+ * @code
+ * if (communication_isChannelDue(CH_OUT_TELEMETRY)) {
+ *     Telemetry_t telemetry;
+ *     // ...
+ *     communication_writePacket(CH_OUT_TELEMETRY, (uint8_t*)&telemetry, sizeof(telemetry));
+ * }
+ * @endcode
+ *
+ * @param   channel   communication channel
+ * @return  true if a packet should be sent now
+ */
+bool communication_isChannelDue(const Channel_t channel);
+
+
+/**
+ * Mark an incoming communication channel as urgent. Complete packets of urgent
+ * channels are handled by communication_readPackets() ahead of other packets
+ * and independent of the budget set by communication_setReadBudget(), e.g.
+ * for stop commands or pose updates. No channel is urgent after
+ * communication_init().
+ *
+ * Packets can only be handled ahead of the order of reception if
+ * COMM_RX_ISR_FRAMING is defined (see src/cfg/io/uart/uart_cfg.h). Otherwise
+ * packets are always handled in the order of their reception.
+ *
+ * @param   channel   communication channel
+ * @param   urgent    true to handle packets of the channel first
+ */
+void communication_setUrgent(const Channel_t channel, const bool urgent);
+
+
+/**
+ * Limit the work done by a single call of communication_readPackets(), to bound
+ * the latency of the main loop independent of the incoming traffic. Remaining
+ * data is handled by the next call.
+ *
+ * If COMM_RX_ISR_FRAMING is defined, the budget is the number of bytes of
+ * complete packets handled per call. At least one packet is handled per call,
+ * packets of urgent channels (see communication_setUrgent()) are not counted.
+ * Otherwise the budget is the number of bytes read from the UART RX buffer per
+ * call. Note that the RX buffer overflows if the budget is smaller than the
+ * data received between two calls.
+ *
+ * @param   bytes     maximum number of bytes per call, 0 for no limit (default)
+ */
+void communication_setReadBudget(const uint16_t bytes);
+
+
 /**
  * Read all available packets from the corresponding UART FIFO buffer.
  * Should be called periodically from the main loop context to poll received packages.
  * The function will internally invoke registered channel callback functions
- * which can be registered with communication_setCallback().
+ * which can be registered with communication_setCallback(). The number of bytes
+ * handled per call can be limited with communication_setReadBudget().
+ *
+ * If COMM_RX_ISR_FRAMING is defined (see src/cfg/io/uart/uart_cfg.h), the
+ * packets have already been de-framed and checked by the RX complete ISR of the
+ * UART. The function then only checks the header of each complete packet and
+ * executes the callback function, independent of the size of the packet.
  *
  * The following error flags are set by this function, which can be fetched and
  * cleared with communication_getErrors(): #COMM_ERR_BUFFERFULL,
  * #COMM_ERR_TOO_SMALL, #COMM_ERR_HEADER_CHECKSUM, #COMM_ERR_SIZE_MISMATCH,
- * #COMM_ERR_CHECKSUM, #COMM_ERR_UNREGISTEREDCHANNEL
+ * #COMM_ERR_CHECKSUM, #COMM_ERR_UNREGISTEREDCHANNEL, #COMM_ERR_RX_OVERFLOW
  */
 void communication_readPackets(void);
 
@@ -167,7 +422,9 @@ void communication_readPackets(void);
  * Send a log packet to HWPCS on channel #CH_OUT_DEBUG (0x00) which is shown in the
  * Debug View.
  * The resulting message string will be truncated after 256 characters excluding
- * null termination.
+ * null termination. If channel #CH_OUT_DEBUG has priority #PRIORITY_NORMAL or
+ * #PRIORITY_LOW, the message is further truncated to the size which fits
+ * into the TX buffer without touching the reserve of that priority.
  * The function blocks until all bytes have been put into the UART transmit
  * buffer.
  *
@@ -189,7 +446,9 @@ void communication_log(const Level_t level, const char* format, ...);
  * Send a log packet to HWPCS on channel #CH_OUT_DEBUG (0x00) which is shown in the
  * Debug View.
  * The resulting message string will be truncated after 256 characters excluding
- * null termination.
+ * null termination. If channel #CH_OUT_DEBUG has priority #PRIORITY_NORMAL or
+ * #PRIORITY_LOW, the message is further truncated to the size which fits
+ * into the TX buffer without touching the reserve of that priority.
  * The function blocks until all bytes have been put into the UART transmit
  * buffer.
  *
@@ -230,7 +489,7 @@ void communication_log_P(const Level_t level, const char* format, ...);
  *                  definitions: #COMM_ERR_BUFFERFULL, #COMM_ERR_TOO_SMALL,
  *                  #COMM_ERR_HEADER_CHECKSUM, #COMM_ERR_SIZE_MISMATCH,
  *                  #COMM_ERR_CHECKSUM, #COMM_ERR_UNREGISTEREDCHANNEL,
- *                  #COMM_ERR_OUT_OF_MEMORY
+ *                  #COMM_ERR_OUT_OF_MEMORY, #COMM_ERR_RX_OVERFLOW
  */
 uint8_t communication_getErrors(void);
 
@@ -0,0 +1,79 @@
+/**
+ * @file framing.h
+ * @ingroup communication
+ *
+ * Constants of the packet framing shared by the communication library and the
+ * framing ISRs in lib/io/uart/uart_isr.S.
+ *
+ * This header is included from C and from assembler sources, so it must only
+ * contain preprocessor definitions.
+ */
+
+#ifndef FRAMING_H_
+#define FRAMING_H_
+
+/** Escape character */
+#define COMM_ESC 17
+
+/** Packet delimiter character ('+', numeric for use in assembler) */
+#define COMM_DELIM 0x2B
+
+
+/*
+ * States of the framing UDRE ISR (see COMM_TX_ISR_FRAMING in
+ * src/cfg/io/uart/uart_cfg.h). The ISR takes the raw frame
+ * (size low byte, size high byte, header byte, payload) from the TX buffer and
+ * adds escaping, global checksum and packet delimiter on the fly.
+ */
+
+/** next byte from TX buffer is the low byte of the payload size */
+#define COMM_TX_PHASE_START 0
+
+/** next byte from TX buffer is the high byte of the payload size */
+#define COMM_TX_PHASE_SIZE_HI 1
+
+/** next bytes from TX buffer are header byte and payload */
+#define COMM_TX_PHASE_BODY 2
+
+/** next byte to transmit is the global checksum */
+#define COMM_TX_PHASE_CHKSUM 3
+
+/** next byte to transmit is the packet delimiter */
+#define COMM_TX_PHASE_DELIM 4
+
+/** flag (bit 7) in the phase: escaped byte has to be transmitted next */
+#define COMM_TX_PHASE_ESCAPED 7
+
+
+/*
+ * Flags of the framing RX complete ISR (see COMM_RX_ISR_FRAMING in
+ * src/cfg/io/uart/uart_cfg.h). The ISR removes escape characters, accumulates
+ * the global checksum and places complete packets in a ring of variable-length
+ * entries.
+ */
+
+/** bit of the RX flags: last received byte was an escape character */
+#define COMM_RX_FLAG_ESC 0
+
+/** bit of the RX flags: received bytes are discarded until the next delimiter */
+#define COMM_RX_FLAG_DISCARD 1
+
+
+/*
+ * Error flags set by the framing RX complete ISR. The values are identical to
+ * the corresponding COMM_ERR_* values in communication.h.
+ */
+
+/** not enough free space in the ring for the packet */
+#define COMM_RX_ERR_BUFFERFULL 1
+
+/** packet is too small */
+#define COMM_RX_ERR_TOO_SMALL 2
+
+/** packet is longer or shorter than its payload size */
+#define COMM_RX_ERR_SIZE_MISMATCH 8
+
+/** global checksum mismatch */
+#define COMM_RX_ERR_CHECKSUM 16
+
+#endif /* FRAMING_H_ */
@@ -65,8 +65,17 @@ typedef enum {
 	CH_OUT_USER_DATA = 0x06, ///< for sending UserData_t to User Data View in HWPCS
 	CH_OUT_RDP = 0x07, ///< for sending remote data processing command to RDP View in HWPCS
 	CH_IN_ADDITIONAL_POSE = 0x08, ///< for receiving Pose_t of additional AprilTag from HWPCS
+	CH_IN_POSE_STREAM_ACK = 0x09, ///< for receiving PoseStreamAck_t (custom, keyframe acknowledgement)
+	CH_IN_RATE_CONFIG = 0x0A, ///< for receiving RateConfig_t (custom, output rates of channels)
+	CH_IN_PING = 0x0B, ///< for receiving Ping_t (custom, round trip probes of HWPCS and echoes of the robot's probes)
 	CH_OUT_LABY_CELL_INFO = 0x08, ///< for sending LabyrinthCellInfo_t to be displayed in Scene View in HWPCS
-	CH_OUT_LABY_WALL_INFO = 0x09 ///< for sending LabyrinthWallInfo_t to be displayed in Scene View in HWPCS
+	CH_OUT_LABY_WALL_INFO = 0x09, ///< for sending LabyrinthWallInfo_t to be displayed in Scene View in HWPCS
+	CH_OUT_MUX_TELEMETRY = 0x0A, ///< for sending MuxTelemetry_t (custom, not shown by HWPCS)
+	CH_OUT_POSE_STREAM = 0x0B, ///< for sending PoseKeyframe_t and pose deltas (custom, not shown by HWPCS)
+	CH_OUT_COMM_STATS = 0x0C, ///< for sending CommStats_t with CommChannelStats_t (custom, not shown by HWPCS)
+	CH_OUT_TRACE = 0x0D, ///< for sending TraceDump_t with TraceSample_t of the flight recorder (custom, not shown by HWPCS)
+	CH_OUT_PING = 0x0E, ///< for sending Ping_t (custom, round trip probes of the robot and echoes of HWPCS' probes)
+	CH_OUT_RECORD = 0x0F ///< for sending RecordHeader_t and recorded inputs of the main loop (custom, not shown by HWPCS)
 } Channel_t;
 
 
@@ -402,4 +411,318 @@ typedef struct __attribute__((__packed__)) {
     int8_t info;     ///< information associated with the wall (use -128 to clear wall info in HWPCS)
 } LabyrinthWallInfo_t;
 
+
+/** (Custom PacketType)
+ * Sections of MuxTelemetry_t, used as bits of MuxTelemetry_t::sections.
+ * The sections follow the header in the order of their bits.
+ */
+typedef enum {
+    MUX_POSE = 0x01,      ///< Pose_t, 12 Bytes
+    MUX_ENCODERS = 0x02,  ///< MuxEncoders_t, 4 Bytes
+    MUX_INFRARED = 0x04,  ///< MuxInfrared_t, 6 Bytes
+    MUX_PWM = 0x08,       ///< MuxPWM_t, 4 Bytes
+    MUX_FOLLOWER = 0x10,  ///< MuxFollower_t, 9 Bytes
+    MUX_QUEUE = 0x20,     ///< MuxQueue_t, 2 Bytes
+    MUX_ALL = 0x3F        ///< all sections
+} MuxSection_t;
+
+
+/** (Custom PacketType)
+ * Multiplexed telemetry frame.
+ * Bundles several sections sampled at the same time into one packet, so that
+ * the per-packet overhead is paid only once and the samples can be correlated
+ * on the receiving side. The header is followed by the sections selected in
+ * the bitmask sections, in the order of MuxSection_t (lowest bit first).
+ *
+ * - sent on channel #CH_OUT_MUX_TELEMETRY (0x0A)
+ * - size: 5 Bytes + size of selected sections (max. 42 Bytes)
+ */
+typedef struct __attribute__((__packed__)) {
+    uint32_t timestamp; ///< uptime of robot when the sections were sampled, measured in ms
+    uint8_t sections;   ///< bitmask of included sections, see MuxSection_t
+} MuxTelemetry_t;
+
+
+/** (Custom PacketType)
+ * Section #MUX_ENCODERS of MuxTelemetry_t
+ */
+typedef struct __attribute__((__packed__)) {
+    int16_t encoder1; ///< encoder 1 output measured in tics
+    int16_t encoder2; ///< encoder 2 output measured in tics
+} MuxEncoders_t;
+
+
+/** (Custom PacketType)
+ * Section #MUX_INFRARED of MuxTelemetry_t
+ */
+typedef struct __attribute__((__packed__)) {
+    uint16_t left;  ///< distance of left infrared sensor measured in mm
+    uint16_t right; ///< distance of right infrared sensor measured in mm
+    uint16_t front; ///< distance of front infrared sensor measured in mm
+} MuxInfrared_t;
+
+
+/** (Custom PacketType)
+ * Section #MUX_PWM of MuxTelemetry_t
+ */
+typedef struct __attribute__((__packed__)) {
+    int16_t left;  ///< last PWM value of left motor in [-8191...+8191]
+    int16_t right; ///< last PWM value of right motor in [-8191...+8191]
+} MuxPWM_t;
+
+
+/** (Custom PacketType)
+ * Section #MUX_FOLLOWER of MuxTelemetry_t
+ */
+typedef struct __attribute__((__packed__)) {
+    bool enabled;       ///< true if path following is enabled
+    FPoint_t lookahead; ///< current lookahead point where robot is heading to
+} MuxFollower_t;
+
+
+/** (Custom PacketType)
+ * Section #MUX_QUEUE of MuxTelemetry_t
+ */
+typedef struct __attribute__((__packed__)) {
+    uint8_t size;  ///< number of tasks in the task queue (max. 255)
+    uint8_t flags; ///< bit 0: task queue is iterating, bit 1: task is active
+} MuxQueue_t;
+
+
+/** (Custom PacketType)
+ * Flag (bit 7) in the header byte of the packets on #CH_OUT_POSE_STREAM marking
+ * a keyframe. Bits 6-0 hold the sequence number of the keyframe.
+ */
+#define POSE_STREAM_KEYFRAME 0x80
+
+
+/** (Custom PacketType)
+ * Keyframe of the pose stream.
+ * Contains the full pose in fixed point units. The receiver acknowledges the
+ * keyframe with PoseStreamAck_t, afterwards the robot sends deltas against it.
+ *
+ * Delta packets consist of a header byte (bit 7 cleared, bits 6-0 hold the
+ * sequence number of the acknowledged keyframe the delta refers to) followed by
+ * three variable length integers for x, y (0.1mm) and theta (1mrad,
+ * wrapped to [-pi, pi)). Each value is zigzag encoded
+ * (0, -1, 1, -2, ... => 0, 1, 2, 3, ...) and sent in groups of 7 bits,
+ * least significant group first, bit 7 set if further groups follow.
+ *
+ * - sent on channel #CH_OUT_POSE_STREAM (0x0B)
+ * - size: 11 Bytes (keyframe), 4 - 14 Bytes (delta)
+ */
+typedef struct __attribute__((__packed__)) {
+    uint8_t header; ///< #POSE_STREAM_KEYFRAME | sequence number (0-127)
+    int32_t x;      ///< x coordinate of robot in global frame measured in 0.1mm
+    int32_t y;      ///< y coordinate of robot in global frame measured in 0.1mm
+    int16_t theta;  ///< orientation angle of robot measured in mrad
+} PoseKeyframe_t;
+
+
+/** (Custom PacketType)
+ * Acknowledgement of a keyframe of the pose stream.
+ *
+ * - received on channel #CH_IN_POSE_STREAM_ACK (0x09)
+ * - size: 1 Byte
+ */
+typedef struct __attribute__((__packed__)) {
+    uint8_t seq; ///< sequence number of the received keyframe
+} PoseStreamAck_t;
+
+
+/** (Custom PacketType)
+ * Configuration of the output rate of a channel, see communication_setRate().
+ * A packet may contain several entries, which are applied in order.
+ *
+ * - received on channel #CH_IN_RATE_CONFIG (0x0A)
+ * - size: 4 Bytes per entry
+ */
+typedef struct __attribute__((__packed__)) {
+    uint8_t channel;   ///< outgoing channel (0x00 - 0x0F)
+    uint8_t enabled;   ///< 0 to disable the channel, 1 to enable it
+    uint16_t interval; ///< minimum interval between packets of the channel measured in ms
+} RateConfig_t;
+
+
+/** (Custom PacketType)
+ * Sample of the flight recorder (src/telemetry/trace.h).
+ *
+ * - size: 14 Bytes
+ */
+typedef struct __attribute__((__packed__)) {
+    uint16_t time;     ///< uptime of robot measured in ms (wraps after 65.5s)
+    int8_t encoder1;   ///< encoder 1 tics since previous sample (saturated)
+    int8_t encoder2;   ///< encoder 2 tics since previous sample (saturated)
+    int16_t pwmLeft;   ///< PWM value of left motor in [-8191...+8191]
+    int16_t pwmRight;  ///< PWM value of right motor in [-8191...+8191]
+    int16_t theta;     ///< orientation angle of robot measured in mrad
+    uint8_t ir[3];     ///< raw ADC values of left, right and front infrared sensor divided by 4
+    uint8_t state;     ///< bit 0: task queue is iterating, bit 1: task is active, bit 2: path follower is enabled
+} TraceSample_t;
+
+
+/** (Custom PacketType)
+ * Part of a dump of the flight recorder.
+ * Followed by up to #TRACE_DUMP_CHUNK TraceSample_t, oldest sample first.
+ *
+ * - sent on channel #CH_OUT_TRACE (0x0D)
+ * - size: 2 Bytes + 14 Bytes per sample
+ */
+typedef struct __attribute__((__packed__)) {
+    uint8_t index; ///< index of the first sample of this packet in the dump
+    uint8_t total; ///< total number of samples of the dump
+} TraceDump_t;
+
+/**
+ * Maximum number of TraceSample_t per TraceDump_t packet
+ */
+#define TRACE_DUMP_CHUNK 8
+
+
+/** (Custom PacketType)
+ * Health counters of the communication (see communication_getHealth()).
+ * Followed by one CommChannelStats_t for each bit set in channels, in the
+ * order of the channel numbers. All counters are cumulative since boot (or the
+ * last reset), the receiver computes rates from the difference of two packets.
+ *
+ * - sent on channel #CH_OUT_COMM_STATS (0x0C)
+ * - size: 28 Bytes + 14 Bytes per channel
+ */
+typedef struct __attribute__((__packed__)) {
+    uint32_t timestamp;   ///< uptime of robot when the counters were sampled, measured in ms
+    uint16_t errors[8];   ///< occurrences of each communication error, indexed by the bit number of COMM_ERR_*
+    uint16_t txStalls;    ///< number of packets which had to wait for free space in the TX buffer
+    uint32_t txStallTime; ///< total time spent waiting for free space in the TX buffer in us
+    uint16_t channels;    ///< bitmask of channels with a following CommChannelStats_t
+} CommStats_t;
+
+
+/** (Custom PacketType)
+ * Counters of one channel in CommStats_t, see ChannelStats_t.
+ *
+ * - size: 14 Bytes
+ */
+typedef struct __attribute__((__packed__)) {
+    uint16_t sent;          ///< number of outgoing packets put into the TX buffer
+    uint16_t dropped;       ///< number of outgoing packets dropped
+    uint16_t received;      ///< number of valid incoming packets
+    uint32_t sentBytes;     ///< payload bytes of the sent packets
+    uint32_t receivedBytes; ///< payload bytes of the received packets
+} CommChannelStats_t;
+
+
+/** (Custom PacketType)
+ * Flag in Ping_t::flags marking the echo of a probe
+ */
+#define PING_ECHO 0x01
+
+
+/** (Custom PacketType)
+ * Round trip probe.
+ * The sender stamps the probe with its own clock, the receiver returns it
+ * unchanged except for #PING_ECHO set in flags. The round trip time is the
+ * difference between the time of arrival of the echo and the stamp, lost
+ * probes show up as gaps in the sequence numbers of the echoes.
+ *
+ * - probes of the robot: sent on #CH_OUT_PING (0x0E), echoed on #CH_IN_PING (0x0B)
+ * - probes of HWPCS: received on #CH_IN_PING (0x0B), echoed on #CH_OUT_PING (0x0E)
+ * - size: 8 Bytes
+ */
+typedef struct __attribute__((__packed__)) {
+    uint8_t flags;    ///< 0 for a probe, #PING_ECHO for its echo
+    uint8_t seq;      ///< sequence number of the probe (incremented by the sender per probe)
+    uint32_t time_ms; ///< time of the sender when sending the probe, milliseconds
+    uint16_t time_us; ///< time of the sender when sending the probe, microseconds in the range 0 to 999
+} Ping_t;
+
+
+/** (Custom PacketType)
+ * Pose request with sequence number.
+ * Extends GetPose_t by a sequence number, which the receiver appends to its
+ * answer (PoseSeq_t instead of Pose_t), so that the answer can be assigned to
+ * its request. Only for receivers supporting it (e.g. tools/hwpcs), see
+ * ping_setPoseSeq() in src/telemetry/ping.h.
+ *
+ * - sent on channel #CH_OUT_GET_POSE (0x05)
+ * - size: 2 Bytes
+ */
+typedef struct __attribute__((__packed__)) {
+    AprilTagType_t aprilTagType; ///< type of AprilTag for which tracking information is requested
+    uint8_t seq;                 ///< sequence number of the request (incremented per request)
+} GetPoseSeq_t;
+
+
+/** (Custom PacketType)
+ * Answer to GetPoseSeq_t.
+ *
+ * - received on channel #CH_IN_POSE (0x05) or #CH_IN_ADDITIONAL_POSE (0x08)
+ * - size: 13 Bytes
+ */
+typedef struct __attribute__((__packed__)) {
+    Pose_t pose; ///< tracked pose
+    uint8_t seq; ///< sequence number of the answered GetPoseSeq_t
+} PoseSeq_t;
+
+
+/** (Custom PacketType)
+ * Header of a packet of the input recording (src/telemetry/record.h).
+ *
+ * The packets on #CH_OUT_RECORD form one continuous stream of events, an event
+ * may be continued in the next packet. A gap in the sequence numbers means that
+ * packets were lost and the recording cannot be replayed beyond that point.
+ *
+ * Events (varint: LEB128, zigzag: signed varint with zigzag encoding, deltas
+ * refer to the previous iteration of the main loop):
+ * - 0x00-0x7F (#RECORD_TICK): start of an iteration, bits 6-0 flag the changed
+ *   inputs (#RECORD_INPUT_UPTIME ...), followed by one value per set bit:
+ *   varint uptime delta in ms, zigzag encoder 1/2 tics, varint bumper ISR
+ *   counts, zigzag delta of the filtered ADC values of IR channels 0-2
+ * - 0x80-0xBF (#RECORD_IDLE): (bits 5-0) + 1 iterations without changed inputs
+ *   and without any other event
+ * - 0xC0 (#RECORD_PACKET): received packet, followed by channel (1 byte),
+ *   varint size and the payload
+ * - 0xC1 (#RECORD_DECISION): outputs changed at the end of the iteration,
+ *   followed by zigzag PWM left and right, varint size of the task queue and a
+ *   state byte (bit 0: task queue is iterating, bit 1: task is active)
+ * - 0xC2 (#RECORD_START): first iteration of the recording, followed by the
+ *   absolute inputs: varint uptime, zigzag encoder 1/2 totals, varint bumper
+ *   counts, varint ADC values of IR channels 0-2
+ * - 0xC3 (#RECORD_CONTROL): step of the control tier (timer interrupt, see
+ *   src/driving/control.h), followed by its inputs as deltas to the previous
+ *   step (the first step refers to section 0 and the inputs of #RECORD_START):
+ *   varint section (number of the main loop section the step ran before),
+ *   zigzag uptime in ms, zigzag encoder 1/2 totals. Steps are written at the
+ *   start and end of an iteration, at the latest in the iteration containing
+ *   the section they precede.
+ * - 0xC4 (#RECORD_CONTROL_LOST): the buffer of control steps overflowed, the
+ *   recording cannot be replayed beyond this point
+ *
+ * - sent on channel #CH_OUT_RECORD (0x0F)
+ * - size: 1 Byte + up to #RECORD_CHUNK Bytes of events
+ */
+typedef struct __attribute__((__packed__)) {
+    uint8_t seq; ///< sequence number of the packet (incremented per packet)
+} RecordHeader_t;
+
+#define RECORD_TICK 0x00
+#define RECORD_IDLE 0x80
+#define RECORD_PACKET 0xC0
+#define RECORD_DECISION 0xC1
+#define RECORD_START 0xC2
+#define RECORD_CONTROL 0xC3
+#define RECORD_CONTROL_LOST 0xC4
+
+#define RECORD_INPUT_UPTIME 0x01
+#define RECORD_INPUT_ENCODER1 0x02
+#define RECORD_INPUT_ENCODER2 0x04
+#define RECORD_INPUT_BUMPER 0x08
+#define RECORD_INPUT_IR0 0x10
+#define RECORD_INPUT_IR1 0x20
+#define RECORD_INPUT_IR2 0x40
+
+/**
+ * Maximum number of event bytes per packet on #CH_OUT_RECORD
+ */
+#define RECORD_CHUNK 64
+
 #endif /* PACKETTYPES_H_ */
@@ -6,11 +6,13 @@
 
 
 // Macro for defining non-blocking or blocking (default) transmit,
-// used in uart_writeX()
+// used in uart_writeX() and uart_writeBlockX()
 #ifndef UART_NONBLOCKING_TRANSMIT
     #define WAIT_FOR_FREE_SPACE while (tmpHead == uart->txTail);
+    #define WAIT_FOR_FREE_BLOCK(uartID) while (uart_getTXBufSpace##uartID() < len);
 #else
     #define WAIT_FOR_FREE_SPACE
+    #define WAIT_FOR_FREE_BLOCK(uartID) if (uart_getTXBufSpace##uartID() < len) return false;
 #endif
 
 
@@ -21,6 +23,10 @@
  * uart_isRXBufOverflowX().
  *
  * Note that the usable buffer size is UART*_*_BUFFER_SIZE - 1 !
+ *
+ * txPhase, txEscByte, txChksum and txRemain hold the state of the framing UDRE
+ * ISR (see COMM_TX_ISR_FRAMING) and are unused otherwise. The ISRs in
+ * uart_isr.S access all members by their offset, so do not reorder them.
  */
 typedef struct __attribute__((__packed__)) {
     uint8_t rxHead;
@@ -28,11 +34,16 @@ typedef struct __attribute__((__packed__)) {
     uint8_t txHead;
     uint8_t txTail;
     uint8_t rxBufOverflow;
+    uint8_t txPhase;
+    uint8_t txEscByte;
+    uint8_t txChksum;
+    uint16_t txRemain;
 } uart_t;
 
 
 /** Macros for defining all functions from uart.h based on ID X of UART
         uart_writeX(const uint8_t data)
+        bool uart_writeBlockX(const uint8_t* data, const uint8_t len)
         uint8_t uart_readX(void)
         bool uart_availableX(void)
         bool uart_TXBufSpaceAvailableX(void)
@@ -58,6 +69,24 @@ typedef struct __attribute__((__packed__)) {
         UCSR##uartID##B = _BV(UDRIE##uartID) | _BV(RXCIE##uartID) | _BV(TXEN##uartID) | _BV(RXEN##uartID); \
     }
 
+#define uart_writeBlockMacro(uartID) \
+    bool uart_writeBlock##uartID (const uint8_t* data, const uint8_t len) { \
+        volatile uart_t* uart = &uart##uartID; \
+        /* if TX buffer has not enough space, busy wait once for the whole block */ \
+        WAIT_FOR_FREE_BLOCK(uartID) \
+        /* store data in TX buffer */ \
+        uint8_t tmpHead = uart->txHead; \
+        for (uint8_t i = 0; i < len; i++) { \
+            tmpHead = (tmpHead + 1) & UART##uartID##_TX_MASK; \
+            uart##uartID##_TX_buf[tmpHead] = data[i]; \
+        } \
+        /* make data available to txISR by updating head */ \
+        uart->txHead = tmpHead; \
+        /* enable UDRE interrupt */ \
+        UCSR##uartID##B = _BV(UDRIE##uartID) | _BV(RXCIE##uartID) | _BV(TXEN##uartID) | _BV(RXEN##uartID); \
+        return true; \
+    }
+
 #define uart_readMacro(uartID) \
     uint8_t uart_read##uartID(void) { \
         volatile uart_t* uart = &uart##uartID; \
@@ -161,6 +190,7 @@ typedef struct __attribute__((__packed__)) {
 
     // Implement all functions for UART 0
     uart_writeMacro(0)
+    uart_writeBlockMacro(0)
     uart_readMacro(0)
     uart_availableMacro(0)
     uart_TXBufSpaceAvailableMacro(0)
@@ -198,6 +228,7 @@ typedef struct __attribute__((__packed__)) {
 
     // Implement all functions for UART 1
     uart_writeMacro(1)
+    uart_writeBlockMacro(1)
     uart_readMacro(1)
     uart_availableMacro(1)
     uart_TXBufSpaceAvailableMacro(1)
@@ -235,6 +266,7 @@ typedef struct __attribute__((__packed__)) {
 
     // Implement all functions for UART 2
     uart_writeMacro(2)
+    uart_writeBlockMacro(2)
     uart_readMacro(2)
     uart_availableMacro(2)
     uart_TXBufSpaceAvailableMacro(2)
@@ -272,6 +304,7 @@ typedef struct __attribute__((__packed__)) {
 
     // Implement all functions for UART 3
     uart_writeMacro(3)
+    uart_writeBlockMacro(3)
     uart_readMacro(3)
     uart_availableMacro(3)
     uart_TXBufSpaceAvailableMacro(3)
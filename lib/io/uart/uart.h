@@ -85,6 +85,40 @@ void uart_write2(const uint8_t data);
 void uart_write3(const uint8_t data);
 
 
+/**
+ * Write a block of bytes to the FIFO TX buffer of the corresponding UART. In
+ * contrast to calling <code>uart_writeX()</code> for each byte, this function
+ * waits only once until the whole block fits into the buffer and makes all
+ * bytes available to the UDRE ISR at once.
+ *
+ * Due to blocking, this function must not be called from interrupt context.
+ *
+ * Note: If compiled with the symbol UART_NONBLOCKING_TRANSMIT defined, the
+ *       whole block is discarded if it does not fit into the buffer.
+ *
+ * @param   data   pointer to the bytes to be placed into the TX buffer
+ * @param   len    number of bytes, at most UART*_TX_BUFFER_SIZE - 1
+ * @return  true if the block was placed into the TX buffer, false if it was
+ *          discarded
+ */
+bool uart_writeBlock0(const uint8_t* data, const uint8_t len);
+
+/**
+ * @copydoc uart_writeBlock0()
+ */
+bool uart_writeBlock1(const uint8_t* data, const uint8_t len);
+
+/**
+ * @copydoc uart_writeBlock0()
+ */
+bool uart_writeBlock2(const uint8_t* data, const uint8_t len);
+
+/**
+ * @copydoc uart_writeBlock0()
+ */
+bool uart_writeBlock3(const uint8_t* data, const uint8_t len);
+
+
 /**
  * Check if a single byte can be read from the receive FIFO buffer via
  * <code>uart_readX()</code> without blocking.
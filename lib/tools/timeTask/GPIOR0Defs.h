@@ -42,4 +42,14 @@
 #define GPIOR0_ADC_BIT 2
 
 
+/**
+ * Definition of bit in GPIOR0 used by timeTask_latchUptime() and
+ * timeTask_getTaskUptime().
+ * If the bit defined by GPIOR0_LATCH_BIT is set, the #TIMETASK macro uses the
+ * uptime latched by the last call of timeTask_latchUptime() instead of the
+ * current uptime.
+*/
+#define GPIOR0_LATCH_BIT 3
+
+
 #endif /* GPIOR0DEFS_H_ */
@@ -19,6 +19,14 @@
  */
 uint16_t timeTask_uptime[2] = { 0, 65535 };
 
+/**
+ * Uptime in milliseconds latched by timeTask_latchUptime(). Only valid if the
+ * bit GPIOR0_LATCH_BIT in GPIOR0 is set.
+ *
+ * This variable is internally used by timeTask_getTaskUptime().
+ */
+uint16_t timeTask_latchedUptime = 0;
+
 /**
  * timeTask_time_ms counts the uptime in milliseconds for use of execution
  * time measurement. This value is incremented by timer 5 compare match
@@ -27,6 +27,8 @@
  *   #TIMETASK macro when reading the current uptime in milliseconds. With this
  *   double buffering, there is no need to disable interrupts in main context
  *   when reading from the array, as access to the array index is atomic.
+ * - The bit defined by #GPIOR0_LATCH_BIT is set by timeTask_latchUptime() and
+ *   makes the #TIMETASK macro use the latched instead of the current uptime.
  *
  * The register GPIOR0 is cleared during startup by placing appropriate code
  * into the .init3 section.
@@ -108,6 +110,9 @@ void timeTask_init(void);
  *
  * The maximum interval is 65535ms!
  *
+ * If timeTask_latchUptime() has been called, all time tasks compare against
+ * the latched uptime (see timeTask_getTaskUptime()).
+ *
  * <b>Usage:</b>
  * @code
  * for(;;) { // main loop
@@ -130,7 +135,7 @@ void timeTask_init(void);
  */
 #define TIMETASK(name, interval_ms)                                      \
     static uint16_t name = 0;                                            \
-    register uint16_t tt_uptime_##name = timeTask_getUptime();           \
+    register uint16_t tt_uptime_##name = timeTask_getTaskUptime();       \
     register uint8_t tt_ex_##name = 0;                                   \
     if ((tt_uptime_##name - name) >= (uint16_t)interval_ms) {            \
         name = tt_uptime_##name;                                         \
@@ -141,8 +146,8 @@ void timeTask_init(void);
 
 /**
  * Get current uptime in milliseconds.
- * This function is internally used by the #TIMETASK macro when checking
- * if the time task needs to be executed.
+ * This function is internally used by timeTask_getTaskUptime() when checking
+ * if a time task needs to be executed.
  *
  * @return  current uptime in milliseconds
  */
@@ -172,6 +177,39 @@ static inline uint16_t __attribute__((always_inline)) timeTask_getUptime(void) {
 }
 
 
+/**
+ * Latch the current uptime. Until the next call, timeTask_getTaskUptime() and
+ * thus the #TIMETASK macro use this uptime instead of the current one.
+ *
+ * Calling this function once at the beginning of each main loop iteration
+ * makes all time tasks of an iteration see the same uptime, so that the
+ * decisions taken in an iteration only depend on the state at its beginning
+ * (e.g. for recording and replaying the inputs of the main loop).
+ */
+static inline void timeTask_latchUptime(void) {
+	extern uint16_t timeTask_latchedUptime;
+
+	timeTask_latchedUptime = timeTask_getUptime();
+	GPIOR0 |= _BV(GPIOR0_LATCH_BIT);
+}
+
+
+/**
+ * Get the uptime in milliseconds relevant for time tasks: the uptime latched by
+ * timeTask_latchUptime() or the current uptime if it has never been called.
+ * This function is internally used by the #TIMETASK macro.
+ *
+ * @return  uptime in milliseconds
+ */
+static inline uint16_t __attribute__((always_inline)) timeTask_getTaskUptime(void) {
+	extern uint16_t timeTask_latchedUptime;
+
+	if (GPIOR0 & _BV(GPIOR0_LATCH_BIT))
+		return timeTask_latchedUptime;
+	return timeTask_getUptime();
+}
+
+
 /**
  * Get a timestamp for execution time measurement.
  *
@@ -47,20 +47,83 @@
 #define COMM_RECV_BUFFER_SIZE 1024
 
 
+/**
+ * If defined, packet framing for outgoing packets (escaping, global checksum
+ * and packet delimiter) is done by the UDRE ISR of #COMM_UART instead of
+ * communication_writePacket(). The TX buffer then contains the unescaped packet
+ * and communication_writePacket() copies header and payload as blocks without
+ * waiting for each single byte.
+ *
+ * Note that in this mode the TX buffer of #COMM_UART must only be written by
+ * the communication library.
+ */
+#define COMM_TX_ISR_FRAMING
+
+/**
+ * Maximum number of payload bytes that communication_writePacket() copies into
+ * the TX buffer at once if #COMM_TX_ISR_FRAMING is defined. Packets larger than
+ * the free space in the TX buffer are copied in blocks of this size.
+ */
+#define COMM_TX_BLOCK_SIZE 64
+
+
+/**
+ * If defined, incoming packets are de-framed by the RX complete ISR of
+ * #COMM_UART: escape characters are removed, the global checksum is verified
+ * and complete packets are placed in a ring of #COMM_RX_RING_SIZE bytes, each
+ * with a 2 byte length prefix. communication_readPackets() then only checks the
+ * header and executes the callback functions.
+ *
+ * Note that in this mode the RX buffer of #COMM_UART is not used, uart_readX()
+ * and uart_availableX() must not be called for #COMM_UART.
+ */
+#define COMM_RX_ISR_FRAMING
+
+/**
+ * Size of the ring for incoming packets if #COMM_RX_ISR_FRAMING is defined.
+ * Holds packets of up to #COMM_RECV_BUFFER_SIZE bytes like the receive buffer
+ * without #COMM_RX_ISR_FRAMING (4 bytes for the length prefix and the gap at
+ * the end of the ring), or many small packets, e.g. about 140 user commands.
+ * A packet which does not fit into the free space when its payload size has
+ * been received is discarded.
+ */
+#define COMM_RX_RING_SIZE (COMM_RECV_BUFFER_SIZE + 4)
+
+
+/**
+ * If defined, packets are framed with Consistent Overhead Byte Stuffing (COBS,
+ * see lib/communication/cobs.h) instead of escape characters. The packet
+ * (payload size, header byte, payload, checksum) is COBS encoded and terminated
+ * by a zero byte. This limits the overhead to one byte per 254 bytes, however
+ * the other side of the link must use COBS framing as well (see tools/framing).
+ *
+ * Can not be combined with #COMM_TX_ISR_FRAMING and #COMM_RX_ISR_FRAMING.
+ */
+//#define COMM_FRAMING_COBS
+
+
 /// @cond
 
 // enable UARTs depending on previous choice
 #if( (COMM_UART == USB) || defined(ENABLE_USB) )
     #define USE_UART0
     #define UART0_TX_BUFFER_SIZE 256        // Power of 2!
-    #define UART0_RX_BUFFER_SIZE 128        // Power of 2!
+    #if( defined(COMM_RX_ISR_FRAMING) && (COMM_UART == USB) )
+        #define UART0_RX_BUFFER_SIZE 2      // unused, packets are received by the framing RX ISR
+    #else
+        #define UART0_RX_BUFFER_SIZE 128    // Power of 2!
+    #endif
     #define BAUD_RATE0 500000
 #endif
 
 #if( (COMM_UART == WIFI) || defined(ENABLE_WIFI) )
     #define USE_UART1
     #define UART1_TX_BUFFER_SIZE 256        // Power of 2!
-    #define UART1_RX_BUFFER_SIZE 128        // Power of 2!
+    #if( defined(COMM_RX_ISR_FRAMING) && (COMM_UART == WIFI) )
+        #define UART1_RX_BUFFER_SIZE 2      // unused, packets are received by the framing RX ISR
+    #else
+        #define UART1_RX_BUFFER_SIZE 128    // Power of 2!
+    #endif
     #define BAUD_RATE1 500000
 #endif
 
@@ -1,14 +1,22 @@
 #include "channels.h"
 #include "../main.h"
 #include "../driving/driving.h"
+#include "../driving/speedControl.h"
+#include "../driving/control.h"
 #include "../tasks/taskManagement.h"
 #include "../sensors/sensors.h"
 #include "../explorer/labyrinthState.h"
 #include "../explorer/robot.h"
 #include "../pose/pose.h"
+#include "../pose/calibration.h"
+#include "../params/params.h"
 #include "tools/labyrinth/labyrinth.h"
 #include "../explorer/explorer.h"
 #include "../sensors/vision.h"
+#include "../telemetry/muxTelemetry.h"
+#include "../telemetry/poseStream.h"
+#include "../telemetry/trace.h"
+#include "../telemetry/ping.h"
 
 #include <motor/motor.h>
 
@@ -197,6 +205,105 @@ void commUserCommand(const uint8_t* packet, __attribute__((unused)) const uint16
         case 42: // command ID 42: getRow & getColumn
             communication_log_P(LEVEL_INFO, PSTR("column: %i, row: %i"), robot_getColumn(), robot_getRow());
             break;
+        case 43: { // command ID 43: Pakete pro Kanal, Fehler und Wartezeit beim Senden ausgeben und zurücksetzen
+            // Ausgabe blockierend senden, damit keine Zeile verworfen wird
+            Priority_t debugPriority = communication_getPriority(CH_OUT_DEBUG);
+            communication_setPriority(CH_OUT_DEBUG, PRIORITY_HIGH);
+            for (uint8_t channel = 0; channel < COMM_MAX_CHANNELS; channel++) {
+                ChannelStats_t stats;
+                communication_getChannelStats(channel, &stats);
+                if (stats.sent || stats.dropped || stats.received) {
+                    communication_log_P(LEVEL_INFO, PSTR("channel %u: sent %u (%" PRIu32 " B), dropped %u, received %u (%" PRIu32 " B)"),
+                        channel, stats.sent, stats.sentBytes, stats.dropped, stats.received, stats.receivedBytes);
+                }
+            }
+            CommHealth_t health;
+            communication_getHealth(&health);
+            communication_log_P(LEVEL_INFO, PSTR("errors: %u %u %u %u %u %u %u %u, tx stalls: %u (%" PRIu32 " us)"),
+                health.errors[0], health.errors[1], health.errors[2], health.errors[3], health.errors[4],
+                health.errors[5], health.errors[6], health.errors[7], health.txStalls, health.txStallTime);
+            communication_resetChannelStats();
+            communication_resetHealth();
+            communication_setPriority(CH_OUT_DEBUG, debugPriority);
+            break;
+        }
+        case 44: // command ID 44: gemeinsamen Telemetrie-Frame (alle Abschnitte) ein-/ausschalten
+            muxTelemetry_setSections(muxTelemetry_getSections() ? 0 : MUX_ALL);
+            communication_log_P(LEVEL_INFO, PSTR("muxTelemetry sections: %u"), muxTelemetry_getSections());
+            break;
+        case 45: // command ID 45: Pose-Datenstrom (Keyframes und Deltas) statt Pose_t ein-/ausschalten
+            poseStream_setEnabled(!poseStream_isEnabled());
+            communication_log_P(LEVEL_INFO, PSTR("poseStream: %i"), poseStream_isEnabled());
+            break;
+        case 46: // command ID 46: Flugschreiber einfrieren und auf CH_OUT_TRACE senden
+            trace_dump();
+            break;
+        case 47: { // command ID 47: Umlaufzeiten (min/avg/max in us) und Verluste von Pings und Pose-Anfragen ausgeben und zurücksetzen
+            const RttStats_t* stats[] = { ping_getStats(), ping_getPoseStats() };
+            Priority_t debugPriority = communication_getPriority(CH_OUT_DEBUG);
+            communication_setPriority(CH_OUT_DEBUG, PRIORITY_HIGH);
+            for (uint8_t i = 0; i < 2; i++) {
+                communication_log_P(LEVEL_INFO, PSTR("%s rtt: min %" PRIu32 ", avg %" PRIu32 ", max %" PRIu32 ", answered %u, lost %u"),
+                    i == 0 ? "ping" : "pose", stats[i]->min, stats[i]->count ? stats[i]->sum / stats[i]->count : 0,
+                    stats[i]->max, stats[i]->count, stats[i]->lost);
+            }
+            ping_resetStats();
+            communication_setPriority(CH_OUT_DEBUG, debugPriority);
+            break;
+        }
+        case 48: // command ID 48: Pose-Anfragen mit Sequenznummer (GetPoseSeq_t) ein-/ausschalten
+            ping_setPoseSeq(!ping_isPoseSeqEnabled());
+            communication_log_P(LEVEL_INFO, PSTR("poseSeq: %i"), ping_isPoseSeqEnabled());
+            break;
+        case 49: // command ID 49: Pause zwischen Tasks bei Stillstand beenden ein-/ausschalten
+            setSettleDetection(!isSettleDetection());
+            communication_log_P(LEVEL_INFO, PSTR("settleDetection: %i"), isSettleDetection());
+            break;
+        case 50: // command ID 50: kompatible Tasks ohne Anhalten überblenden ein-/ausschalten
+            setTaskBlending(!isTaskBlending());
+            communication_log_P(LEVEL_INFO, PSTR("taskBlending: %i"), isTaskBlending());
+            break;
+        case 51: // command ID 51: Geschwindigkeitsprofil (Beschleunigen/Bremsen) der Tasks ein-/ausschalten
+            setMotionProfile(!isMotionProfile());
+            communication_log_P(LEVEL_INFO, PSTR("motionProfile: %i"), isMotionProfile());
+            break;
+        case 52: // command ID 52: Geschwindigkeitsregelung der Räder (PI) ein-/ausschalten
+            stopDrive();
+            speedControl_setEnabled(!speedControl_isEnabled());
+            communication_log_P(LEVEL_INFO, PSTR("speedControl: %i"), speedControl_isEnabled());
+            break;
+        case 53: { // command ID 53: Zeitverhalten der Regelungsebene (Schritte, größter Abstand, Überläufe) ausgeben und zurücksetzen
+            ControlStats_t stats;
+            control_getStats(&stats);
+            communication_log_P(LEVEL_INFO, PSTR("control: steps %u, max period %u ms, overruns %u, max duration %u us"), stats.steps, stats.maxPeriod, stats.overruns, stats.maxDuration);
+            control_resetStats();
+            break;
+        }
+        case 54: // command ID 54: Kalibrierung der Odometrie (mm pro Tic beider Räder, Achsenlänge) starten
+            calibration_start();
+            break;
+        case 55: // command ID 55: Parameter auf die Standardwerte aus main.c zurücksetzen (auch im EEPROM)
+            params_reset();
+            break;
+        case 56: { // command ID 56: Toleranz der Neuausrichtung vor einem Move erhöhen (nach dem Maximum wieder klein beginnen)
+            float tolerance = getRealignTolerance() + EXPLORER_REALIGN_TOLERANCE_STEP;
+            if(tolerance > EXPLORER_REALIGN_TOLERANCE_MAX + EXPLORER_REALIGN_TOLERANCE_STEP / 2){
+                tolerance = EXPLORER_REALIGN_TOLERANCE_STEP;
+            }
+            setRealignTolerance(tolerance);
+            communication_log_P(LEVEL_INFO, PSTR("realignTolerance: %.3f rad"), tolerance);
+            params_save();
+            break;
+        }
+        case 57: { // command ID 57: Abstand des Flugschreibers verdoppeln (nach TRACE_INTERVAL_MAX wieder CONTROL_INTERVAL)
+            uint16_t interval = trace_getInterval() * 2;
+            if(interval > TRACE_INTERVAL_MAX){
+                interval = CONTROL_INTERVAL;
+            }
+            trace_setInterval(interval);
+            communication_log_P(LEVEL_INFO, PSTR("trace interval: %u ms, %u ms Aufzeichnung"), interval, interval * TRACE_SAMPLES);
+            break;
+        }
     }
 }
 
@@ -204,11 +311,14 @@ void commParameters(const uint8_t* packet, __attribute__((unused)) const uint16_
     RobotParameters_t* cmd = (RobotParameters_t*) packet;
     communication_log_P(LEVEL_INFO, PSTR("Parameters"));
 
+    control_lock();
     achsenlaenge = cmd->axleWidth;
     correctionValue = cmd->user1;
     tolerance_fixedValue = cmd->user2;
+    control_unlock();
 
     communication_log_P(LEVEL_INFO, PSTR("achsenlaenge: %.3f, correctionValue: %.3f, tolerance_fixedValue: %.3f"), achsenlaenge, correctionValue, tolerance_fixedValue);
+    params_save();
 }
 
 // callback function for adding tasks to the queue
@@ -228,10 +338,22 @@ void commTweak(const uint8_t* packet, __attribute__((unused)) const uint16_t siz
     setToleranceValues(tolerance_fixedValue, tolerance_theta, correctionValue);
     setBreakTime((uint16_t)breakTime*100);
 
+    control_lock();
     korrekturLinkesRad = 1.0f - (float)korrLinks/100.0f;
     korrekturRechtesRad = 1.0f - (float)korrRechts/100.0f;
+    control_unlock();
 
     communication_log_P(LEVEL_INFO, PSTR("korrekturLinkesRad: %i, korrekturRechtesRad: %i"), (int)(korrekturLinkesRad*100), (int)(korrekturRechtesRad*100));
+    params_save();
+}
+
+// callback function for changing the output rates of channels (CH_IN_RATE_CONFIG)
+void commRateConfig(const uint8_t* packet, const uint16_t size) {
+    const RateConfig_t* cfg = (const RateConfig_t*) packet;
+    for (uint16_t i = 0; i < size / sizeof(RateConfig_t); i++) {
+        communication_setRate(cfg[i].channel & 0x0F, cfg[i].interval, cfg[i].enabled);
+        communication_log_P(LEVEL_INFO, PSTR("channel %u: interval %u ms, enabled %u"), cfg[i].channel & 0x0F, cfg[i].interval, cfg[i].enabled);
+    }
 }
 
 void sendPathFollowerStatus(const PathFollowerStatus_t* pathFollower_status) {
@@ -21,6 +21,8 @@ void commParameters(const uint8_t* a, __attribute__((unused)) const uint16_t b);
 
 void commTweak(const uint8_t* a, __attribute__((unused)) const uint16_t b);
 
+void commRateConfig(const uint8_t* a, const uint16_t b);
+
 void sendPathFollowerStatus(const PathFollowerStatus_t* pathFollower_status);
 
 #endif /* CHANNELS_H */
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "control.h"
+#include "driving.h"
+#include "speedControl.h"
+#include "../pose/pose.h"
+#include "../path/path.h"
+#include "../sensors/sensors.h"
+#include "../tasks/taskManagement.h"
+#include "../telemetry/record.h"
+#include "../telemetry/trace.h"
+
+#include <stddef.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <tools/timeTask/timeTask.h>
+
+
+static ControlStats_t stats;
+
+// Eingaben des laufenden bzw. letzten Schritts
+static ControlInputs_t inputs;
+static bool control_started = 0;
+static bool stepping = 0;
+
+// Abschnitte der Hauptschleife (wird in der ISR gelesen, nur bei gesperrtem Timer 1 geändert)
+static volatile uint16_t sections = 0;
+static uint8_t lockDepth = 0;
+static void (*sectionHook)(uint16_t section) = NULL;
+
+
+void control_init() {
+    //Power Reduction für Timer 1 aufheben (Timer 3 und 4: PWM der Motoren, Timer 5: timeTask und ADC)
+    PRR0 &= ~_BV(PRTIM1);
+
+    TCCR1B = 0x00; //Timer anhalten
+    TCCR1A = 0x00; //keine Ausgänge
+    TCCR1C = 0x00;
+    TCNT1 = 0;
+    OCR1A = CONTROL_TIMER_TOP;
+    sections = 0;
+    lockDepth = 0;
+    TIMSK1 = _BV(OCIE1A);
+    TCCR1B = _BV(WGM12) | _BV(CS11); //CTC (TOP = OCR3A), Prescaler 8 => 1MHz, Timer starten
+}
+
+ISR(TIMER1_COMPA_vect) {
+    //nur Timer 1 sperren, UART, Encoder und Uptime laufen während des Schritts weiter
+    TIMSK1 &= ~_BV(OCIE1A);
+    sei();
+
+    ControlInputs_t sample;
+    sample.section = sections;
+    sample.uptime = timeTask_getUptime();
+    getEncoderTotals(&sample.encoder1Total, &sample.encoder2Total);
+    record_controlStep(&sample);
+
+    control_step(&sample);
+
+    //Timer läuft mit 1MHz ab dem Compare: Zählerstand = Dauer in µs (bzw. ein Intervall mehr, falls schon wieder fällig)
+    uint16_t duration = TCNT1;
+    if(TIFR1 & _BV(OCF1A)){
+        duration += CONTROL_TIMER_TOP + 1;
+    }
+    if(duration > stats.maxDuration){
+        stats.maxDuration = duration;
+    }
+
+    cli();
+    TIMSK1 |= _BV(OCIE1A);
+}
+
+void control_step(const ControlInputs_t* next) {
+    stepping = 1;
+
+    uint16_t period = next->uptime - inputs.uptime;
+    int16_t tics1 = 0;
+    int16_t tics2 = 0;
+    if(control_started){
+        if(period > stats.maxPeriod){
+            stats.maxPeriod = period;
+        }
+        if(period > CONTROL_OVERRUN && stats.overruns < UINT16_MAX){
+            stats.overruns++;
+        }
+        //Differenzen über Überlauf hinweg korrekt
+        tics1 = next->encoder1Total - inputs.encoder1Total;
+        tics2 = next->encoder2Total - inputs.encoder2Total;
+    }
+    if(stats.steps < UINT16_MAX){
+        stats.steps++;
+    }
+    inputs = *next;
+    control_started = 1;
+
+    //Odometrie
+    poseUpdate(tics1, tics2);
+
+    //Abbruchbedingungen der Tasks (und Geschwindigkeitsprofil)
+    check_conditionalAbort();
+
+    //Zum Ausgleichen der Räder
+    checkBalancing();
+    checkPath();
+
+    //Geschwindigkeitsregelung der Räder
+    checkSpeedControl();
+
+    //Flugschreiber (mit den PWM-Werten dieses Schritts)
+    trace_sample();
+
+    stepping = 0;
+}
+
+const ControlInputs_t* control_getInputs() {
+    return &inputs;
+}
+
+bool control_isStepping() {
+    return stepping;
+}
+
+void control_lock() {
+    if(stepping){
+        return;
+    }
+    if(lockDepth++ == 0){
+        TIMSK1 &= ~_BV(OCIE1A);
+        if(sectionHook){
+            sectionHook(sections);
+        }
+        sections++;
+    }
+}
+
+void control_unlock() {
+    if(stepping){
+        return;
+    }
+    if(--lockDepth == 0){
+        TIMSK1 |= _BV(OCIE1A);
+    }
+}
+
+void control_setSectionHook(void (*hook)(uint16_t section)) {
+    sectionHook = hook;
+}
+
+void control_getStats(ControlStats_t* copy) {
+    control_lock();
+    *copy = stats;
+    control_unlock();
+}
+
+void control_resetStats() {
+    control_lock();
+    stats = (ControlStats_t) { 0 };
+    control_unlock();
+}
@@ -0,0 +1,157 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//******************//
+/*
+Aufgabe:
+Regelungsebene: alles, was für das Fahren zeitkritisch ist, läuft im Compare-Interrupt von Timer 1 mit fester Rate
+(CONTROL_INTERVAL) und in fester Reihenfolge, getrennt von der Planung, der Kommunikation und dem Logging der
+Hauptschleife:
+1. Odometrie (poseUpdate())
+2. Abbruchbedingungen der Tasks und Geschwindigkeitsprofil (check_conditionalAbort())
+3. Balancing und Pfadverfolgung (checkBalancing(), checkPath())
+4. Geschwindigkeitsregelung der Räder (checkSpeedControl())
+5. Flugschreiber (trace_sample())
+Der Zeitpunkt der Regelschritte hängt damit nicht mehr von der Dauer eines Durchlaufs der Hauptschleife ab (z.B. durch
+Logging). Die ISR tastet die Eingaben des Schritts selbst ab (ControlInputs_t: Uptime und Encoder), die Stufen arbeiten
+nur mit diesen. Die Interrupts bleiben während des Schritts freigegeben (UART, Encoder, Uptime), nur Timer 1 selbst ist
+gesperrt: ein verspäteter Schritt wird direkt danach nachgeholt, nie verschachtelt.
+Timer 1 ist der einzige freie 16-Bit-Timer: Timer 3 und 4 erzeugen die PWM der Motoren (lib/motor), Timer 5 treibt
+timeTask und den ADC.
+
+Die Stufen loggen nicht und senden nichts: Ereignisse (z.B. Abbruchbedingung erfüllt) setzen Flags, die die Hauptschleife
+auswertet und loggt (manageTasks()). Auch Taskwechsel (Queue, malloc/free) passieren nur in der Hauptschleife.
+
+Gemeinsamer Zustand: die Hauptschleife greift auf den Zustand der Regelungsebene (Fahrbefehle, Abbruchbedingungen,
+Geschwindigkeitsregelung, Lookahead-Punkt der Pfadverfolgung, Parameter der Odometrie) nur zwischen control_lock() und control_unlock() zu, der Schritt
+wartet solange. Die Pose liest sie aus der Kopie vom Anfang des Durchlaufs (pose_latch(), getPose()). Die Abschnitte
+werden gezählt: die Aufzeichnung (telemetry/record.h) speichert mit den Eingaben jedes Schritts die Anzahl der bis dahin
+begonnenen Abschnitte, tools/replay führt den Schritt an derselben Stelle aus (control_setSectionHook()).
+
+Gemessen werden der größte Abstand zwischen zwei Regelschritten, die Überläufe (Abstand größer als CONTROL_OVERRUN ms,
+z.B. durch einen langen Abschnitt der Hauptschleife) und die längste Dauer eines Schritts.
+
+Bietet folgende Funktionalitäten an:
+- control_init(): Startet Timer 1 und damit die Regelungsebene
+- control_step(): Ein Regelschritt mit den gegebenen Eingaben (ISR, tools/replay)
+- control_getInputs(): Eingaben des laufenden Schritts (für die Stufen)
+- control_isStepping(): Läuft gerade ein Regelschritt?
+- control_lock() / control_unlock(): Abschnitt der Hauptschleife mit Zugriff auf den Zustand der Regelungsebene
+- control_getStats() / control_resetStats(): Zeitverhalten der Regelungsebene (User Command 53)
+
+ Wie verwenden?
+ - control_init() am Ende von robot_setup() aufrufen (nach den Tests, die Abschnitte werden ab hier gezählt)
+ - die Stufen nicht zusätzlich in der Hauptschleife aufrufen, in den Stufen nicht loggen und keine Pakete senden
+ - in den Stufen CONTROLTASK statt TIMETASK verwenden (Uptime des Schritts statt der Hauptschleife)
+ - Änderungen der Hauptschleife am Zustand der Regelungsebene kurz halten und in control_lock()/control_unlock()
+   einschließen (ohne Logging dazwischen), Abschnitte dürfen verschachtelt werden
+*/
+//******************//
+
+/**
+ * Abstand der Regelschritte in ms (500Hz)
+*/
+#define CONTROL_INTERVAL 2
+
+/**
+ * Compare-Wert von Timer 1 für CONTROL_INTERVAL (8MHz / Prescaler 8 => 1MHz)
+*/
+#define CONTROL_TIMER_TOP (CONTROL_INTERVAL * 1000 - 1)
+
+/**
+ * Ab diesem Abstand zweier Regelschritte (ms) zählt ein Überlauf (Uptime in ms, daher etwas Spielraum)
+*/
+#define CONTROL_OVERRUN 4
+
+/**
+ * Ausführung des Blocks mit einem Mindestabstand von interval_ms, wie TIMETASK, aber mit der Uptime des Regelschritts.
+ * Nur in den Stufen der Regelungsebene verwenden.
+*/
+#define CONTROLTASK(name, interval_ms)                                   \
+    static uint16_t name = 0;                                            \
+    uint16_t ct_uptime_##name = control_getInputs()->uptime;             \
+    bool ct_ex_##name = 0;                                               \
+    if ((uint16_t)(ct_uptime_##name - name) >= (uint16_t)(interval_ms)) { \
+        name = ct_uptime_##name;                                         \
+        ct_ex_##name = 1;                                                \
+    }                                                                    \
+    if (ct_ex_##name)
+
+/**
+ * Eingaben eines Regelschritts, von der ISR abgetastet
+*/
+typedef struct {
+    uint16_t section;       // Anzahl der bis dahin begonnenen Abschnitte der Hauptschleife (control_lock())
+    uint16_t uptime;        // Uptime in ms
+    int16_t encoder1Total;  // Zählerstände der Encoder-ISRs (laufen über), encoder1: rechtes Rad
+    int16_t encoder2Total;
+} ControlInputs_t;
+
+/**
+ * Zeitverhalten der Regelungsebene
+*/
+typedef struct {
+    uint16_t steps;       // Regelschritte
+    uint16_t overruns;    // Abstände größer als CONTROL_OVERRUN
+    uint16_t maxPeriod;   // größter Abstand zweier Regelschritte in ms
+    uint16_t maxDuration; // längste Dauer vom Compare-Interrupt bis zum Ende eines Schritts in µs
+} ControlStats_t;
+
+/**
+ * Startet Timer 1 (CTC, Compare-Interrupt alle CONTROL_INTERVAL ms) und setzt den Zähler der Abschnitte zurück
+*/
+void control_init();
+
+/**
+ * Führt einen Regelschritt aus (alle Stufen in fester Reihenfolge)
+ *
+ * @param inputs Eingaben des Schritts
+*/
+void control_step(const ControlInputs_t* inputs);
+
+/**
+ * @returns Eingaben des laufenden bzw. letzten Regelschritts
+*/
+const ControlInputs_t* control_getInputs();
+
+/**
+ * @returns true, solange ein Regelschritt läuft (Aufruf aus einer Stufe)
+*/
+bool control_isStepping();
+
+/**
+ * Beginnt einen Abschnitt der Hauptschleife: bis zum zugehörigen control_unlock() läuft kein Regelschritt.
+ * Aus einer Stufe aufgerufen (Funktionen, die beide Ebenen verwenden) passiert nichts.
+*/
+void control_lock();
+
+/**
+ * Beendet einen Abschnitt, ein inzwischen fälliger Regelschritt läuft danach sofort
+*/
+void control_unlock();
+
+/**
+ * Setzt eine Funktion, die zu Beginn jedes (äußersten) Abschnitts mit dessen Nummer aufgerufen wird. Nur für
+ * tools/replay: führt dort die aufgezeichneten Regelschritte vor dem Abschnitt aus, in dem sie auf dem Roboter
+ * gelaufen sind.
+ *
+ * @param hook Funktion, NULL zum Entfernen
+*/
+void control_setSectionHook(void (*hook)(uint16_t section));
+
+/**
+ * Kopiert das Zeitverhalten seit dem letzten control_resetStats()
+ *
+ * @param stats Ziel
+*/
+void control_getStats(ControlStats_t* stats);
+
+/**
+ * Setzt das Zeitverhalten zurück
+*/
+void control_resetStats();
+
+#endif
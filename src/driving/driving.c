@@ -8,9 +8,12 @@
 #include <math.h>
 
 #include "driving.h"
+#include "speedControl.h"
+#include "control.h"
 #include "../pose/pose.h"
 #include "../explorer/robot.h"
 #include "../helper/mathHelper.h"
+#include "../sensors/sensors.h"
 #include "main.h"
 
 
@@ -20,6 +23,14 @@
 int speed_Left = 0;
 int speed_Right = 0;
 
+// zuletzt an die Motoren übergebene PWM-Werte
+static int16_t pwm_Left = 0;
+static int16_t pwm_Right = 0;
+
+// momentane Korrektur durch das Balancing (Faktoren auf speed_Left/speed_Right)
+static float correction_Left = 1.0f;
+static float correction_Right = 1.0f;
+
 // Balancing
 static float tolerance_theta = M_PI_2/45.0f; //Grad 2 Toleranz
 
@@ -29,25 +40,75 @@ static Direction_t balancing_direction = DIRECTION_NORTH;
 static float balancing_fixedValue = 0;
 static float balancing_fixedTheta = 0.0;
 
+// letzte Entscheidung des Balancings (für logBalancingState(), in der Regelungsebene wird nicht geloggt)
+static float balancing_coordinate = 0;
+static bool balancing_inside = 0;   // innerhalb von tolerance_fixedValue: Ausrichtung (theta) wird ausgeglichen
+static int8_t balancing_side = 0;   // -1: mehr nach links, 1: mehr nach rechts, 0: keine Korrektur
+
 
 void setToleranceValues(uint16_t tol_fixedValue, uint16_t tol_theta, uint16_t corrValue){
+    control_lock();
     tolerance_fixedValue = (float)tol_fixedValue;
     tolerance_theta = M_PI_2/(90.0f/((float)tol_theta));
     correctionValue = 1.0f + (float)corrValue/100.0f;
+    control_unlock();
     communication_log_P(LEVEL_INFO, PSTR("tolerance_fixedValue: %i, tolerance_theta: %i, correctionValue: %i"), (int)tolerance_fixedValue, (int)(tolerance_theta*100), (int)(correctionValue*100));
 }
 
+float getToleranceTheta(){
+    return tolerance_theta;
+}
+
+void setToleranceTheta(float tol_theta){
+    control_lock();
+    tolerance_theta = tol_theta;
+    control_unlock();
+}
+
 void setMotorSpeed(int speedLeft, int speedRight) {
     //if(logBalancing) communication_log_P(LEVEL_INFO, PSTR("left: %i, right: %i", speedLeft, speedRight);
-    Motor_setPWM(-speedLeft, -speedRight);
+    control_lock();
+    if(speedControl_isEnabled()){
+        speedControl_setTarget(speedLeft * SPEED_CONTROL_MM_S_PER_SPEED, speedRight * SPEED_CONTROL_MM_S_PER_SPEED);
+    } else {
+        setMotorPWM(speedLeft, speedRight);
+    }
+    control_unlock();
+}
+
+void setMotorPWM(int16_t pwmLeft, int16_t pwmRight) {
+    control_lock();
+    //Motoren sind umgekehrt eingebaut: negative PWM fährt vorwärts
+    pwm_Left = -pwmLeft;
+    pwm_Right = -pwmRight;
+    if(!isBumperStop()){ //Notstopp des Bumpers: Motoren bleiben aus, bis checkBumped() den Kontakt übernommen hat
+        Motor_setPWM(pwm_Left, pwm_Right);
+    }
+    control_unlock();
+}
+
+int16_t getPWM_left() {
+    control_lock();
+    int16_t pwm = pwm_Left;
+    control_unlock();
+    return pwm;
+}
+
+int16_t getPWM_right() {
+    control_lock();
+    int16_t pwm = pwm_Right;
+    control_unlock();
+    return pwm;
 }
 
 void startBalancing(Direction_t dir, float fixedValue){
     if(logBalancing) communication_log_P(LEVEL_INFO, PSTR("startBalancing with current Direction: %i"), dir);
 
+    control_lock();
     balancing_fixedValue = fixedValue;
     balancing_direction = dir;
     balancing_flag = 1;
+    control_unlock();
 }
 
 void stopBalancing(){
@@ -62,23 +123,48 @@ void stopBalancing(){
 */
 
 void initDrive(int speed, int steering){
+    control_lock();
     speed_Left = speed;
     speed_Right = speed - 2 * steering;
+    correction_Left = 1.0f;
+    correction_Right = 1.0f;
     setMotorSpeed(speed_Left, speed_Right);
+    control_unlock();
+}
+
+void setDriveSpeed(int speed){
+    control_lock();
+    int left = speed_Left < 0 ? -speed : speed;
+    int right = speed_Right < 0 ? -speed : speed;
+    //steht oder keine Änderung: nichts tun
+    if(!(speed_Left == 0 && speed_Right == 0) && !(left == speed_Left && right == speed_Right)){
+        speed_Left = left;
+        speed_Right = right;
+        setMotorSpeed(speed_Left * correction_Left, speed_Right * correction_Right);
+    }
+    control_unlock();
 }
 
 /**
  * Nur in Kombination mit stopBalancing() verwenden !!!!!!!!!!!!!!
 */
 void initDrive_withBalancing_withPars(Direction_t direction, int speed, int steering, float fixedValue, float fixedTheta) {
+    if(logBalancing && steering == 0) communication_log_P(LEVEL_INFO, PSTR("startBalancing with current Direction: %i"), direction);
+
+    control_lock();
     speed_Left = speed;
     speed_Right = speed - 2 * steering;
+    correction_Left = 1.0f;
+    correction_Right = 1.0f;
     if(speed_Left == speed_Right){
-        startBalancing(direction, fixedValue);
+        balancing_fixedValue = fixedValue;
+        balancing_direction = direction;
+        balancing_flag = 1;
     }
     setMotorSpeed(speed_Left, speed_Right);
 
     balancing_fixedTheta = fixedTheta;
+    control_unlock();
 }
 
 void initDrive_withBalancing(Direction_t currentDir, int speed, int steering){
@@ -102,34 +188,46 @@ void initDrive_withBalancing_withFixedValue(Direction_t currentDir, int speed, i
 }
 
 void stopDrive() {
+    control_lock();
     speed_Left = 0;
     speed_Right = 0;
     setMotorSpeed(speed_Left, speed_Right);
     stopBalancing();
+    control_unlock();
 }
 
 int getSpeed_left() {
-    return speed_Left;
+    control_lock();
+    int speed = speed_Left;
+    control_unlock();
+    return speed;
 }
 
 int getSpeed_right() {
-    return speed_Right;
+    control_lock();
+    int speed = speed_Right;
+    control_unlock();
+    return speed;
 }
 
-uint16_t balancingDebugCounter = 0;
-
 void correction_moreToLeft(float value){
-    if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("Correction more to left. Left: %i, Right: %i"), (uint16_t)speed_Left, (uint16_t)(speed_Right * correctionValue));
+    balancing_side = -1;
+    correction_Left = 1.0f;
+    correction_Right = value;
     setMotorSpeed(speed_Left, speed_Right * value);
 }
 
 void correction_moreToRight(float value){   
-    if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("Correction more to right. Left: %i, Right: %i"), (uint16_t)(speed_Left * correctionValue), (uint16_t)speed_Right);
+    balancing_side = 1;
+    correction_Left = value;
+    correction_Right = 1.0f;
     setMotorSpeed(speed_Left * value, speed_Right);
 }
 
 void correction_remove(){
-    if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("Correction remove"));
+    balancing_side = 0;
+    correction_Left = 1.0f;
+    correction_Right = 1.0f;
     setMotorSpeed(speed_Left, speed_Right);
 }
 
@@ -137,36 +235,22 @@ void correction_remove(){
 
 
 void balance_coordinates(Direction_t dir, float coordinateToCheck){
-    float leftBorder = balancing_fixedValue - tolerance_fixedValue;
     float rightBorder = balancing_fixedValue + tolerance_fixedValue;
 
-
-    char *dirCoordinateString;
-    if(dir == DIRECTION_NORTH || dir == DIRECTION_SOUTH){
-        dirCoordinateString = "x";
-    } else {
-        dirCoordinateString = "y";
-    }
-
-    if(logBalancing && balancingDebugCounter % 20 == 0) communication_log_P(LEVEL_INFO, PSTR("balance_coordinates - direction: %s, coordinateToCheck: %i, fixedValue: %i, left border: %i, right border: %i. coordinateToCheck>rightBorder: %i"), cardStr(dir), (int)coordinateToCheck, (int)balancing_fixedValue, (int)leftBorder, (int)rightBorder, (int)((int)coordinateToCheck>(int)rightBorder));
     switch(dir) {
         case DIRECTION_NORTH:
         case DIRECTION_WEST:
             if(((int)coordinateToCheck) > ((int)rightBorder)) {
-                if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("%s zu groß => More to left. coordinateToCheck: %i, rightBorder: %i"), dirCoordinateString, (int)coordinateToCheck, (int)rightBorder);
                 correction_moreToLeft(((correctionValue - 1.0f)/2) + 1.0f);
             } else {
-                if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("%s zu klein => More to right. coordinateToCheck: %i, leftBorder: %i"), dirCoordinateString, (int)coordinateToCheck, (int)leftBorder);
                 correction_moreToRight(((correctionValue - 1.0f)/2) + 1.0f);
             }
             break;
         case DIRECTION_EAST:
         case DIRECTION_SOUTH:
             if(((int)coordinateToCheck) > ((int)rightBorder)) {
-                if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("%s zu groß => More to right. coordinateToCheck: %i, leftBorder: %i"), dirCoordinateString, (int)coordinateToCheck, (int)leftBorder);
                 correction_moreToRight(((correctionValue - 1.0f)/2) + 1.0f);
             } else {
-                if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("%s zu klein => More to left. coordinateToCheck: %i, rightBorder: %i"), dirCoordinateString, (int)coordinateToCheck, (int)rightBorder);
                 correction_moreToLeft(((correctionValue - 1.0f)/2) + 1.0f);
             }
             break;
@@ -181,39 +265,27 @@ void balance_theta(){
     float leftBorder = targetTheta - tolerance_theta;
     float rightBorder = targetTheta + tolerance_theta;
 
-    if(logBalancing && balancingDebugCounter % 20 == 0) communication_log_P(LEVEL_INFO, PSTR("Theta: %i, balancing_fixedTheta: %i, left border: %i, right border: %i"), (int)(getPose()->theta*100), (int)(balancing_fixedTheta*100), (int)(leftBorder)*100, (int)(rightBorder)*100);
     if(checkAngle_lower(currentTheta, leftBorder)){
-        if(logBalancing && balancingDebugCounter % 20 == 0) communication_log_P(LEVEL_INFO, PSTR("Theta zu klein"));
-
         correction_moreToRight(correctionValue);
     } else if(checkAngle_greater(currentTheta, rightBorder)) {
-        if(logBalancing && balancingDebugCounter % 20 == 0) communication_log_P(LEVEL_INFO, PSTR("Theta zu groß"));
-
         correction_moreToLeft(correctionValue);
     } else {
-        if(logBalancing && balancingDebugCounter % 20 == 0) communication_log_P(LEVEL_INFO, PSTR("Theta in Toleranz"));
-
         correction_remove();
     }
 }
 
 void balance_switch(Direction_t dir, float coordinateToCheck){
-    if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("balance_switch - coordinateToCheck: %i, fixedValue: %i, left border: %i, right border: %i"), (int)coordinateToCheck, (int)balancing_fixedValue, (int)(balancing_fixedValue-tolerance_fixedValue), (int)(balancing_fixedValue+tolerance_fixedValue));
-        
-    if(coordinateToCheck >= balancing_fixedValue - tolerance_fixedValue && coordinateToCheck <= balancing_fixedValue + tolerance_fixedValue){
-        if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("Balancing in direction %s inside tolerance_fixedValue"), cardStr(dir));
+    balancing_coordinate = coordinateToCheck;
+    balancing_inside = coordinateToCheck >= balancing_fixedValue - tolerance_fixedValue && coordinateToCheck <= balancing_fixedValue + tolerance_fixedValue;
+    if(balancing_inside){
         balance_theta();
-    } else if(coordinateToCheck > balancing_fixedValue + tolerance_fixedValue || coordinateToCheck < balancing_fixedValue - tolerance_fixedValue) {
-        if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("Balancing in direction %s outside tolerance_fixedValue"), cardStr(dir));
-        balance_coordinates(dir, coordinateToCheck);
     } else {
-        if(logBalancing && balancingDebugCounter % 50 == 0) communication_log_P(LEVEL_INFO, PSTR("Balancing in direction %s no balancing"), cardStr(dir));
+        balance_coordinates(dir, coordinateToCheck);
     }
 }
 
 void checkBalancing(){
-    TIMETASK(BALANCE_TASK, 50) {
-        balancingDebugCounter++;
+    CONTROLTASK(BALANCE_TASK, 50) {
         if(balancing_flag == 1) {
             switch(balancing_direction){
                 case DIRECTION_NORTH: // x konstant
@@ -227,4 +299,25 @@ void checkBalancing(){
             }
         }
     }
-}
\ No newline at end of file
+}
+
+void logBalancingState(){
+    control_lock();
+    bool active = balancing_flag;
+    Direction_t dir = balancing_direction;
+    float coordinate = balancing_coordinate;
+    float fixedValue = balancing_fixedValue;
+    float fixedTheta = balancing_fixedTheta;
+    bool inside = balancing_inside;
+    int8_t side = balancing_side;
+    control_unlock();
+
+    if(!active){
+        return;
+    }
+    const char* dirCoordinateString = (dir == DIRECTION_NORTH || dir == DIRECTION_SOUTH) ? "x" : "y";
+    communication_log_P(LEVEL_INFO, PSTR("Balancing %s: %s %i, fixedValue %i (+-%i), %s, Theta %i, fixedTheta %i, Korrektur %s"),
+        cardStr(dir), dirCoordinateString, (int)coordinate, (int)fixedValue, (int)tolerance_fixedValue,
+        inside ? "innerhalb" : "außerhalb", (int)(getPose()->theta*100), (int)(fixedTheta*100),
+        side < 0 ? "mehr nach links" : (side > 0 ? "mehr nach rechts" : "keine"));
+}
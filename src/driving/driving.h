@@ -11,15 +11,20 @@ Kümmert sich um die Ansteuerung des Roboters. Bietet hierfür Schnittstellen an
 Bietet folgende Funktionalitäten an:
 - initDrive(): Gibt dem Roboter einen Fahrauftrag 
 - initDrive_withBalancing_withPars(): Gibt dem Roboter einen Fahrauftrag, welcher Ungleichheiten in den Rädern ausgleichen soll (funktioniert bis jetzt nur beim Vorwärts- & Rückwärtsfahren)
+- setDriveSpeed(): Ändert die Geschwindigkeit des laufenden Fahrauftrags (z.B. für das Geschwindigkeitsprofil der Tasks)
 - getSpeedA(): Gibt Momentangeschwindigkeit des linken Rads zurück
 - getSpeedB(): Gibt Momentangeschwindigkeit des rechten Rads zurück
+- setMotorPWM(): Gibt die PWM direkt vor (ohne Geschwindigkeitsregelung)
+- getPWM_left()/getPWM_right(): Gibt die zuletzt an die Motoren übergebenen PWM-Werte zurück
 - stopDrive(): Lässt den Roboter anhalten
 - stopBalancing(): Stoppt das Ausgleichen des Roboters 
+- checkBalancing(): Stufe der Regelungsebene (control.h), gleicht die Räder aus
+- logBalancingState(): Loggt die letzte Entscheidung des Balancings (Hauptschleife)
 
 
  Wie verwenden?
- - 
- - 
+ - die Fahrbefehle aus der Hauptschleife sperren die Regelungsebene selbst (control_lock())
+ - checkBalancing() loggt nicht, stattdessen logBalancingState() in der Hauptschleife aufrufen (logBalancing)
 */
 //******************//
 
@@ -34,6 +39,18 @@ void initDrive(int speed, int steering);
 
 void setToleranceValues(uint16_t tol_fixedValue, uint16_t tol_theta, uint16_t correctionValue);
 
+/**
+ * @returns Toleranz der Ausrichtung beim Balancing in rad
+*/
+float getToleranceTheta();
+
+/**
+ * Setzt die Toleranz der Ausrichtung beim Balancing
+ *
+ * @param tol_theta: Toleranz in rad
+*/
+void setToleranceTheta(float tol_theta);
+
 /**
  * Lässt den Roboter fahren mit integriertem Ausgleichen von Ungleichheiten in den Rädern.
  * Kümmert sich um die Einzelheiten des Ausgleichens.
@@ -49,6 +66,14 @@ void initDrive_withBalancing(Direction_t currentDir, int speed, int steering);
 
 void initDrive_withBalancing_withFixedValue(Direction_t currentDir, int speed, int steering, float fixedValue);
 
+/**
+ * Ändert den Betrag der Geschwindigkeit beider Räder, Richtung der Räder und Korrektur des Balancings bleiben erhalten.
+ * Steht der Roboter, passiert nichts.
+ *
+ * @param speed: neuer Betrag der Geschwindigkeit (nur für Fahrten geradeaus bzw. Drehungen auf der Stelle)
+*/
+void setDriveSpeed(int speed);
+
 /**
  * @returns Geschwindigkeit des linken Rads
 */
@@ -59,6 +84,33 @@ int getSpeed_left();
 */
 int getSpeed_right();
 
+/**
+ * Setzt die Geschwindigkeiten beider Räder direkt, ohne Ausgleichen.
+ * Mit Geschwindigkeitsregelung (speedControl.h) sind das Sollgeschwindigkeiten (3000 => 150mm/s), sonst PWM-Werte.
+ *
+ * @param speedLeft: Geschwindigkeit des linken Rads
+ * @param speedRight: Geschwindigkeit des rechten Rads
+*/
+void setMotorSpeed(int speedLeft, int speedRight);
+
+/**
+ * Gibt die PWM beider Motoren direkt vor (von der Geschwindigkeitsregelung verwendet)
+ *
+ * @param pwmLeft: PWM des linken Motors (positiv: vorwärts)
+ * @param pwmRight: PWM des rechten Motors (positiv: vorwärts)
+*/
+void setMotorPWM(int16_t pwmLeft, int16_t pwmRight);
+
+/**
+ * @returns zuletzt an den linken Motor übergebener PWM-Wert
+*/
+int16_t getPWM_left();
+
+/**
+ * @returns zuletzt an den rechten Motor übergebener PWM-Wert
+*/
+int16_t getPWM_right();
+
 /**
  * Lässt den Roboter anhalten
 */
@@ -70,8 +122,13 @@ void stopDrive();
 void stopBalancing();
 
 /**
- * Kümmert sich um den TIMETASK, welcher das Balancing ausführt
+ * Stufe der Regelungsebene: führt alle 50ms das Balancing aus (ohne Logging)
 */
 void checkBalancing();
 
+/**
+ * Loggt Koordinate, Ausrichtung und die letzte Korrektur des laufenden Balancings (Hauptschleife)
+*/
+void logBalancingState();
+
 #endif
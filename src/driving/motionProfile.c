@@ -0,0 +1,42 @@
+#include "motionProfile.h"
+
+#include <math.h>
+
+
+void motionProfile_start(MotionProfile_t* profile, uint16_t uptime, uint16_t cruise, uint16_t initial, float decel) {
+    profile->cruise = cruise;
+    profile->initial = initial < PROFILE_MIN_SPEED ? PROFILE_MIN_SPEED : initial;
+    profile->decel = decel;
+    profile->startTime = uptime;
+    profile->accelerated = profile->initial >= cruise;
+}
+
+uint16_t motionProfile_getSpeed(MotionProfile_t* profile, uint16_t uptime, float remaining) {
+    float speed = profile->cruise;
+
+    // Beschleunigen (nach Erreichen der Reisegeschwindigkeit nicht mehr, damit der Überlauf der Uptime nicht stört)
+    if (!profile->accelerated) {
+        uint16_t elapsed = uptime - profile->startTime;
+        float ramp = profile->initial + (float)PROFILE_ACCEL * elapsed;
+        if (ramp >= profile->cruise) {
+            profile->accelerated = true;
+        } else {
+            speed = ramp;
+        }
+    }
+
+    // Bremsen
+    if (remaining < 0.0f) {
+        remaining = 0.0f;
+    }
+    float brake = sqrtf((float)PROFILE_MIN_SPEED * PROFILE_MIN_SPEED + 2.0f * profile->decel * remaining);
+    if (brake < speed) {
+        speed = brake;
+    }
+
+    // langsamer als PROFILE_MIN_SPEED nur, wenn die Reisegeschwindigkeit selbst kleiner ist
+    if (speed < PROFILE_MIN_SPEED) {
+        speed = profile->cruise < PROFILE_MIN_SPEED ? profile->cruise : PROFILE_MIN_SPEED;
+    }
+    return (uint16_t)speed;
+}
@@ -0,0 +1,75 @@
+#ifndef MOTION_PROFILE_H
+#define MOTION_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//******************//
+/*
+Aufgabe:
+Trapezförmiges Geschwindigkeitsprofil (Beschleunigen, Reisegeschwindigkeit, Bremsen) für Fahr- und Dreh-Tasks,
+statt sofort auf die volle PWM zu springen und am Ziel hart anzuhalten (Schlupf => Fehler in der Odometrie).
+- Beschleunigen: ab dem Start steigt die PWM um PROFILE_ACCEL pro ms
+- Bremsen: aus der verbleibenden Strecke (mm) bzw. dem verbleibenden Winkel (rad) mit konstanter Verzögerung
+  (v² = PROFILE_MIN_SPEED² + 2 * decel * Rest), am Ziel fährt der Roboter nur noch mit PROFILE_MIN_SPEED
+
+Bietet folgende Funktionalitäten an:
+- motionProfile_start(): Beginnt ein Profil (beim Start des Tasks)
+- motionProfile_getSpeed(): PWM laut Profil für die verbleibende Strecke bzw. den verbleibenden Winkel
+
+ Wie verwenden?
+ - wird von taskManagement.c für COORDINATES- und ANGLE-Tasks verwendet, die PWM wird in check_conditionalAbort()
+   über setDriveSpeed() nachgeführt
+ - die Uptime wird übergeben: gestartet wird in der Hauptschleife, nachgeführt in der Regelungsebene (driving/control.h)
+*/
+//******************//
+
+/**
+ * PWM beim Anfahren und am Ziel
+*/
+#define PROFILE_MIN_SPEED 600
+
+/**
+ * Beschleunigung: PWM pro ms (0 auf 3000 in ca. 300ms)
+*/
+#define PROFILE_ACCEL 8
+
+/**
+ * Verzögerung beim Fahren in PWM² pro mm (von 1500 auf PROFILE_MIN_SPEED in ca. 24mm)
+*/
+#define PROFILE_DECEL_DRIVE 40000.0f
+
+/**
+ * Verzögerung beim Drehen in PWM² pro rad (von 1500 auf PROFILE_MIN_SPEED in ca. 0,5rad)
+*/
+#define PROFILE_DECEL_ROTATE 2000000.0f
+
+typedef struct {
+    uint16_t cruise;    // Reisegeschwindigkeit (PWM)
+    uint16_t initial;   // PWM beim Start des Profils
+    float decel;        // Verzögerung (PWM² pro mm bzw. rad)
+    uint16_t startTime; // Uptime beim Start in ms
+    bool accelerated;   // Reisegeschwindigkeit schon einmal erreicht (Beschleunigen beendet)
+} MotionProfile_t;
+
+/**
+ * Beginnt ein Profil
+ *
+ * @param profile zu verwendendes Profil
+ * @param uptime Uptime in ms (Hauptschleife: timeTask_getTaskUptime())
+ * @param cruise Reisegeschwindigkeit (PWM)
+ * @param initial momentane PWM (0 bzw. kleiner PROFILE_MIN_SPEED: aus dem Stand), z.B. beim Überblenden
+ * @param decel Verzögerung (PROFILE_DECEL_DRIVE oder PROFILE_DECEL_ROTATE)
+*/
+void motionProfile_start(MotionProfile_t* profile, uint16_t uptime, uint16_t cruise, uint16_t initial, float decel);
+
+/**
+ * @param profile zu verwendendes Profil
+ * @param uptime Uptime in ms (Regelungsebene: Uptime des Schritts, control_getInputs())
+ * @param remaining verbleibende Strecke (mm) bzw. verbleibender Winkel (rad), INFINITY: nicht bremsen
+ *
+ * @returns PWM laut Profil
+*/
+uint16_t motionProfile_getSpeed(MotionProfile_t* profile, uint16_t uptime, float remaining);
+
+#endif
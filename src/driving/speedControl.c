@@ -0,0 +1,129 @@
+#include "speedControl.h"
+#include "driving.h"
+#include "control.h"
+#include "../pose/pose.h"
+
+#include <math.h>
+
+
+typedef struct {
+    float target;    // Sollgeschwindigkeit in mm/s
+    float velocity;  // zuletzt gemessene Geschwindigkeit in mm/s
+    float integral;  // Integralanteil (PWM)
+    int16_t pwm;     // zuletzt vorgegebene PWM (positiv: vorwärts)
+} WheelControl_t;
+
+static WheelControl_t wheel_Left;
+static WheelControl_t wheel_Right;
+
+static bool speedControl_enabled = 1;
+
+// Encoder-Zähler und Uptime der letzten Messung
+static int16_t speedControl_encoder1 = 0;
+static int16_t speedControl_encoder2 = 0;
+static uint16_t speedControl_time = 0;
+
+
+/**
+ * PWM aus Vorsteuerung, Proportional- und Integralanteil (begrenzt auf SPEED_CONTROL_PWM_MAX)
+*/
+static int16_t getOutput(WheelControl_t* wheel) {
+    float pwm = SPEED_CONTROL_FEEDFORWARD * wheel->target + SPEED_CONTROL_KP * (wheel->target - wheel->velocity) + wheel->integral;
+    if(pwm > SPEED_CONTROL_PWM_MAX){
+        return SPEED_CONTROL_PWM_MAX;
+    }
+    if(pwm < -SPEED_CONTROL_PWM_MAX){
+        return -SPEED_CONTROL_PWM_MAX;
+    }
+    return (int16_t)pwm;
+}
+
+static void setWheelTarget(WheelControl_t* wheel, float target) {
+    // bei Stillstand oder Richtungswechsel passt das Integral nicht mehr
+    if(target == 0.0f || (target > 0.0f) != (wheel->target > 0.0f)){
+        wheel->integral = 0.0f;
+    }
+    wheel->target = target;
+}
+
+/**
+ * Ein Regelschritt: Integral nachführen (nicht weiter in die Sättigung hinein) und neue PWM berechnen
+*/
+static void controlWheel(WheelControl_t* wheel, uint16_t dt) {
+    if(wheel->target == 0.0f){
+        wheel->pwm = 0;
+        return;
+    }
+    float error = wheel->target - wheel->velocity;
+    bool saturated = (wheel->pwm >= SPEED_CONTROL_PWM_MAX && error > 0.0f) || (wheel->pwm <= -SPEED_CONTROL_PWM_MAX && error < 0.0f);
+    if(!saturated){
+        wheel->integral += SPEED_CONTROL_KI * error * dt / 1000.0f;
+        if(wheel->integral > SPEED_CONTROL_INTEGRAL_MAX){
+            wheel->integral = SPEED_CONTROL_INTEGRAL_MAX;
+        } else if(wheel->integral < -SPEED_CONTROL_INTEGRAL_MAX){
+            wheel->integral = -SPEED_CONTROL_INTEGRAL_MAX;
+        }
+    }
+    wheel->pwm = getOutput(wheel);
+}
+
+
+void speedControl_setTarget(float left, float right) {
+    setWheelTarget(&wheel_Left, left);
+    setWheelTarget(&wheel_Right, right);
+
+    wheel_Left.pwm = left == 0.0f ? 0 : getOutput(&wheel_Left);
+    wheel_Right.pwm = right == 0.0f ? 0 : getOutput(&wheel_Right);
+    setMotorPWM(wheel_Left.pwm, wheel_Right.pwm);
+}
+
+void checkSpeedControl() {
+    CONTROLTASK(SPEED_TASK, SPEED_CONTROL_INTERVAL) {
+        const ControlInputs_t* inputs = control_getInputs();
+        uint16_t uptime = inputs->uptime;
+        uint16_t dt = uptime - speedControl_time;
+
+        if(dt > 0 && dt <= SPEED_CONTROL_TIMEOUT){
+            //encoder1: rechtes Rad, encoder2: linkes Rad, Differenzen über Überlauf hinweg korrekt
+            int16_t deltaRight = inputs->encoder1Total - speedControl_encoder1;
+            int16_t deltaLeft = inputs->encoder2Total - speedControl_encoder2;
+            wheel_Left.velocity = deltaLeft * pose_getMmPerTick_left() * 1000.0f / dt;
+            wheel_Right.velocity = deltaRight * pose_getMmPerTick_right() * 1000.0f / dt;
+
+            if(speedControl_enabled && (wheel_Left.target != 0.0f || wheel_Right.target != 0.0f)){
+                controlWheel(&wheel_Left, dt);
+                controlWheel(&wheel_Right, dt);
+                setMotorPWM(wheel_Left.pwm, wheel_Right.pwm);
+            }
+        }
+        speedControl_encoder1 = inputs->encoder1Total;
+        speedControl_encoder2 = inputs->encoder2Total;
+        speedControl_time = uptime;
+    }
+}
+
+float speedControl_getVelocity_left() {
+    control_lock();
+    float velocity = wheel_Left.velocity;
+    control_unlock();
+    return velocity;
+}
+
+float speedControl_getVelocity_right() {
+    control_lock();
+    float velocity = wheel_Right.velocity;
+    control_unlock();
+    return velocity;
+}
+
+void speedControl_setEnabled(bool enable) {
+    control_lock();
+    speedControl_enabled = enable;
+    wheel_Left = (WheelControl_t) { 0 };
+    wheel_Right = (WheelControl_t) { 0 };
+    control_unlock();
+}
+
+bool speedControl_isEnabled() {
+    return speedControl_enabled;
+}
@@ -0,0 +1,106 @@
+#ifndef SPEED_CONTROL_H
+#define SPEED_CONTROL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//******************//
+/*
+Aufgabe:
+Regelt die Geschwindigkeit beider Räder (PI-Regler je Rad), statt die PWM ungeregelt vorzugeben. Die PWM, die für eine
+bestimmte Geschwindigkeit nötig ist, hängt von der Akkuspannung und vom Rad ab (bisher von Hand über korrekturLinkesRad/
+korrekturRechtesRad ausgeglichen), der Regler gleicht das selbst aus.
+- Sollwerte in mm/s (positiv: vorwärts), die Geschwindigkeiten von setMotorSpeed() werden mit SPEED_CONTROL_MM_S_PER_SPEED
+  umgerechnet (3000 => 150mm/s), Balancing, Pfadverfolgung und Tasks geben damit Geschwindigkeiten statt PWM vor
+- Istwerte aus den Differenzen der eingelesenen Encoder-Zähler der Regelungsebene (control_getInputs()) alle SPEED_CONTROL_INTERVAL ms
+- PWM = SPEED_CONTROL_FEEDFORWARD * Soll + SPEED_CONTROL_KP * Fehler + Integral (Integral begrenzt, kein Aufintegrieren
+  bei voller PWM)
+- Sollwert 0 für beide Räder: Motoren sofort aus, Integral zurückgesetzt (Anhalten wie bisher)
+
+Bietet folgende Funktionalitäten an:
+- speedControl_setTarget(): Sollgeschwindigkeiten beider Räder, die PWM wird sofort angepasst
+- checkSpeedControl(): Misst die Geschwindigkeiten und führt die PWM nach (CONTROLTASK)
+- speedControl_getVelocity_left()/_right(): zuletzt gemessene Geschwindigkeiten
+- speedControl_setEnabled(): Regler ein-/ausschalten (aus: setMotorSpeed() gibt die PWM wie bisher direkt vor)
+
+ Wie verwenden?
+ - checkSpeedControl() wird von der Regelungsebene aufgerufen (driving/control.h)
+ - Fahraufträge weiterhin über driving.h (setMotorSpeed() usw.), speedControl_setTarget() wird von dort aufgerufen
+ - ein-/ausschalten mit User Command 52
+*/
+//******************//
+
+/**
+ * Abstand der Regelschritte in ms
+*/
+#define SPEED_CONTROL_INTERVAL 10
+
+/**
+ * Umrechnung der Geschwindigkeiten von setMotorSpeed() in mm/s (3000 => 150mm/s, entspricht der bisherigen PWM)
+*/
+#define SPEED_CONTROL_MM_S_PER_SPEED 0.05f
+
+/**
+ * Vorsteuerung: PWM pro mm/s (Kehrwert von SPEED_CONTROL_MM_S_PER_SPEED)
+*/
+#define SPEED_CONTROL_FEEDFORWARD 20.0f
+
+/**
+ * Proportionalanteil: PWM pro mm/s Regelabweichung
+*/
+#define SPEED_CONTROL_KP 8.0f
+
+/**
+ * Integralanteil: PWM pro mm Regelabweichung (mm/s über die Zeit in s)
+*/
+#define SPEED_CONTROL_KI 100.0f
+
+/**
+ * Betrag, auf den das Integral begrenzt wird (PWM)
+*/
+#define SPEED_CONTROL_INTEGRAL_MAX 2000.0f
+
+/**
+ * Größter Betrag der PWM (siehe Motor_setPWM())
+*/
+#define SPEED_CONTROL_PWM_MAX 8191
+
+/**
+ * Liegen zwei Regelschritte weiter auseinander (ms), wird nur neu gemessen (z.B. nach dem Einschalten)
+*/
+#define SPEED_CONTROL_TIMEOUT 100
+
+/**
+ * Setzt die Sollgeschwindigkeiten und passt die PWM sofort an
+ *
+ * @param left Sollgeschwindigkeit des linken Rads in mm/s (positiv: vorwärts)
+ * @param right Sollgeschwindigkeit des rechten Rads in mm/s
+*/
+void speedControl_setTarget(float left, float right);
+
+/**
+ * Misst die Geschwindigkeiten der Räder und führt die PWM nach (alle SPEED_CONTROL_INTERVAL ms)
+*/
+void checkSpeedControl();
+
+/**
+ * @returns zuletzt gemessene Geschwindigkeit des linken Rads in mm/s
+*/
+float speedControl_getVelocity_left();
+
+/**
+ * @returns zuletzt gemessene Geschwindigkeit des rechten Rads in mm/s
+*/
+float speedControl_getVelocity_right();
+
+/**
+ * Schaltet den Regler ein oder aus. Nur im Stillstand umschalten (vorher stopDrive()).
+*/
+void speedControl_setEnabled(bool enable);
+
+/**
+ * @returns true, falls die Geschwindigkeit geregelt wird
+*/
+bool speedControl_isEnabled();
+
+#endif
@@ -2,6 +2,11 @@
 #include "explorer.h"
 #include "labyrinthState.h"
 #include "main.h"
+#include "../tasks/taskManagement.h"
+#include "../pose/pose.h"
+#include "../helper/mathHelper.h"
+#include "../sensors/sensors.h"
+#include "../sensors/ISRCustom.h"
 
 #include <avr/pgmspace.h>
 #include <communication/communication.h>
@@ -108,6 +113,8 @@ void addVisited(RobotDirection_t direction){
 TileType_t lastTile;
 bool exploring = false;
 
+static void exploreStep();
+
 void startExploring(void) {
 	// Initialization
 	communication_log_P(LEVEL_INFO, PSTR("Exploration started"));
@@ -115,7 +122,7 @@ void startExploring(void) {
 	initLabyrinthState();
 	lastTile = PLATZ;
 	exploring = true;
-	
+	setTasksFinishedCallback(exploreStep);
 }
 
 bool isExploring() {
@@ -279,40 +286,148 @@ void move(){
 
 bool hasRotatedForward = 0;
 
-void explore(){
-	TIMETASK(EXPLORE_TASK, 500){
-		// robot_canContinue() needs to be called after every robot_move()
-		// in order to ensure breaking the loop when the robot exits the labyrinth,
-		// the maximum number of allowed moves is reached or some error occured
-		//if(exploring && (debugContinue || !logExplorer)){
-		if(exploring){
-			if(robot_tasksFinished()){
-				if(!hasRotatedForward){
-					if(logExplorer) communication_log_P(LEVEL_INFO, PSTR("Explorer:  tasksFinished == TRUE && hasRotatedForward == FALSE"));
-					robot_rotate(FORWARD);
-					start();
-					hasRotatedForward = 1;
-				} else {
-					hasRotatedForward = 0;
-					//if(logExplorer) communication_log_P(LEVEL_INFO, PSTR(Explorer:  tasksFinished == TRUE");
-
-					if(robot_canContinue()){ // Falls der Roboter nach jedem Move warten soll, bis manuell weitergemacht werden soll
-						if(logExplorer) communication_log_P(LEVEL_INFO, PSTR("Explorer:  canContinue == TRUE"));
-						if(logExplorer) debugContinue = 0;
-
-						if(logExplorer) communication_log_P(LEVEL_INFO, PSTR(""));
-						if(logExplorer) communication_log_P(LEVEL_INFO, PSTR(""));
-						move();
-					} else if(!robot_canContinue()){ 
-						if(logExplorer) communication_log_P(LEVEL_INFO, PSTR("Explorer:  canContinue == FALSE"));
-
-						exploring = false;
-						communication_log_P(LEVEL_INFO, PSTR("Exploration finished"));
-					}
-				}
+//Neuausrichtung (robot_rotate(FORWARD)) nur bei größerer Abweichung von der Kardinalrichtung
+static float realignTolerance = EXPLORER_REALIGN_TOLERANCE;
+static uint16_t realignCount = 0;
+static uint16_t realignSkipped = 0;
+
+void setRealignTolerance(float tolerance) {
+	realignTolerance = tolerance;
+}
+
+float getRealignTolerance() {
+	return realignTolerance;
+}
+
+uint16_t getRealignCount() {
+	return realignCount;
+}
+
+uint16_t getRealignSkipped() {
+	return realignSkipped;
+}
+
+/**
+ * Prüft, ob der Roboter vor dem nächsten Move neu ausgerichtet werden muss, und zählt mit
+*/
+static bool needsRealign() {
+	float headingError = robot_getHeadingError();
+	if(fabs(headingError) > realignTolerance){
+		realignCount++;
+		return 1;
+	}
+	if(logExplorer) communication_log_P(LEVEL_INFO, PSTR("Explorer:  Abweichung %.3f rad, keine Neuausrichtung"), headingError);
+	realignSkipped++;
+	return 0;
+}
+
+/**
+ * Ein Schritt der Explorierung: nächste Bewegung planen, sobald alle Tasks abgearbeitet sind.
+ * Wird vom Taskmanagement aufgerufen, sobald die Queue leer gelaufen ist (setTasksFinishedCallback()).
+*/
+static void exploreStep(){
+	// robot_canContinue() needs to be called after every robot_move()
+	// in order to ensure breaking the loop when the robot exits the labyrinth,
+	// the maximum number of allowed moves is reached or some error occured
+	//if(exploring && (debugContinue || !logExplorer)){
+	if(exploring){
+		if(robot_tasksFinished()){
+			if(!hasRotatedForward && needsRealign()){
+				if(logExplorer) communication_log_P(LEVEL_INFO, PSTR("Explorer:  tasksFinished == TRUE && hasRotatedForward == FALSE"));
+				robot_rotate(FORWARD);
+				start();
+				hasRotatedForward = 1;
 			} else {
-				//if(logExplorer) communication_log_P(LEVEL_INFO, PSTR(Explorer:  tasksFinished == FALSE");
+				hasRotatedForward = 0;
+				//if(logExplorer) communication_log_P(LEVEL_INFO, PSTR(Explorer:  tasksFinished == TRUE");
+
+				if(robot_canContinue()){ // Falls der Roboter nach jedem Move warten soll, bis manuell weitergemacht werden soll
+					if(logExplorer) communication_log_P(LEVEL_INFO, PSTR("Explorer:  canContinue == TRUE"));
+					if(logExplorer) debugContinue = 0;
+
+					if(logExplorer) communication_log_P(LEVEL_INFO, PSTR(""));
+					if(logExplorer) communication_log_P(LEVEL_INFO, PSTR(""));
+					move();
+				} else if(!robot_canContinue()){ 
+					if(logExplorer) communication_log_P(LEVEL_INFO, PSTR("Explorer:  canContinue == FALSE"));
+
+					exploring = false;
+					communication_log_P(LEVEL_INFO, PSTR("Exploration finished"));
+					communication_log_P(LEVEL_INFO, PSTR("Neuausrichtungen: %u, übersprungen: %u"), realignCount, realignSkipped);
+				}
 			}
+		} else {
+			//if(logExplorer) communication_log_P(LEVEL_INFO, PSTR(Explorer:  tasksFinished == FALSE");
 		}
 	}
+}
+
+void explorer_bumperContact(){
+	const BumperContact_t* contact = getBumperContact();
+	communication_log_P(LEVEL_WARNING, PSTR("Bumper: Kontakt (Uptime %u ms) bei x: %i, y: %i, theta: %.3f"), contact->time, (int)contact->pose.x, (int)contact->pose.y, contact->pose.theta);
+
+	abortTasks();
+	if(exploring){
+		//zurücksetzen, danach plant exploreStep() neu (mit Neuausrichtung, falls nötig)
+		enqueue_backOff(EXPLORER_BACKOFF_SPEED, EXPLORER_BACKOFF_DISTANCE);
+		hasRotatedForward = 0;
+		start();
+	}
+}
+
+/**
+ * Gang ohne Anhalten: kurz vor der Mitte der Zielkachel (EXPLORER_LOOKAHEAD_DISTANCE) liegen die Seitensensoren
+ * schon neben deren Wänden. Ist die Zielkachel ein Pfad (links und rechts Wand, vorne frei) und keine Randkachel,
+ * wird die nächste Kachel sofort eingereiht und vom Taskmanagement ohne Anhalten übernommen (Überblenden).
+ * Ansonsten hält der Roboter wie bisher an und move() plant im Stand.
+*/
+static void extendCorridor(){
+	static bool checked = 0; //Zielkachel der laufenden Fahrt schon geprüft
+	float remaining = getTileMoveRemaining();
+	if(remaining < 0 || remaining > EXPLORER_LOOKAHEAD_DISTANCE){
+		checked = 0;
+		return;
+	}
+	if(checked || !exploring || !isTaskBlending() || !isQueueEmpty()){
+		return;
+	}
+	checked = 1;
+
+	//Randkachel: evtl. Ausgang, darüber entscheidet move() im Stand
+	uint16_t row = robot_getRow();
+	uint16_t col = robot_getColumn();
+	if(row <= 1 || row >= LABYRINTH_ROWS || col <= 1 || col >= LABYRINTH_COLS){
+		return;
+	}
+	//die Wand vor der Zielkachel wäre noch um die verbleibende Strecke weiter entfernt als im Stand (isWall(FORWARD))
+	bool forwardOpen = convertInfraredToMM(getInfrared(2)) >= 120 + remaining;
+	if(!forwardOpen || robot_canMove(LEFT) || robot_canMove(RIGHT)){
+		return;
+	}
+	if(fabs(robot_getHeadingError()) > realignTolerance || !robot_canContinue()){
+		return;
+	}
+
+	uint16_t move = labyrinth_newMove();
+	if(logExplorer) communication_log_P(LEVEL_INFO, PSTR("Explorer:  Pfad, Move %i wird ohne Anhalten angehängt"), move);
+	lastTile = PFAD;
+	enqueue_moveForward_oneTile(1500, robot_getOrientation());
+}
+
+void explore(){
+	//nur beim Explorieren, sonst gehört CH_OUT_USER_DATA den anderen Sendern
+	if(exploring && communication_isChannelDue(CH_OUT_USER_DATA)){
+		UserData_t data = { 0 };
+		data.uint16 = realignCount;
+		data.uint32 = realignSkipped;
+		data.float1 = realignTolerance;
+		communication_writePacket(CH_OUT_USER_DATA, (uint8_t*)&data, sizeof(data));
+	}
+
+	extendCorridor();
+
+	//Fallback (z.B. direkt nach startExploring()), normalerweise übernimmt der Callback den nächsten Schritt
+	TIMETASK(EXPLORE_TASK, 500){
+		exploreStep();
+	}
 }
\ No newline at end of file
@@ -1,6 +1,37 @@
 #ifndef EXPLORER_H
 #define EXPLORER_H
 
+#include <stdint.h>
+
+/**
+ * Vor einem Move wird nur neu ausgerichtet (robot_rotate(FORWARD)), wenn theta um mehr als das (rad) von der
+ * Kardinalrichtung abweicht
+*/
+#define EXPLORER_REALIGN_TOLERANCE 0.035f
+
+/**
+ * User Command 56 erhöht die Toleranz der Neuausrichtung um diesen Schritt (rad), oberhalb von
+ * EXPLORER_REALIGN_TOLERANCE_MAX beginnt sie wieder bei EXPLORER_REALIGN_TOLERANCE_STEP
+*/
+#define EXPLORER_REALIGN_TOLERANCE_STEP 0.01f
+#define EXPLORER_REALIGN_TOLERANCE_MAX 0.08f
+
+/**
+ * So weit (mm) vor der Mitte der Zielkachel einer Fahrt wird geprüft, ob die Zielkachel ein Pfad ist, und dann die
+ * nächste Kachel ohne Anhalten angehängt (max. ca. 90 mm: Reichweite des vorderen Infrarotsensors)
+*/
+#define EXPLORER_LOOKAHEAD_DISTANCE 60.0f
+
+/**
+ * Nach einem Kontakt des Bumpers setzt der Roboter so weit zurück (mm), bevor neu geplant wird
+*/
+#define EXPLORER_BACKOFF_DISTANCE 40.0f
+
+/**
+ * Geschwindigkeit beim Zurücksetzen
+*/
+#define EXPLORER_BACKOFF_SPEED 1000
+
 /**
  * Beginnt die Explorierung des Labyrinths
 */
@@ -10,9 +41,41 @@ bool isExploring();
 
 void stopExploring();
 
+/**
+ * Setzt die Toleranz für die Neuausrichtung vor einem Move (Default EXPLORER_REALIGN_TOLERANCE, User Command 56,
+ * wird mit params_save() im EEPROM gespeichert)
+ *
+ * @param tolerance erlaubte Abweichung von der Kardinalrichtung in rad
+*/
+void setRealignTolerance(float tolerance);
+
+/**
+ * @returns Toleranz für die Neuausrichtung vor einem Move in rad
+*/
+float getRealignTolerance();
+
+/**
+ * @returns Anzahl der Neuausrichtungen vor einem Move
+*/
+uint16_t getRealignCount();
+
+/**
+ * @returns Anzahl der übersprungenen Neuausrichtungen (Abweichung innerhalb der Toleranz)
+*/
+uint16_t getRealignSkipped();
+
+
+/**
+ * Callback für Kontakte des Bumpers (setBumperCallback()): bricht alle Tasks ab und lässt den Roboter beim Explorieren
+ * zurücksetzen, danach wird mit der neuen Pose neu geplant
+*/
+void explorer_bumperContact();
 
 /**
- * Beinhaltet einen TIMETASK, welcher sich um die Explorierung des Labyrinths kümmert
+ * Beinhaltet einen TIMETASK, welcher sich um die Explorierung des Labyrinths kümmert. Hängt in einem Gang die nächste
+ * Kachel schon während der Fahrt an (EXPLORER_LOOKAHEAD_DISTANCE), damit der Gang ohne Anhalten durchfahren wird.
+ * Sendet beim Explorieren mit der Ausgaberate von CH_OUT_USER_DATA die Neuausrichtungen als UserData_t (uint16: Neuausrichtungen,
+ * uint32: übersprungene Neuausrichtungen, float1: Toleranz in rad)
 */
 void explore(void);
 
@@ -1,4 +1,5 @@
 #include "labyrinthState.h"
+#include "robot.h"
 
 #include "tools/labyrinth/labyrinth.h"
 
@@ -7,7 +7,9 @@
 
 #include "../pose/pose.h"
 #include "../tasks/taskManagement.h"
+#include "../helper/mathHelper.h"
 #include "labyrinthState.h"
+#include "explorer.h"
 #include "main.h"
 
 
@@ -170,7 +172,8 @@ bool robot_move(RobotDirection_t robotDirection) {
     if(robotDirection == BACKWARD) {
         robot_rotate(RIGHT);
         robot_rotate(BACKWARD);
-    } else {
+    } else if(robotDirection != FORWARD || fabs(robot_getHeadingError()) > getRealignTolerance()) {
+        //vorwärts nur bei größerer Abweichung neu ausrichten (wie die Neuausrichtung des Explorers)
         robot_rotate(robotDirection);
     }
 
@@ -182,6 +185,10 @@ bool robot_move(RobotDirection_t robotDirection) {
     return true;
 }
 
+float robot_getHeadingError() {
+    return angle_subtract(getPose()->theta, getAngle_forCardinalDirection(robot_getOrientation()));
+}
+
 void robot_rotate(RobotDirection_t robotDirection) {
     enqueue_rotateToCardinalDirection(1500, robot_orientationAfterRotation(robotDirection));
 }
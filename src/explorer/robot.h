@@ -64,7 +64,9 @@ int8_t robot_getExitDirection();
 
 /**
  * Moves in the given direction
- * If direction not FORWARD or BACKWARDS, rotates in the given Direction
+ * If direction not FORWARD or BACKWARDS, rotates in the given Direction.
+ * FORWARD only realigns to the current cardinal direction if the heading error exceeds the realign tolerance
+ * of the explorer (getRealignTolerance())
  * 
  * @param robotDirection Direction in which the robot should move (FORWARD, LEFT, BACKWARD, RIGHT)
  * 
@@ -72,6 +74,11 @@ int8_t robot_getExitDirection();
 */
 bool robot_move(RobotDirection_t robotDirection);
 
+/**
+ * @returns deviation of theta from the current cardinal direction in rad
+*/
+float robot_getHeadingError();
+
 /**
  * Rotates the robot in the given direction relative to the current orientation
  * 
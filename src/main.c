@@ -19,10 +19,19 @@
 #include "tasks/taskManagement.h"
 
 #include "driving/driving.h"
+#include "driving/control.h"
 #include "sensors/sensors.h"
 #include "channels/channels.h"
 #include "pose/pose.h"
+#include "pose/calibration.h"
+#include "params/params.h"
 #include "path/path.h"
+#include "telemetry/muxTelemetry.h"
+#include "telemetry/poseStream.h"
+#include "telemetry/trace.h"
+#include "telemetry/record.h"
+#include "telemetry/ping.h"
+#include "telemetry/commStats.h"
 #include "explorer/explorer.h"
 #include "tests/test.h"
 
@@ -133,7 +142,7 @@ float getCorrectionValue_rotate(uint8_t dir){
 
 
 // initialization
-static void init(void) {
+void robot_init(void) {
     powerSaver_init(); // must be the first call!
     LED_init();
     uart_init();
@@ -151,6 +160,19 @@ static void init(void) {
 	communication_setCallback(7, commTweak); //Zum Tasks hinzufügen
     communication_setCallback(CH_IN_POSE, poseUpdateAprilTag);
     communication_setCallback(CH_IN_ROBOT_PARAMS, commParameters);
+    communication_setCallback(CH_IN_POSE_STREAM_ACK, poseStreamAck);
+    communication_setCallback(CH_IN_RATE_CONFIG, commRateConfig);
+    communication_setCallback(CH_IN_PING, commPing);
+
+    // empfangene Pakete aufzeichnen (nur mit RECORD_INPUTS)
+    record_init();
+
+    // Fahrbefehle (Stopp) und Posen vor allen anderen Paketen bearbeiten und die
+    // Arbeit pro Aufruf von communication_readPackets() begrenzen, damit z.B. ein
+    // Schwall von User Commands check_conditionalAbort() nicht verzögert
+    communication_setUrgent(CH_IN_DRIVE, true);
+    communication_setUrgent(CH_IN_POSE, true);
+    communication_setReadBudget(128);
 
 
     Motor_init();
@@ -158,6 +180,11 @@ static void init(void) {
 
     //aktiviere die Pins sowie die Ports für die Encoder und Bumper
     initSensors();
+    //Kontakt des Bumpers: Tasks abbrechen, beim Explorieren zurücksetzen und neu planen
+    setBumperCallback(explorer_bumperContact);
+
+    //gespeicherte Parameter und Kalibrierung aus dem EEPROM übernehmen
+    params_init();
 
     // global interrupt enable
     sei();
@@ -180,14 +207,48 @@ char *cardStr2(Direction_t dir){
 
 uint16_t bumpedBefore = 0;
 
-int main(void) {
-    init();
-
+// Standard-Ausgaberaten (Mindestabstand zwischen zwei Paketen in ms)
+static const struct {
+    Channel_t channel;
+    uint16_t interval;
+} outputRates[] = {
+    { CH_OUT_POSE, 100 },
+    { CH_OUT_TELEMETRY, 300 },
+    { CH_OUT_PATH_FOLLOW_STATUS, 10 },
+    { CH_OUT_MUX_TELEMETRY, 10 },
+    { CH_OUT_POSE_STREAM, 20 },
+    { CH_OUT_PING, 1000 },
+    { CH_OUT_COMM_STATS, 1000 },
+    { CH_OUT_USER_DATA, 1000 },
+};
+
+void robot_setup(void) {
     communication_log_P(LEVEL_INFO, PSTR("Booted"));
 
     communication_log(LEVEL_INFO, "Tests:");
     testAll();
 
+    // Prioritäten der ausgehenden Kanäle: Pose und Steuerung vor Telemetrie vor Debug.
+    // Erst nach den Tests setzen: bis dahin senden alle Kanäle blockierend (PRIORITY_HIGH),
+    // damit die Testausgaben beim Booten nicht verworfen werden
+    communication_setPriority(CH_OUT_POSE, PRIORITY_HIGH);
+    communication_setPriority(CH_OUT_GET_POSE, PRIORITY_HIGH);
+    communication_setPriority(CH_OUT_TELEMETRY, PRIORITY_NORMAL);
+    communication_setPriority(CH_OUT_PATH_FOLLOW_STATUS, PRIORITY_NORMAL);
+    communication_setPriority(CH_OUT_MUX_TELEMETRY, PRIORITY_NORMAL);
+    communication_setPriority(CH_OUT_POSE_STREAM, PRIORITY_NORMAL);
+    communication_setPriority(CH_OUT_COMM_STATS, PRIORITY_NORMAL);
+    communication_setPriority(CH_OUT_USER_DATA, PRIORITY_NORMAL);
+    communication_setPriority(CH_OUT_TRACE, PRIORITY_HIGH); // Dump des Flugschreibers vollständig senden
+    communication_setPriority(CH_OUT_RECORD, PRIORITY_HIGH); // Aufzeichnung ist nur lückenlos nachspielbar
+    communication_setPriority(CH_OUT_PING, PRIORITY_HIGH); // verworfene Pings würden als Verluste der Verbindung zählen
+
+    // Ausgaberaten der periodisch gesendeten Kanäle, zur Laufzeit über CH_IN_RATE_CONFIG änderbar
+    for (uint8_t i = 0; i < sizeof(outputRates) / sizeof(outputRates[0]); i++) {
+        communication_setRate(outputRates[i].channel, outputRates[i].interval, true);
+    }
+    communication_setPriority(CH_OUT_DEBUG, PRIORITY_LOW);
+
     logQueue = 1;
 
     //request April Tag Pose to update first location
@@ -195,67 +256,115 @@ int main(void) {
     requestAprilTagPose(requestPoseAprilTag);
     free(requestPoseAprilTag);
 
-    // do forever
-    for (;;) {
-        timeTask_RequestAprilTag();
+    //Regelungsebene starten (Timer 1), ab hier nur noch mit control_lock() auf deren Zustand zugreifen
+    control_init();
+}
+
+
+void robot_loop(void) {
+    // Eingaben des Durchlaufs einmal einlesen: alle Entscheidungen des Durchlaufs hängen nur von
+    // diesen Werten und den empfangenen Paketen ab (nachspielbar, siehe telemetry/record.h)
+    timeTask_latchUptime();
+    latchSensors();
+    //Kopie der Pose für den Durchlauf (die Regelungsebene aktualisiert sie im Interrupt von Timer 1)
+    pose_latch();
+    record_beginIteration();
+
+    //Kontakte des Bumpers übernehmen (Motoren hat die ISR schon angehalten)
+    checkBumped();
+
+    //Planung, Kommunikation und Logging (die Regelungsebene läuft im Interrupt, siehe driving/control.h)
+    timeTask_RequestAprilTag();
+
+    //Time Tasks für die Sensoren
+    updateTelemetry();
+
+    //Alles was mit der Taskqueue zu tun hat
+    manageTasks();
 
-        //Time Tasks für die Sensoren
-        checkBumped();
-        updateTelemetry();
+    //Pfadverfolgung (Lookahead-Punkt für die Regelungsebene, Status senden)
+    checkPathFollower();
 
-        //Alles was mit der Taskqueue zu tun hat
-        manageTasks();
+    //gemeinsamer Telemetrie-Frame (falls eingeschaltet)
+    checkMuxTelemetry();
 
-        //Zum Ausgleichen der Räder
-        checkBalancing();
-        checkPath();
+    //kompakter Pose-Datenstrom (falls eingeschaltet)
+    checkPoseStream();
 
-        //Zum Erkunden des Labyrinths
-        explore();
+    //Flugschreiber senden (aufgezeichnet wird in der Regelungsebene)
+    checkTrace();
 
+    //Umlaufzeit der Verbindung messen
+    checkPing();
 
-        communication_readPackets();
+    //Zähler der Kommunikation senden
+    checkCommStats();
 
-        //log the bumper and encoder data
-        TIMETASK(DEBUG_TELEMETRY, 1000) {
-            if(getBumperCount() != bumpedBefore){
-                communication_log_P(LEVEL_INFO, PSTR("bumped: %i"), getBumperCount());
-                bumpedBefore = getBumperCount();
-            }
+    //Zum Erkunden des Labyrinths
+    explore();
 
-            if(logTelemetry){
-                communication_log_P(LEVEL_INFO, PSTR("EncoderVal1: %i"), getEncoderVal1());
-                communication_log_P(LEVEL_INFO, PSTR("EncoderVal2: %i"), getEncoderVal2());
+    //Kalibrierung der Odometrie (falls gestartet)
+    checkCalibration();
 
-                communication_log_P(LEVEL_INFO, PSTR("count_leftWheel: %i"), getCount_leftWheel());
-                communication_log_P(LEVEL_INFO, PSTR("count_rightWheel: %i"), getCount_rightWheel());
+    //geänderte Parameter ins EEPROM schreiben
+    checkParams();
 
-                communication_log_P(LEVEL_INFO, PSTR("encoder1MM: %i"), getEncoder1MM());
-                communication_log_P(LEVEL_INFO, PSTR("encoder2MM: %i"), getEncoder2MM());
 
-                
+    communication_readPackets();
 
-                communication_log_P(LEVEL_INFO, PSTR("-------------------"));
-            }
+    //log the bumper and encoder data
+    TIMETASK(DEBUG_TELEMETRY, 1000) {
+        if(getBumperCount() != bumpedBefore){
+            communication_log_P(LEVEL_INFO, PSTR("bumped: %i"), getBumperCount());
+            bumpedBefore = getBumperCount();
         }
 
+        if(logTelemetry){
+            communication_log_P(LEVEL_INFO, PSTR("EncoderVal1: %i"), getEncoderVal1());
+            communication_log_P(LEVEL_INFO, PSTR("EncoderVal2: %i"), getEncoderVal2());
 
-        TIMETASK(LED_TASK, 500) { // execute block approximately every 500ms
-            LED2_TOGGLE();
+            communication_log_P(LEVEL_INFO, PSTR("count_leftWheel: %i"), getCount_leftWheel());
+            communication_log_P(LEVEL_INFO, PSTR("count_rightWheel: %i"), getCount_rightWheel());
+
+            communication_log_P(LEVEL_INFO, PSTR("encoder1MM: %i"), getEncoder1MM());
+            communication_log_P(LEVEL_INFO, PSTR("encoder2MM: %i"), getEncoder2MM());
+
+            
+
+            communication_log_P(LEVEL_INFO, PSTR("-------------------"));
+        }
+
+        if(logBalancing){
+            logBalancingState();
         }
+    }
 
-        
 
-        TIMETASK(POSE_TASK, 100) { // execute block approximately every 150ms
-            //update the Pose (basierend auf Encoder-Werten)
-            poseUpdate();
+    TIMETASK(LED_TASK, 500) { // execute block approximately every 500ms
+        LED2_TOGGLE();
+    }
+
+    
 
-            if(logPose) communication_log_P(LEVEL_INFO, PSTR("first April Tag Update received: %i"), firstAprilTagUpdate());
+    if (communication_isChannelDue(CH_OUT_POSE)) { // execute block with the output rate of CH_OUT_POSE (default 100ms)
+        //die Pose (Odometrie) wird in der Regelungsebene aktualisiert, gesendet wird die Kopie des Durchlaufs
+        if(logPose) communication_log_P(LEVEL_INFO, PSTR("first April Tag Update received: %i"), firstAprilTagUpdate());
 
-            //send pose update to HWPCS
+        //send pose update to HWPCS (sonst im Multiplex-Frame bzw. Pose-Datenstrom enthalten)
+        if (!muxTelemetry_covers(MUX_POSE) && !poseStream_isEnabled())
             communication_writePacket(CH_OUT_POSE, (uint8_t*)getPose(), sizeof(*getPose()));
-        }
+    }
+
+    record_endIteration();
+}
 
+int main(void) {
+    robot_init();
+    robot_setup();
+
+    // do forever
+    for (;;) {
+        robot_loop();
     }
 
     return 0;
@@ -27,6 +27,23 @@ extern float achsenlaenge;
 extern float correctionValue;
 extern float tolerance_fixedValue;
 
+/**
+ * Initialisiert Hardware und Kommunikation und registriert die Callbacks
+*/
+void robot_init(void);
+
+/**
+ * Einmalige Einstellungen nach dem Booten (Tests, Prioritäten, Ausgaberaten, erste April Tag Pose)
+*/
+void robot_setup(void);
+
+/**
+ * Ein Durchlauf der Hauptschleife. Liest zu Beginn Uptime und Sensoren ein,
+ * danach hängt der Durchlauf nur von diesen Werten und den empfangenen Paketen ab
+ * (wird so auch von tools/replay auf dem PC ausgeführt)
+*/
+void robot_loop(void);
+
 /**
  * Gibt den Korrekturwert für die Ermittlung des Mittelpunkts des nächsten Felds nach Rotation in Richtung dir zurück
 */
@@ -0,0 +1,172 @@
+#include "params.h"
+#include "main.h"
+#include "../pose/pose.h"
+#include "../driving/driving.h"
+#include "../driving/control.h"
+#include "../tasks/taskManagement.h"
+#include "../explorer/explorer.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+#include <tools/timeTask/timeTask.h>
+#include <communication/communication.h>
+
+
+typedef struct {
+    uint8_t version;        // PARAMS_VERSION
+    uint16_t sequence;      // laufende Nummer, der höchste gültige Block ist der aktuelle
+    float achsenlaenge;
+    float korrekturLinkesRad;
+    float korrekturRechtesRad;
+    float mmPerTick_left;
+    float mmPerTick_right;
+    float correctionValue;
+    float tolerance_fixedValue;
+    float tolerance_theta;
+    uint16_t breakTime;
+    float realignTolerance;
+    uint16_t crc;           // über alle vorherigen Bytes, wird als letztes geschrieben
+} ParamBlock_t;
+
+static ParamBlock_t EEMEM params_slots[PARAMS_SLOTS];
+
+static ParamBlock_t defaults;   // Werte aus main.c beim Booten
+static ParamBlock_t stored;     // zuletzt gespeicherter (bzw. geladener) Block
+static uint8_t storedSlot = PARAMS_SLOTS - 1; // damit der erste Block in Speicherplatz 0 landet
+
+static bool dirty = 0;          // Änderung noch nicht ins EEPROM übernommen
+static uint16_t changedAt = 0;  // Uptime der letzten Änderung
+
+// Block, der gerade geschrieben wird
+static ParamBlock_t writing;
+static uint8_t writingSlot = 0;
+static uint8_t writingPos = 0;
+static bool isWriting = 0;
+
+
+static uint16_t getCrc(const ParamBlock_t* block) {
+    const uint8_t* data = (const uint8_t*)block;
+    uint16_t crc = 0xFFFF;
+    for(uint8_t i = 0; i < offsetof(ParamBlock_t, crc); i++){
+        crc = _crc16_update(crc, data[i]);
+    }
+    return crc;
+}
+
+/**
+ * Aktuelle Werte in einen Block übernehmen (ohne Nummer und CRC)
+*/
+static void collect(ParamBlock_t* block) {
+    block->version = PARAMS_VERSION;
+    block->achsenlaenge = achsenlaenge;
+    block->korrekturLinkesRad = korrekturLinkesRad;
+    block->korrekturRechtesRad = korrekturRechtesRad;
+    block->mmPerTick_left = pose_getMmPerTick_left();
+    block->mmPerTick_right = pose_getMmPerTick_right();
+    block->correctionValue = correctionValue;
+    block->tolerance_fixedValue = tolerance_fixedValue;
+    block->tolerance_theta = getToleranceTheta();
+    block->breakTime = getBreakTime();
+    block->realignTolerance = getRealignTolerance();
+}
+
+static void apply(const ParamBlock_t* block) {
+    control_lock();
+    achsenlaenge = block->achsenlaenge;
+    korrekturLinkesRad = block->korrekturLinkesRad;
+    korrekturRechtesRad = block->korrekturRechtesRad;
+    pose_setMmPerTick(block->mmPerTick_left, block->mmPerTick_right);
+    correctionValue = block->correctionValue;
+    tolerance_fixedValue = block->tolerance_fixedValue;
+    setToleranceTheta(block->tolerance_theta);
+    control_unlock();
+    setBreakTime(block->breakTime);
+    setRealignTolerance(block->realignTolerance);
+}
+
+/**
+ * Gleiche Werte wie der gespeicherte Block? (Nummer und CRC zählen nicht)
+*/
+static bool isStored(const ParamBlock_t* block) {
+    return memcmp(&block->achsenlaenge, &stored.achsenlaenge, offsetof(ParamBlock_t, crc) - offsetof(ParamBlock_t, achsenlaenge)) == 0;
+}
+
+
+void params_init() {
+    collect(&defaults);
+    stored = defaults;
+
+    bool found = 0;
+    for(uint8_t i = 0; i < PARAMS_SLOTS; i++){
+        ParamBlock_t block;
+        eeprom_read_block(&block, &params_slots[i], sizeof(block));
+        if(block.version != PARAMS_VERSION || block.crc != getCrc(&block)){
+            continue;
+        }
+        //Nummern über den Überlauf hinweg vergleichen
+        if(!found || (int16_t)(block.sequence - stored.sequence) > 0){
+            stored = block;
+            storedSlot = i;
+            found = 1;
+        }
+    }
+
+    if(found){
+        apply(&stored);
+        communication_log_P(LEVEL_INFO, PSTR("Parameter aus EEPROM (Platz %u, Nr. %u): Achse %.1f mm, mm/Tic %.5f / %.5f"),
+            storedSlot, stored.sequence, stored.achsenlaenge, stored.mmPerTick_left, stored.mmPerTick_right);
+    } else {
+        communication_log_P(LEVEL_INFO, PSTR("Keine Parameter im EEPROM, Standardwerte"));
+    }
+}
+
+void params_save() {
+    dirty = 1;
+    changedAt = timeTask_getTaskUptime();
+}
+
+void params_reset() {
+    apply(&defaults);
+    params_save();
+    communication_log_P(LEVEL_INFO, PSTR("Parameter auf Standardwerte zurückgesetzt"));
+}
+
+void checkParams() {
+    if(isWriting){
+        if(!eeprom_is_ready()){
+            return;
+        }
+        uint8_t* address = (uint8_t*)&params_slots[writingSlot] + writingPos;
+        eeprom_update_byte(address, ((const uint8_t*)&writing)[writingPos]);
+        writingPos++;
+        if(writingPos == sizeof(writing)){
+            isWriting = 0;
+            stored = writing;
+            storedSlot = writingSlot;
+            communication_log_P(LEVEL_INFO, PSTR("Parameter gespeichert (Platz %u, Nr. %u)"), storedSlot, stored.sequence);
+        }
+        return;
+    }
+
+    if(!dirty || (uint16_t)(timeTask_getTaskUptime() - changedAt) < PARAMS_SAVE_DELAY){
+        return;
+    }
+    dirty = 0;
+
+    collect(&writing);
+    if(isStored(&writing)){
+        return; //unverändert, EEPROM schonen
+    }
+    writing.sequence = stored.sequence + 1;
+    writing.crc = getCrc(&writing);
+    writingSlot = (storedSlot + 1) % PARAMS_SLOTS;
+    writingPos = 0;
+    isWriting = 1;
+}
+
+bool params_isPending() {
+    return dirty || isWriting;
+}
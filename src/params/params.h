@@ -0,0 +1,81 @@
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//******************//
+/*
+Aufgabe:
+Hält die Einstellungen des Roboters im EEPROM, damit er nach dem Einschalten ohne erneutes Senden von
+CH_IN_ROBOT_PARAMS und TaskCommand (commTweak) einsatzbereit ist:
+achsenlaenge, korrekturLinkesRad/korrekturRechtesRad, mm pro Tic beider Räder (pose_setMmPerTick()),
+correctionValue, tolerance_fixedValue, Toleranz der Ausrichtung (setToleranceTheta()), die Pause zwischen
+zwei Tasks (setBreakTime()) und die Toleranz der Neuausrichtung des Explorers (setRealignTolerance()). Die Umrechnung der Infrarotwerte ist fest (convertInfraredToMM()) und wird nicht
+gespeichert.
+
+Die Werte liegen als Block mit Version, laufender Nummer und CRC in einem von PARAMS_SLOTS Speicherplätzen.
+Jede Änderung wird in den nächsten Speicherplatz geschrieben (Verteilung der Schreibzugriffe, ein Speicherplatz
+wird erst nach PARAMS_SLOTS Änderungen wieder beschrieben). Beim Laden gilt der gültige Block mit der höchsten
+Nummer; wird das Schreiben durch einen Reset unterbrochen, passt die CRC nicht und der vorherige Block bleibt gültig.
+Blöcke einer anderen PARAMS_VERSION werden ignoriert (Standardwerte aus main.c).
+
+Geschrieben wird erst, wenn PARAMS_SAVE_DELAY ms lang keine weitere Änderung kam, und zwar ein Byte pro Aufruf von
+checkParams() und nur, wenn das EEPROM bereit ist: die Hauptschleife wartet nie auf das EEPROM (ca. 3,3 ms pro Byte).
+
+Bietet folgende Funktionalitäten an:
+- params_init(): Merkt sich die Standardwerte und übernimmt den gespeicherten Block
+- params_save(): Speichert die aktuellen Werte (verzögert)
+- params_reset(): Übernimmt und speichert die Standardwerte (User Command 55)
+- checkParams(): Schreibt einen geänderten Block schrittweise ins EEPROM
+
+ Wie verwenden?
+ - params_init() einmal in robot_init() nach communication_init() aufrufen, checkParams() in der Hauptschleife
+ - nach jeder Änderung der Werte (commParameters(), commTweak(), Kalibrierung, User Command 56) params_save() aufrufen
+ - bei Änderungen am Inhalt des Blocks PARAMS_VERSION erhöhen
+ - tools/replay startet ohne gespeicherten Block, Aufzeichnungen eines Roboters mit gespeicherten Werten laufen
+   dort mit den Standardwerten
+*/
+//******************//
+
+/**
+ * Version des Inhalts des Blocks
+*/
+#define PARAMS_VERSION 2
+
+/**
+ * Anzahl der Speicherplätze im EEPROM
+*/
+#define PARAMS_SLOTS 16
+
+/**
+ * So lange (ms) muss nach einer Änderung Ruhe sein, bevor geschrieben wird
+*/
+#define PARAMS_SAVE_DELAY 1000
+
+/**
+ * Merkt sich die aktuellen Werte als Standardwerte und übernimmt den neuesten gültigen Block aus dem EEPROM
+*/
+void params_init();
+
+/**
+ * Speichert die aktuellen Werte nach PARAMS_SAVE_DELAY ms ohne weitere Änderung
+*/
+void params_save();
+
+/**
+ * Übernimmt die Standardwerte und speichert sie
+*/
+void params_reset();
+
+/**
+ * Schreibt einen geänderten Block ins EEPROM (ein Byte pro Aufruf, in der Hauptschleife aufrufen)
+*/
+void checkParams();
+
+/**
+ * @returns true, solange geänderte Werte noch nicht vollständig gespeichert sind
+*/
+bool params_isPending();
+
+#endif
@@ -4,9 +4,11 @@
 #include <communication/communication.h>
 #include <pathFollower/pathFollower.h>
 #include "../driving/driving.h"
+#include "../driving/control.h"
 #include "../pose/pose.h"
 #include "../channels/channels.h"
 #include "../tasks/tasks.h"
+#include "../telemetry/muxTelemetry.h"
 #include "main.h"
 #include "math.h"
 #include "motor/motor.h"
@@ -14,6 +16,10 @@
 #include <avr/pgmspace.h>           // AVR Program Space Utilities
 
 
+// Lookahead-Punkt für die Regelungsebene, von checkPathFollower() gesetzt (nur mit control_lock() ändern)
+static bool path_active = 0;
+static FPoint_t path_lookahead;
+
 
 /**
  * Gibt ausgehend von der aktuellen Pose einen Fahrbefehl zurück, welcher den Roboter auf den Lookahead-Punkt zufahren lässt
@@ -40,7 +46,7 @@ void calculateDriveCommand(Pose_t *pose, const FPoint_t *lookahead) {
     float vl = v - vDiff;
 
 
-    Motor_setPWM(-vl, -vr);
+    setMotorSpeed(vl, vr);
 }
 
 
@@ -48,17 +54,36 @@ void calculateDriveCommand(Pose_t *pose, const FPoint_t *lookahead) {
 
 
 void checkPath() {
+    CONTROLTASK(FOLLOWER_DRIVE_TASK, 10) {
+            if (path_active) {
+                calculateDriveCommand(getPose(), &path_lookahead);
+            }
+    }
+}
+
+void checkPathFollower() {
     TIMETASK(FOLLOWER_TASK, 10) {
             const PathFollowerStatus_t* pathFollower_status = pathFollower_getStatus();
+            bool active = 0;
+            bool reached = 0;
             if (pathFollower_status->enabled) {
-                if (pathFollower_update(getPose())) {
-                    calculateDriveCommand(getPose(), &pathFollower_status->lookahead);
-                } else {
-                    stopDrive();
-                }
-                sendPathFollowerStatus(pathFollower_status); // send pathFollower_status on channel CH_OUT_PATH_FOLLOW_STATUS
+                active = pathFollower_update(getPose());
+                reached = !active;
+                if (!muxTelemetry_covers(MUX_FOLLOWER) && communication_isChannelDue(CH_OUT_PATH_FOLLOW_STATUS)) // sonst im Multiplex-Frame enthalten
+                    sendPathFollowerStatus(pathFollower_status); // send pathFollower_status on channel CH_OUT_PATH_FOLLOW_STATUS
+            }
+
+            control_lock();
+            path_active = active;
+            path_lookahead = pathFollower_status->lookahead;
+            control_unlock();
+
+            if (reached) {
+                stopDrive();
             }
     }
 }
 
-
+bool path_isActive() {
+    return path_active;
+}
@@ -1,6 +1,37 @@
 #ifndef PATH_H
 #define PATH_H
 
+#include <stdbool.h>
+
+//******************//
+/*
+Aufgabe:
+Pfadverfolgung (lib/pathFollower): die Bibliothek (Pfad, Lookahead-Punkt, Status, Logging) läuft in der
+Hauptschleife, die Regelungsebene (driving/control.h) fährt mit der aktuellen Pose auf den zuletzt bestimmten
+Lookahead-Punkt zu.
+
+Bietet folgende Funktionalitäten an:
+- checkPathFollower(): Bestimmt den Lookahead-Punkt und sendet den Status (Hauptschleife)
+- checkPath(): Stufe der Regelungsebene, fährt zum Lookahead-Punkt
+- path_isActive(): Fährt die Regelungsebene gerade einen Pfad ab?
+*/
+//******************//
+
+/**
+ * Führt alle 10ms die Pfadverfolgung mit der Pose des Durchlaufs aus, übergibt den Lookahead-Punkt an die
+ * Regelungsebene und sendet den Status auf CH_OUT_PATH_FOLLOW_STATUS (Hauptschleife). Am Ende des Pfads hält der
+ * Roboter an.
+*/
+void checkPathFollower();
+
+/**
+ * Stufe der Regelungsebene: fährt alle 10ms auf den Lookahead-Punkt zu, solange die Pfadverfolgung läuft
+*/
 void checkPath();
 
-#endif
\ No newline at end of file
+/**
+ * @returns true, solange die Regelungsebene auf den Lookahead-Punkt zufährt (auch aus einer Stufe)
+*/
+bool path_isActive();
+
+#endif
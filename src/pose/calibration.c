@@ -0,0 +1,210 @@
+#include "calibration.h"
+#include "pose.h"
+#include "main.h"
+#include "../driving/driving.h"
+#include "../driving/control.h"
+#include "../sensors/sensors.h"
+#include "../helper/mathHelper.h"
+#include "../params/params.h"
+#include "../telemetry/ping.h"
+
+#include <math.h>
+#include <avr/pgmspace.h>
+#include <tools/timeTask/timeTask.h>
+#include <communication/communication.h>
+
+
+typedef enum {
+    CALIBRATION_IDLE,
+    CALIBRATION_FIX_START,    // wartet auf die AprilTag-Pose am Start
+    CALIBRATION_STRAIGHT,     // Geradeausfahrt bzw. Pause danach
+    CALIBRATION_FIX_STRAIGHT, // wartet auf die AprilTag-Pose nach der Geradeausfahrt
+    CALIBRATION_ROTATE,       // Drehungen bzw. Pause danach
+    CALIBRATION_FIX_ROTATE    // wartet auf die AprilTag-Pose nach den Drehungen
+} CalibrationState_t;
+
+static CalibrationState_t state = CALIBRATION_IDLE;
+static uint16_t stateSince = 0;  // Uptime beim Anfordern der Pose bzw. beim Anhalten
+static uint16_t fixCount = 0;    // pose_getAprilTagCount() beim Anfordern der Pose
+static uint8_t fixSeq = 0;       // Sequenznummer der eigenen Anfrage
+static bool stopped = 0;         // angehalten, Pause läuft
+
+// AprilTag-Posen und Encoder-Zähler am Start und nach der Geradeausfahrt
+static Pose_t fixStart;
+static Pose_t fixStraight;
+static int16_t encoder1Start, encoder2Start;
+static int16_t encoder1Straight, encoder2Straight;
+
+// Ergebnis der Geradeausfahrt
+static float mmPerTick_left;
+static float mmPerTick_right;
+
+
+static void requestFix(uint16_t uptime) {
+    fixCount = pose_getAprilTagCount();
+    stateSince = uptime;
+    GetPose_t request;
+    fixSeq = requestAprilTagPose(&request);
+}
+
+static void abortCalibration(const char* reason) {
+    stopDrive();
+    state = CALIBRATION_IDLE;
+    communication_log_P(LEVEL_WARNING, PSTR("Kalibrierung abgebrochen: %s"), reason);
+}
+
+static bool isPlausible(float value, float reference) {
+    return fabs(value - reference) <= CALIBRATION_MAX_DEVIATION * reference;
+}
+
+/**
+ * mm pro Tic beider Räder aus der Geradeausfahrt: Weg des Mittelpunkts auf dem Kreisbogen durch Start und Ziel,
+ * die Räder laufen um die halbe Achse innen bzw. außen
+*/
+static bool solveWheels() {
+    int16_t ticksRight = encoder1Straight - encoder1Start;
+    int16_t ticksLeft = encoder2Straight - encoder2Start;
+    if(ticksRight <= 0 || ticksLeft <= 0){
+        return 0;
+    }
+
+    float deltaTheta = angle_subtract(fixStraight.theta, fixStart.theta);
+    float arc = getDistance(fixStart.x, fixStart.y, fixStraight.x, fixStraight.y);
+    if(fabs(deltaTheta) > 0.001f){
+        arc *= (deltaTheta / 2) / sin(deltaTheta / 2);
+    }
+    mmPerTick_right = (arc + deltaTheta * achsenlaenge / 2) / ticksRight;
+    mmPerTick_left = (arc - deltaTheta * achsenlaenge / 2) / ticksLeft;
+
+    communication_log_P(LEVEL_INFO, PSTR("Kalibrierung: %i mm, Winkel %.3f rad, Tics links %i, rechts %i"), (int)arc, deltaTheta, ticksLeft, ticksRight);
+    return isPlausible(mmPerTick_left, pose_getMmPerTick_left()) && isPlausible(mmPerTick_right, pose_getMmPerTick_right());
+}
+
+/**
+ * Odometrischer Drehwinkel seit der Pose nach der Geradeausfahrt (mit den neuen mm pro Tic)
+*/
+static float getRotation(float axle) {
+    const SensorInputs_t* inputs = getSensorInputs();
+    float right = (int16_t)(inputs->encoder1Total - encoder1Straight) * mmPerTick_right;
+    float left = (int16_t)(inputs->encoder2Total - encoder2Straight) * mmPerTick_left;
+    return (right - left) / axle;
+}
+
+/**
+ * Achsenlänge aus den Drehungen: der odometrische Winkel wird um die Abweichung zur AprilTag-Ausrichtung korrigiert
+ * (die Odometrie muss dafür auf weniger als eine halbe Umdrehung stimmen)
+*/
+static bool solveAxle(float* axle, float* rotation) {
+    float odometry = getRotation(achsenlaenge);
+    float expected = angles_add(fixStraight.theta, fmod(odometry, 2 * M_PI));
+    *rotation = odometry + angle_subtract(getPose()->theta, expected);
+    if(fabs(*rotation) < M_PI){
+        return 0;
+    }
+    *axle = achsenlaenge * odometry / *rotation;
+    return isPlausible(*axle, achsenlaenge);
+}
+
+void calibration_start() {
+    if(state != CALIBRATION_IDLE){
+        return;
+    }
+    communication_log_P(LEVEL_INFO, PSTR("Kalibrierung gestartet"));
+    stopDrive();
+    stopped = 0;
+    requestFix(timeTask_getTaskUptime());
+    state = CALIBRATION_FIX_START;
+}
+
+bool calibration_isRunning() {
+    return state != CALIBRATION_IDLE;
+}
+
+void checkCalibration() {
+    if(state == CALIBRATION_IDLE){
+        return;
+    }
+    const SensorInputs_t* inputs = getSensorInputs();
+    uint16_t uptime = timeTask_getTaskUptime();
+
+    //auf die Antwort auf die eigene Anfrage warten (sie ersetzt die Pose), Antworten auf andere Anfragen zählen nicht
+    bool waitingForFix = state == CALIBRATION_FIX_START || state == CALIBRATION_FIX_STRAIGHT || state == CALIBRATION_FIX_ROTATE;
+    if(waitingForFix && (pose_getAprilTagCount() == fixCount || ping_getAcceptedPoseSeq() != fixSeq)){
+        if((uint16_t)(uptime - stateSince) > CALIBRATION_FIX_TIMEOUT){
+            abortCalibration("keine AprilTag-Pose");
+        }
+        return;
+    }
+
+    switch(state){
+        case CALIBRATION_FIX_START:
+            fixStart = *getPose();
+            encoder1Start = inputs->encoder1Total;
+            encoder2Start = inputs->encoder2Total;
+            initDrive(CALIBRATION_SPEED, 0);
+            state = CALIBRATION_STRAIGHT;
+            break;
+
+        case CALIBRATION_STRAIGHT:
+            if(!stopped){
+                if(getDistance(fixStart.x, fixStart.y, getPose()->x, getPose()->y) >= CALIBRATION_DISTANCE){
+                    stopDrive();
+                    stopped = 1;
+                    stateSince = uptime;
+                }
+            } else if((uint16_t)(uptime - stateSince) >= CALIBRATION_SETTLE_TIME){
+                stopped = 0;
+                requestFix(uptime);
+                state = CALIBRATION_FIX_STRAIGHT;
+            }
+            break;
+
+        case CALIBRATION_FIX_STRAIGHT:
+            fixStraight = *getPose();
+            encoder1Straight = inputs->encoder1Total;
+            encoder2Straight = inputs->encoder2Total;
+            if(!solveWheels()){
+                abortCalibration("Geradeausfahrt nicht plausibel");
+                break;
+            }
+            initDrive(CALIBRATION_SPEED, CALIBRATION_SPEED); //im Uhrzeigersinn
+            state = CALIBRATION_ROTATE;
+            break;
+
+        case CALIBRATION_ROTATE:
+            if(!stopped){
+                if(fabs(getRotation(achsenlaenge)) >= 2 * M_PI * CALIBRATION_TURNS){
+                    stopDrive();
+                    stopped = 1;
+                    stateSince = uptime;
+                }
+            } else if((uint16_t)(uptime - stateSince) >= CALIBRATION_SETTLE_TIME){
+                stopped = 0;
+                requestFix(uptime);
+                state = CALIBRATION_FIX_ROTATE;
+            }
+            break;
+
+        case CALIBRATION_FIX_ROTATE: {
+            float axle, rotation;
+            if(!solveAxle(&axle, &rotation)){
+                abortCalibration("Drehungen nicht plausibel");
+                break;
+            }
+            control_lock();
+            pose_setMmPerTick(mmPerTick_left, mmPerTick_right);
+            achsenlaenge = axle;
+            korrekturLinkesRad = mmPerTick_left / MM_PER_TICK;
+            korrekturRechtesRad = mmPerTick_right / MM_PER_TICK;
+            control_unlock();
+            params_save();
+            state = CALIBRATION_IDLE;
+            //nur eine Meldung pro Durchlauf, eine zweite lange Meldung passt nicht mehr in den Sendepuffer
+            communication_log_P(LEVEL_INFO, PSTR("Kalibrierung beendet: Drehung %.2f rad, mm/Tic links %.5f, rechts %.5f, Achse %.1f mm"), rotation, mmPerTick_left, mmPerTick_right, achsenlaenge);
+            break;
+        }
+
+        case CALIBRATION_IDLE:
+            break;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//******************//
+/*
+Aufgabe:
+Kalibriert die Odometrie (mm pro Encoder-Tic beider Räder und die wirksame Achsenlänge), statt korrekturLinkesRad,
+korrekturRechtesRad und achsenlaenge von Hand einzustellen.
+1. AprilTag-Pose am Start
+2. Geradeausfahrt über CALIBRATION_DISTANCE mm, Pause, AprilTag-Pose:
+   aus Strecke und Winkeländerung laut AprilTag ergibt sich der Weg jedes Rads (Kreisbogen, Achse wie bisher),
+   geteilt durch seine Tics => mm pro Tic links und rechts
+3. CALIBRATION_TURNS volle Drehungen auf der Stelle, Pause, AprilTag-Pose:
+   Drehwinkel = Odometrie (mit den neuen Werten) korrigiert um die Abweichung zur AprilTag-Ausrichtung,
+   Achsenlänge = (Weg rechts - Weg links) / Drehwinkel
+4. Ergebnisse übernehmen: pose_setMmPerTick() (Odometrie, Geschwindigkeitsregelung), achsenlaenge,
+   korrekturLinkesRad/korrekturRechtesRad (Zähler für das Balancing), gespeichert im EEPROM (params/params.h)
+Ergebnisse, die um mehr als CALIBRATION_MAX_DEVIATION vom bisherigen Wert abweichen, werden verworfen.
+
+Bietet folgende Funktionalitäten an:
+- calibration_start(): Beginnt die Kalibrierung (User Command 54)
+- checkCalibration(): Führt die Kalibrierung Schritt für Schritt aus
+- calibration_isRunning(): Läuft gerade eine Kalibrierung?
+
+ Wie verwenden?
+ - checkCalibration() in der Hauptschleife aufrufen
+ - Roboter mit mindestens CALIBRATION_DISTANCE mm freier Strecke nach vorne im Sichtfeld der Kamera abstellen,
+   keine Tasks und kein Explorer während der Kalibrierung
+ - übernommen wird nur die Antwort auf die eigene Anfrage (Sequenznummer, telemetry/ping.h), die regelmäßigen
+   Anfragen (timeTask_RequestAprilTag()) pausieren solange. Ohne GetPoseSeq_t gilt eine Antwort als eigene, solange
+   keine weitere Anfrage gesendet wurde.
+*/
+//******************//
+
+/**
+ * Strecke der Geradeausfahrt in mm
+*/
+#define CALIBRATION_DISTANCE 500.0f
+
+/**
+ * Anzahl voller Drehungen auf der Stelle
+*/
+#define CALIBRATION_TURNS 2
+
+/**
+ * Geschwindigkeit beim Fahren und Drehen (wie setMotorSpeed())
+*/
+#define CALIBRATION_SPEED 1500
+
+/**
+ * Pause nach dem Anhalten in ms, bevor die AprilTag-Pose angefordert wird
+*/
+#define CALIBRATION_SETTLE_TIME 500
+
+/**
+ * Ohne AprilTag-Pose nach dieser Zeit (ms) wird die Kalibrierung abgebrochen
+*/
+#define CALIBRATION_FIX_TIMEOUT 2000
+
+/**
+ * Erlaubte relative Abweichung der Ergebnisse von den bisherigen Werten
+*/
+#define CALIBRATION_MAX_DEVIATION 0.2f
+
+/**
+ * Beginnt die Kalibrierung (nur, falls keine läuft)
+*/
+void calibration_start();
+
+/**
+ * Führt die Kalibrierung aus (Zustandsautomat, in der Hauptschleife aufrufen)
+*/
+void checkCalibration();
+
+/**
+ * @returns true, solange eine Kalibrierung läuft
+*/
+bool calibration_isRunning();
+
+#endif
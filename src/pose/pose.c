@@ -9,15 +9,16 @@
 #include <tools/timeTask/timeTask.h>
 #include <communication/communication.h>
 #include "../tasks/taskManagement.h"
+#include "../telemetry/ping.h"
+#include "../driving/control.h"
+#include "calibration.h"
 
 
 #include <avr/pgmspace.h>           // AVR Program Space Utilities
 #include <stdlib.h> 
 
-//#define MM_PER_TICK (0.140845070422535f)
-#define MM_PER_TICK (45.0f*M_PI/1024.0f)
-
 Pose_t pose;// = {0.0f, 0.0f, M_PI};
+static Pose_t pose_latched; //Kopie für die Hauptschleife (pose_latch())
 Pose_t * poseTemp;
 bool poseUpdateFirst = true;
 
@@ -33,26 +34,28 @@ float distDiff = 0.0f;
 
 uint16_t poseUpdateCounter = 0;
 
+//Strecke pro Tic der beiden Räder (Kalibrierung)
+static float mmPerTick_left = MM_PER_TICK;
+static float mmPerTick_right = MM_PER_TICK;
+
+//Anzahl empfangener AprilTag-Posen
+static uint16_t aprilTagCount = 0;
+
 
 float deltaTotal(float deltaX, float deltaY){
     return sqrt(deltaX*deltaX + deltaY*deltaY);
 }
 
 //aktualisiert die Pose basierend auf Encoder-Werten
-void poseUpdate() {
+void poseUpdate(int16_t encoder1, int16_t encoder2) {
     if (checkAprilPose == false) {
         return;
     }
 
+    float currRightMM = encoder1 * mmPerTick_right;
+    float currLeftMM = encoder2 * mmPerTick_left;
 
-    int16_t encoder1;
-    int16_t encoder2;
-    getAndResetEncoders(&encoder1, &encoder2);
-
-    float currRightMM = encoder1 * MM_PER_TICK;
-    float currLeftMM = encoder2 * MM_PER_TICK;
-
-    if (encoder1 != encoder2) {
+    if (currRightMM != currLeftMM) {
         float deltaTheta = (currRightMM - currLeftMM) / (float) achsenlaenge;
         float deltaX = (currRightMM+currLeftMM) / (currRightMM-currLeftMM) * (achsenlaenge/2) * (sin(pose.theta + deltaTheta) - sin(pose.theta));
         float deltaY = (currRightMM+currLeftMM) / (currRightMM-currLeftMM) * (achsenlaenge/2) * (cos(pose.theta) - cos(pose.theta + deltaTheta));
@@ -80,19 +83,50 @@ void poseUpdate() {
 }
 
 Pose_t *getPose() {
-    return &pose;
+    return control_isStepping() ? &pose : &pose_latched;
+}
+
+void pose_latch() {
+    control_lock();
+    pose_latched = pose;
+    control_unlock();
+}
+
+void pose_setMmPerTick(float left, float right) {
+    control_lock();
+    mmPerTick_left = left;
+    mmPerTick_right = right;
+    control_unlock();
+}
+
+float pose_getMmPerTick_left() {
+    return mmPerTick_left;
+}
+
+float pose_getMmPerTick_right() {
+    return mmPerTick_right;
 }
 
 bool firstAprilTagUpdate(){
     return checkAprilPose;
 }
 
-void poseUpdateAprilTag(const uint8_t* packet, __attribute__((unused)) const uint16_t size) {
+uint16_t pose_getAprilTagCount(){
+    return aprilTagCount;
+}
+
+void poseUpdateAprilTag(const uint8_t* packet, const uint16_t size) {
+    //nur für die Statistik der Umlaufzeit, übernommen wird jede Antwort (sonst blieben pausierte Tasks bis zur
+    //nächsten Anfrage stehen)
+    if(!ping_poseReceived(packet, size)){
+        if(logPose) communication_log_P(LEVEL_INFO, PSTR("POSE_APRIL_TAG ohne ausstehende Anfrage (verspätet bzw. zu älterer Anfrage)"));
+    }
     poseTemp = (Pose_t*) packet;
     
     if(logPose) communication_log_P(LEVEL_INFO, PSTR("Angeforderte POSE_APRIL_TAG: %i %i %i"), (int) poseTemp->x, (int) poseTemp->y, (int) (poseTemp->theta*100));
     
     aktualisierePose();
+    aprilTagCount++;
     unpauseTasks();
 
     if (!checkAprilPose) {
@@ -105,21 +139,27 @@ void poseUpdateAprilTag(const uint8_t* packet, __attribute__((unused)) const uin
 void aktualisierePose() {
     if(logPose) {
         communication_log_P(LEVEL_INFO, PSTR("Pose  - April Tag neue Pose vorhanden (+)"));
-        communication_log_P(LEVEL_INFO, PSTR("aktuelle Pose: %i %i %i"), (int)pose.x, (int)pose.y, (int)(pose.theta*100));
-        communication_log_P(LEVEL_INFO, PSTR("neue Pose: %i %i %i"), (int)pose.x, (int)pose.y, (int)(pose.theta*100));
+        communication_log_P(LEVEL_INFO, PSTR("aktuelle Pose: %i %i %i"), (int)pose_latched.x, (int)pose_latched.y, (int)(pose_latched.theta*100));
+        communication_log_P(LEVEL_INFO, PSTR("neue Pose: %i %i %i"), (int)poseTemp->x, (int)poseTemp->y, (int)(poseTemp->theta*100));
     }
     
+    control_lock();
     pose.x = poseTemp->x;
     pose.y = poseTemp->y;
     pose.theta = poseTemp->theta;
+    pose_latched = pose;
+    control_unlock();
 }
 
 
 
 //function to return the April Tag Pose
-void requestAprilTagPose(GetPose_t * aprilTag) {
+uint8_t requestAprilTagPose(GetPose_t * aprilTag) {
     aprilTag->aprilTagType = APRIL_TAG_MAIN;
-    communication_writePacket(CH_OUT_GET_POSE, (uint8_t*) aprilTag, sizeof(*aprilTag));
+    // Umlaufzeit messen, optional mit Sequenznummer (GetPoseSeq_t, siehe telemetry/ping.h)
+    GetPoseSeq_t request = { aprilTag->aprilTagType, ping_poseRequested() };
+    communication_writePacket(CH_OUT_GET_POSE, (uint8_t*) &request, ping_isPoseSeqEnabled() ? sizeof(request) : sizeof(*aprilTag));
+    return request.seq;
 }
 
 
@@ -129,7 +169,8 @@ void timeTask_RequestAprilTag() {
     TIMETASK(APRIL_TAG_TASK, 100) {
         requestAprilTagPoseCounter++;
         //if(requestAprilTagPoseCounter >= 255 && !isTaskActive()) {
-        if(requestAprilTagPoseCounter >= 120 && !isTaskActive()) {
+        //während der Kalibrierung keine eigenen Anfragen, sonst verfällt deren Anfrage (siehe calibration.c)
+        if(requestAprilTagPoseCounter >= 120 && !isTaskActive() && !calibration_isRunning()) {
             pauseTasks();
             GetPose_t * requestPoseAprilTag = (GetPose_t*) malloc(sizeof(GetPose_t));
             requestAprilTagPose(requestPoseAprilTag);
@@ -144,7 +185,10 @@ void startMeasuring_thetaDiff() {
 }
 
 float getThetaDiff(){
-    return thetaDiff;
+    control_lock();
+    float diff = thetaDiff;
+    control_unlock();
+    return diff;
 }
 
 void startMeasuring_distDiff() {
@@ -152,18 +196,22 @@ void startMeasuring_distDiff() {
 }
 
 float getDistDiff() {
-    return distDiff;
+    control_lock();
+    float diff = distDiff;
+    control_unlock();
+    return diff;
 }
 
 Direction_t pose_getCurrentCardinalDirection() {
+    float theta = getPose()->theta;
     //Theta gibt den Winkel zwischen der x-Achse und der Vorwärtsrichtung des Roboters an
-    if(pose.theta >= -M_PI_4 && pose.theta <= M_PI_4) { //Theta zwischen -pi/4 und pi/4
+    if(theta >= -M_PI_4 && theta <= M_PI_4) { //Theta zwischen -pi/4 und pi/4
         return DIRECTION_EAST;
-    } else if(pose.theta > M_PI_4 && pose.theta <= 3*M_PI_4) { //Theta zwischen pi/4 und 3pi/4
+    } else if(theta > M_PI_4 && theta <= 3*M_PI_4) { //Theta zwischen pi/4 und 3pi/4
         return DIRECTION_NORTH;
-    } else if((pose.theta > -3*M_PI_4) && (pose.theta <= -M_PI_4)) { //Theta zwischen 3pi/4 und 5pi/4
+    } else if((theta > -3*M_PI_4) && (theta <= -M_PI_4)) { //Theta zwischen 3pi/4 und 5pi/4
         return DIRECTION_SOUTH;
-    } else if(pose.theta > 3*M_PI_4 || pose.theta < -3*M_PI_4) { //Theta zwischen 5pi/4 und 7pi/4
+    } else if(theta > 3*M_PI_4 || theta < -3*M_PI_4) { //Theta zwischen 5pi/4 und 7pi/4
         return DIRECTION_WEST;
     } 
     communication_log(LEVEL_SEVERE, "pose_getCurrentCardinalDirection() -> theta out of range");
@@ -188,24 +236,20 @@ float getAngle_forCardinalDirection(Direction_t direction) {
 void correctPose(Direction_t direction, float correctionValue){
     if(logPoseCorrection) communication_log_P(LEVEL_INFO, PSTR(""));
     if(logPoseCorrection) communication_log_P(LEVEL_INFO, PSTR("----- correctPose. direction: %i, correctionValue: %.3f -----"), direction, correctionValue);
+    control_lock();
     switch(direction){
         case DIRECTION_NORTH:
-            pose.x = correctionValue;
-            if(logPoseCorrection) communication_log_P(LEVEL_INFO, PSTR("  -> pose.x = correctionValue. pose.x: %.3f"), pose.x);
-            break;
-        case DIRECTION_EAST:
-            pose.y = correctionValue;
-            if(logPoseCorrection) communication_log_P(LEVEL_INFO, PSTR("  -> pose.y = correctionValue. pose.y: %.3f"), pose.y);
-            break;
         case DIRECTION_SOUTH:
             pose.x = correctionValue;
-            if(logPoseCorrection) communication_log_P(LEVEL_INFO, PSTR("  -> pose.x = correctionValue. pose.x: %.3f"), pose.x);
             break;
+        case DIRECTION_EAST:
         case DIRECTION_WEST:
             pose.y = correctionValue;
-            if(logPoseCorrection) communication_log_P(LEVEL_INFO, PSTR("  -> pose.y = correctionValue. pose.y: %.3f"), pose.y);
             break;
     }
+    pose_latched = pose;
+    control_unlock();
+    if(logPoseCorrection) communication_log_P(LEVEL_INFO, PSTR("  -> pose.x: %.3f, pose.y: %.3f"), pose_latched.x, pose_latched.y);
 }
 
 /*void correctPose(Direction_t direction, float correctionValue){
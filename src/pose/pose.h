@@ -5,18 +5,60 @@
 #include "stdint.h"
 
 
+//#define MM_PER_TICK (0.140845070422535f)
+#define MM_PER_TICK (45.0f*M_PI/1024.0f)
+
 // robot's pose
 extern float thetaTemp;
 extern Pose_t pose;
 extern Pose_t * pose_Temp;
 bool checkAprilPose;
 
+/**
+ * @returns in der Regelungsebene die laufende Pose, in der Hauptschleife die am Anfang des Durchlaufs übernommene
+ *          (pose_latch()), damit sie sich während eines Durchlaufs nicht ändert
+*/
 extern Pose_t *getPose();
 
-void poseUpdate();
+/**
+ * Übernimmt die Pose der Regelungsebene für die Hauptschleife. Am Anfang jedes Durchlaufs aufrufen.
+*/
+void pose_latch();
+
+/**
+ * Odometrie, ein Regelschritt (driving/control.h)
+ *
+ * @param encoder1 Tics des rechten Rads seit dem letzten Schritt
+ * @param encoder2 Tics des linken Rads seit dem letzten Schritt
+*/
+void poseUpdate(int16_t encoder1, int16_t encoder2);
+
+/**
+ * Setzt die Strecke pro Encoder-Tic beider Räder (z.B. aus der Kalibrierung, siehe calibration.h).
+ * Default für beide Räder MM_PER_TICK.
+ *
+ * @param left mm pro Tic des linken Rads (encoder2)
+ * @param right mm pro Tic des rechten Rads (encoder1)
+*/
+void pose_setMmPerTick(float left, float right);
+
+/**
+ * @returns mm pro Tic des linken Rads (encoder2)
+*/
+float pose_getMmPerTick_left();
+
+/**
+ * @returns mm pro Tic des rechten Rads (encoder1)
+*/
+float pose_getMmPerTick_right();
 
 bool firstAprilTagUpdate();
 
+/**
+ * @returns Anzahl der bisher empfangenen AprilTag-Posen (ändert sich, sobald eine neue Pose übernommen wurde)
+*/
+uint16_t pose_getAprilTagCount();
+
 
 
 
@@ -30,10 +72,18 @@ ob wieder eine neue Pose vom AprilTag gesendet wurde und die Pose falls ja entsp
 void aktualisierePose();
 
 
-void poseUpdateAprilTag(const uint8_t* packet, __attribute__((unused)) const uint16_t size);
+void poseUpdateAprilTag(const uint8_t* packet, const uint16_t size);
 
-void requestAprilTagPose(GetPose_t * aprilTag);
+/**
+ * Fordert die AprilTag-Pose an (CH_OUT_GET_POSE)
+ *
+ * @returns Sequenznummer der Anfrage, vergleichbar mit ping_getAcceptedPoseSeq()
+*/
+uint8_t requestAprilTagPose(GetPose_t * aprilTag);
 
+/**
+ * Fordert alle 12s die AprilTag-Pose an, außer während eines Tasks oder der Kalibrierung
+*/
 void timeTask_RequestAprilTag();
 
 Direction_t pose_getCurrentCardinalDirection();
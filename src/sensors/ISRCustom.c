@@ -3,9 +3,14 @@
 
 #include "ISRCustom.h"
 
+#include <motor/motor.h>
+#include <tools/timeTask/timeTask.h>
+
 
 
 //init the values
+//Die ISRs zählen nur die Total-Zähler, die übrigen Zähler werden von latchSensors() (sensors.c)
+//einmal pro Durchlauf der Hauptschleife nachgeführt
 int16_t counter1Encoder = 0;
 int16_t counter2Encoder = 0;
 
@@ -13,6 +18,9 @@ int16_t counter2Encoder = 0;
 int16_t counter1EncoderBalancing = 0;
 int16_t counter2EncoderBalancing = 0;
 
+int16_t counter1EncoderTotal = 0;
+int16_t counter2EncoderTotal = 0;
+
 
 float encoder1MM = 0;
 float encoder2MM = 0;
@@ -21,6 +29,9 @@ uint16_t counter2Umdrehungen = 0;
 
 
 uint16_t counter1Bumper = 0;
+uint16_t counter1BumperTotal = 0;
+uint16_t bumperContactTime = (uint16_t)-BUMPER_DEBOUNCE_TIME; //erster Kontakt direkt nach dem Booten zählt
+volatile uint8_t bumperStop = 0;
 
 uint16_t bumper1Old = 0;
 uint8_t bumped = 0;
@@ -88,12 +99,10 @@ ISR(PCINT0_vect) {
     if (dir == 0) {
         //hier muss die Direction vertauscht werden, da wahrscheinlich die Aktuatoren falsch eingebaut sind!
         direction1 = 1;
-        counter1Encoder--;
-        counter1EncoderBalancing--;
+        counter1EncoderTotal--;
     } else {
         direction1 = 0;
-        counter1Encoder++;
-        counter1EncoderBalancing++;
+        counter1EncoderTotal++;
     }
 
     pin0OldB = currentValPB0;
@@ -112,12 +121,10 @@ ISR(PCINT1_vect) {
 
     if (dir == 0) {
         direction2 = 0;
-        counter2Encoder++;
-        counter2EncoderBalancing++;
+        counter2EncoderTotal++;
     } else {
         direction2 = 1;
-        counter2Encoder--;
-        counter2EncoderBalancing--;
+        counter2EncoderTotal--;
     }
 
     pin0OldJ = currentValPJ3;
@@ -125,7 +132,17 @@ ISR(PCINT1_vect) {
 }
 
 
+//Bumper: fallende Flanke an INT0 (PD0, Pull-Up => gedrückt ist LOW)
 ISR(INT0_vect) {
-    counter1Bumper++;
+    uint16_t now = timeTask_getUptime();
+
+    //entprellen: Taster muss noch gedrückt sein, Flanken kurz nach einem Kontakt gehören noch zu diesem
+    if ((PIND & (1 << PD0)) == 0 && (uint16_t)(now - bumperContactTime) >= BUMPER_DEBOUNCE_TIME) {
+        //Notstopp sofort, nicht erst in der Hauptschleife (bis zu einem Durchlauf später)
+        Motor_stopAll();
+        bumperStop = 1;
+        bumperContactTime = now;
+        counter1BumperTotal++;
+    }
 }
 
@@ -16,10 +16,20 @@ extern float encoder1MM;
 extern float encoder2MM;
 extern int16_t counter1EncoderBalancing;
 extern int16_t counter2EncoderBalancing;
+extern int16_t counter1EncoderTotal; //wird nie zurückgesetzt (Differenzen über Überlauf hinweg korrekt)
+extern int16_t counter2EncoderTotal;
 
 
 //Bumper 
-extern uint16_t counter1Bumper;
+/**
+ * Nach einem Kontakt werden für diese Zeit (ms) keine weiteren Kontakte gezählt (Prellen des Tasters)
+*/
+#define BUMPER_DEBOUNCE_TIME 300
+
+extern uint16_t counter1Bumper; //wird von latchSensors() aus counter1BumperTotal übernommen
+extern uint16_t counter1BumperTotal; //wird nur von der ISR gezählt (entprellte Kontakte)
+extern uint16_t bumperContactTime; //Uptime des letzten Kontakts in ms (von der ISR gesetzt)
+extern volatile uint8_t bumperStop; //Notstopp: von der ISR gesetzt, von checkBumped() zurückgesetzt
 //extern uint16_t counter2Bumper;
 extern uint16_t bumper1Old;
 //extern uint16_t bumper2Old;
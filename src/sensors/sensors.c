@@ -3,16 +3,59 @@
 
 #include "initSensors.h"
 #include "ISRCustom.h"
+#include "../telemetry/muxTelemetry.h"
+#include "../telemetry/ping.h"
+#include "../pose/pose.h"
 #include <communication/communication.h>
 #include <tools/timeTask/timeTask.h>
 
 #include <avr/io.h>       // AVR IO ports
 #include <stdint.h>  
+#include <stdlib.h>
 #include <io/adc/adc.h>
 #include <util/atomic.h>
 
 
 
+//----- Einlesen der Sensoren -----//
+static SensorInputs_t inputs = {0};
+
+void latchSensors() {
+    int16_t encoder1, encoder2;
+    uint16_t bumper;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        encoder1 = counter1EncoderTotal;
+        encoder2 = counter2EncoderTotal;
+        bumper = counter1BumperTotal;
+    }
+
+    //Tics seit dem letzten Durchlauf (relative Zähler, die Odometrie tastet die Encoder in der Regelungsebene selbst ab)
+    int16_t delta1 = encoder1 - inputs.encoder1Total;
+    int16_t delta2 = encoder2 - inputs.encoder2Total;
+    counter1Encoder = delta1;
+    counter2Encoder = delta2;
+    counter1EncoderBalancing += delta1;
+    counter2EncoderBalancing += delta2;
+    counter1Bumper = bumper;
+
+    inputs.encoder1Total = encoder1;
+    inputs.encoder2Total = encoder2;
+    inputs.bumperTotal = bumper;
+    for (uint8_t i = 0; i < SENSORS_INFRARED_COUNT; i++) {
+        inputs.infrared[i] = ADC_getFilteredValue(i);
+    }
+}
+
+const SensorInputs_t* getSensorInputs() {
+    return &inputs;
+}
+
+uint16_t getInfrared(uint8_t channel) {
+    return inputs.infrared[channel];
+}
+
+
+
 //----- Für das Balancing -----//
 void resetCounts() {
     counter1EncoderBalancing = 0;
@@ -43,12 +86,10 @@ void incrementBumped() {
 
 
 
-void getAndResetEncoders(int16_t* encoder1, int16_t* encoder2) {
+void getEncoderTotals(int16_t* encoder1, int16_t* encoder2) {
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        *encoder1 = counter1Encoder;
-        *encoder2 = counter2Encoder;
-        counter1Encoder = 0;
-        counter2Encoder = 0;
+        *encoder1 = counter1EncoderTotal;
+        *encoder2 = counter2EncoderTotal;
     }
 }
 
@@ -106,17 +147,48 @@ void initSensors(){
     initBumper();
 }
 
+static BumperContact_t bumperContact;
+static BumperCallback bumperCallback = NULL;
+
+void setBumperCallback(BumperCallback callback) {
+    bumperCallback = callback;
+}
+
+const BumperContact_t* getBumperContact() {
+    return &bumperContact;
+}
+
+bool isBumperStop() {
+    return bumperStop;
+}
+
 void checkBumped(){
-    TIMETASK(BUMPER_TASK, 800) {    
-            if (counter1Bumper - bumper1Old >= 10) {
-                bumped++;
-                bumper1Old = counter1Bumper;
-            }
+    uint16_t contacts = inputs.bumperTotal - bumper1Old;
+    if (contacts == 0) {
+        return;
+    }
+    bumped += contacts;
+    bumper1Old = inputs.bumperTotal;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        bumperContact.time = bumperContactTime;
+    }
+    bumperContact.pose = *getPose();
+
+    if (bumperCallback) {
+        bumperCallback();
+    }
+
+    //Notstopp aufheben, falls die ISR seit dem Einlesen keinen weiteren Kontakt gezählt hat
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (counter1BumperTotal == inputs.bumperTotal) {
+            bumperStop = 0;
         }
+    }
 }
 
 void updateTelemetry(){
-    TIMETASK(TELEMETRY_TASK, 300) { // execute block approximately every 300ms
+    if (communication_isChannelDue(CH_OUT_TELEMETRY)) { // execute block with the output rate of CH_OUT_TELEMETRY (default 300ms)
             // send telemetry data to HWPCS
             Telemetry_t telemetry;
             telemetry.bumpers.value = 0; // initialize with zero
@@ -124,11 +196,13 @@ void updateTelemetry(){
             telemetry.contacts = bumped;
             telemetry.encoder1 = getEncoderVal1();
             telemetry.encoder2 = getEncoderVal2();
-            telemetry.infrared1 = convertInfraredToMM(ADC_getFilteredValue(1)); //links
-            telemetry.infrared2 = convertInfraredToMM(ADC_getFilteredValue(0)); //rechts
-            telemetry.infrared3 = convertInfraredToMM(ADC_getFilteredValue(2)); //vorne
-            telemetry.user1 = 20;
-            telemetry.user2 = 42.42f;
-            communication_writePacket(CH_OUT_TELEMETRY, (uint8_t*)&telemetry, sizeof(telemetry));
+            telemetry.infrared1 = convertInfraredToMM(getInfrared(1)); //links
+            telemetry.infrared2 = convertInfraredToMM(getInfrared(0)); //rechts
+            telemetry.infrared3 = convertInfraredToMM(getInfrared(2)); //vorne
+            telemetry.user1 = ping_getStats()->lost; // verlorene Pings
+            telemetry.user2 = ping_getAverage(); // durchschnittliche Umlaufzeit in ms
+            // Encoder und Infrarot sind evtl. schon im Multiplex-Frame enthalten
+            if (!muxTelemetry_covers(MUX_ENCODERS | MUX_INFRARED))
+                communication_writePacket(CH_OUT_TELEMETRY, (uint8_t*)&telemetry, sizeof(telemetry));
         }
 }
\ No newline at end of file
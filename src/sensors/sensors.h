@@ -1,7 +1,9 @@
 #ifndef SENSORS_H
 #define SENSORS_H
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <communication/packetTypes.h>
 
 //******************//
 /*
@@ -18,16 +20,56 @@ Bietet Funktionen für das Auslesen der Sensordaten an:
 
  Wie verwenden?
  - Am besten nicht auf ISRCustom und initSensors zugreifen, sondern alles über diese Schnittstelle machen
- - 
+ - latchSensors() am Anfang jedes Durchlaufs der Hauptschleife aufrufen: Encoder, Bumper und Infrarot
+   werden dort einmal eingelesen, alle Getter liefern danach bis zum nächsten Durchlauf dieselben Werte
+   (damit ein Durchlauf nur von seinen Eingaben abhängt, siehe telemetry/record.h)
+
+Bumper: die ISR (INT0) zählt nur entprellte Kontakte und hält die Motoren sofort an (Motor_stopAll()), bis
+checkBumped() den Kontakt im nächsten Durchlauf übernommen hat (Uptime und Pose merken, Callback aufrufen, z.B. den
+Explorer zurücksetzen und neu planen lassen). Solange gibt setMotorPWM() keine PWM an die Motoren weiter.
 */
 //******************//
 
-void resetCounts();
+#define SENSORS_INFRARED_COUNT 3
+
+/**
+ * Eingaben der Sensoren, wie sie von latchSensors() eingelesen wurden
+*/
+typedef struct {
+    int16_t encoder1Total; //Zählerstände der ISRs (laufen über)
+    int16_t encoder2Total;
+    uint16_t bumperTotal;
+    uint16_t infrared[SENSORS_INFRARED_COUNT]; //gefilterte ADC-Werte, Index wie ADC-Kanal (0: rechts, 1: links, 2: vorne)
+} SensorInputs_t;
+
+/**
+ * Liest Encoder, Bumper und Infrarot für den aktuellen Durchlauf der Hauptschleife ein
+*/
+void latchSensors();
 
+/**
+ * Gibt die zuletzt von latchSensors() eingelesenen Werte zurück
+*/
+const SensorInputs_t* getSensorInputs();
+
+/**
+ * Gibt den eingelesenen gefilterten ADC-Wert eines Infrarotsensors zurück
+ *
+ * @param channel ADC-Kanal (0: rechts, 1: links, 2: vorne)
+*/
+uint16_t getInfrared(uint8_t channel);
 
+void resetCounts();
 
-void getAndResetEncoders(int16_t* encoder1, int16_t* encoder2);
+/**
+ * Gibt die Encoder-Zählerstände seit dem Start zurück (werden nie zurückgesetzt, laufen über).
+ * Differenzen zweier Aufrufe ergeben die Tics dazwischen.
+*/
+void getEncoderTotals(int16_t* encoder1, int16_t* encoder2);
 
+/**
+ * @returns Tics des rechten (getEncoderVal1()) bzw. linken Rads (getEncoderVal2()) seit dem letzten Durchlauf
+*/
 int16_t getEncoderVal1();
 
 int16_t getEncoderVal2();
@@ -62,7 +104,36 @@ void setEncoder2MM(float val);
 void initSensors();
 
 /**
- * Enthält einen Timetask, welcher regelmäßig überprüft, ob eine Kollision aufgetreten ist
+ * Letzter Kontakt des Bumpers
+*/
+typedef struct {
+    uint16_t time; // Uptime des Kontakts in ms (aus der ISR)
+    Pose_t pose;   // Pose beim Übernehmen des Kontakts
+} BumperContact_t;
+
+typedef void (*BumperCallback)(void);
+
+/**
+ * Registriert den Callback, der bei einem neuen Kontakt aufgerufen wird (aus checkBumped(), Motoren stehen schon).
+ *
+ * @param callback aufzurufende Funktion, NULL: keine
+*/
+void setBumperCallback(BumperCallback callback);
+
+/**
+ * @returns letzter Kontakt (nur gültig, falls getBumperCount() > 0)
+*/
+const BumperContact_t* getBumperContact();
+
+/**
+ * @returns true, solange die ISR die Motoren wegen eines Kontakts angehalten hat und checkBumped() ihn noch nicht
+ *          übernommen hat
+*/
+bool isBumperStop();
+
+/**
+ * Übernimmt neue Kontakte des Bumpers (aus den eingelesenen Eingaben): Uptime und Pose merken, Callback aufrufen.
+ * Direkt nach latchSensors() aufrufen.
 */
 void checkBumped();
 
@@ -13,25 +13,25 @@
 //------------------------------------------------------------
 
 uint16_t getDistance_toWall_forward() {
-    if(!(convertInfraredToMM(ADC_getFilteredValue(2)) < 120)) {
+    if(!(convertInfraredToMM(getInfrared(2)) < 120)) {
         return -1;
     }
-    return convertInfraredToMM(ADC_getFilteredValue(2));
+    return convertInfraredToMM(getInfrared(2));
 }
 
 uint16_t getDistance_toWall_right() {
-    if(!(convertInfraredToMM(ADC_getFilteredValue(0)) < 120)) {
+    if(!(convertInfraredToMM(getInfrared(0)) < 120)) {
         return -1;
     }
 
-    return convertInfraredToMM(ADC_getFilteredValue(0));
+    return convertInfraredToMM(getInfrared(0));
 }
 
 uint16_t getDistance_toWall_left() {
-    if(!(convertInfraredToMM(ADC_getFilteredValue(1)) < 120)) {
+    if(!(convertInfraredToMM(getInfrared(1)) < 120)) {
         return -1;
     }
-    return convertInfraredToMM(ADC_getFilteredValue(1));
+    return convertInfraredToMM(getInfrared(1));
 }
 
 
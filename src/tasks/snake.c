@@ -38,6 +38,32 @@ Task* dequeue(Queue* queue) {
     return task;
 }
 
+// Funktion zum Anschauen des nächsten Elements, ohne es zu entfernen (peek)
+Task* peek(Queue* queue) {
+    if (queue->front == NULL) {
+        return NULL;
+    }
+    return queue->front->task;
+}
+
+// Funktion zum Entfernen eines Elements aus der Mitte der Schlange
+Task* removeAfter(Queue* queue, TaskNode* prev) {
+    if (prev == NULL) {
+        return dequeue(queue);
+    }
+    TaskNode* temp = prev->next;
+    if (temp == NULL) {
+        return NULL;
+    }
+    Task* task = temp->task;
+    prev->next = temp->next;
+    if (queue->rear == temp) {
+        queue->rear = prev;
+    }
+    free(temp);
+    return task;
+}
+
 bool isEmpty(Queue* queue) {
     if(queue->rear == NULL){
         return 1;
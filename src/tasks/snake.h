@@ -16,6 +16,7 @@ Bietet Funktionen für den Umgang mit der Schlange an:
  - createQueue(): erstellt eine neue Schlange (immer verwenden, wenn neue Schlange benutztwerden soll!!!)
  - enqueue(): Fügt der Schlange neuen Task hinzu
  - dequeue(): Holt aktuellen Task aus der Schlange und entfernt diesen
+ - removeAfter(): Entfernt einen Task aus der Mitte der Schlange
  - isEmpty(): Gibt an, ob die Schlange leer ist
  - queueSize(): Gibt an, wie viele Tasks sich momentan in der Schlange befinden
 */
@@ -76,6 +77,25 @@ void enqueue(Queue* queue, Task* task);
 */
 Task* dequeue(Queue* queue);
 
+/**
+ * Gibt den nächsten Task zurück, ohne ihn zu entfernen
+ * 
+ * @param queue zu verwendende Schlange
+ * 
+ * @returns Pointer auf nächsten Task, NULL falls die Schlange leer ist
+*/
+Task* peek(Queue* queue);
+
+/**
+ * Entfernt den Task nach dem übergebenen Knoten aus der Schlange
+ * 
+ * @param queue zu verwendende Schlange
+ * @param prev Knoten vor dem zu entfernenden Task, NULL: ältesten Task entfernen (wie dequeue())
+ * 
+ * @returns Pointer auf entfernten Task, NULL falls es keinen gibt
+*/
+Task* removeAfter(Queue* queue, TaskNode* prev);
+
 /**
  * Gibt an, ob die Schlange leer ist
  * 
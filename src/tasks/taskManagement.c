@@ -4,7 +4,10 @@
 #include "../explorer/labyrinthState.h"
 #include "../main.h"
 #include "../driving/driving.h"
+#include "../driving/motionProfile.h"
+#include "../driving/control.h"
 #include "../helper/mathHelper.h"
+#include "../sensors/sensors.h"
 
 #include <stdlib.h>
 #include <math.h>
@@ -23,7 +26,6 @@ static bool taskDone = 1;
 static bool taskStopped = 0;
 
 static bool poseCorrection = 0;
-static uint8_t poseCorrectionCounter = 0;
 
 static Direction_t currentDir = DIRECTION_NORTH;
 
@@ -37,6 +39,17 @@ static float angleTask_startAngle = 0;
 static uint8_t angleTask_flag = 0;
 static float angleTask_abortAngle = 0;
 
+//Für das vorausschauende Anhalten bei Angle Tasks
+static float angularRate = 0; //geglättete Drehrate aus den Encodern in rad/ms
+static int16_t angularRate_encoder1 = 0;
+static int16_t angularRate_encoder2 = 0;
+static uint16_t angularRate_time = 0;
+static float overshootCorrection[2] = {0.0f, 0.0f}; //gelernter Vorhalt in rad, 0: gegen, 1: im Uhrzeigersinn
+static bool overshoot_flag = 0; //1: Überschwingen der letzten Drehung wird gemessen, sobald der Roboter steht
+static uint16_t overshoot_time = 0;
+static float overshoot_startAngle = 0;
+static float overshoot_abortAngle = 0;
+
 //Für Distance Tasks
 static uint8_t distanceTask_flag = 0;
 static float distanceTask_startX = 0;
@@ -45,8 +58,41 @@ static uint16_t distanceTask_distanceValue = 0;
 
 //Für die Pause zwischen den Tasks
 static uint8_t timerBeforeNextTask_flag = 1;  //0: ausgeschalten / nicht abgelaufen, 1 (DEFAULT): abgelaufen, 2: counting
-static uint16_t timerBeforeNextTask_counter = 0;
-static uint16_t timerBeforeNextTask_time = 2000;
+static uint16_t timerBeforeNextTask_start = 0; //Uptime beim Beginn der Pause
+static uint16_t timerBeforeNextTask_time = 2000; //obere Grenze, falls der Roboter nicht zur Ruhe kommt
+
+//Für die Erkennung des Stillstands (nächster Task startet, sobald der Roboter ruht)
+static bool settleDetection = 1;
+static int16_t settle_encoder1 = 0;
+static int16_t settle_encoder2 = 0;
+static float settle_theta = 0;
+static uint16_t settle_since = 0; //Uptime der letzten Bewegung
+
+//Für das Überblenden in den nächsten Task (ohne Anhalten und ohne Pause)
+static bool taskBlending = 1;
+//in der Hauptschleife bestimmt (canBlend(), die Queue gehört der Hauptschleife), von der Regelungsebene verwendet
+static bool blendAhead = 0;   //nächster Task wird übernommen: beim Vollenden nicht anhalten und nicht bremsen
+
+//Ereignis der Regelungsebene: Abbruchbedingung erfüllt, wird in manageTasks() geloggt und bearbeitet
+typedef struct {
+    CancelType type;
+    bool blended;   //Motoren laufen weiter (blendAhead beim Vollenden)
+    float planned;  //geplante Strecke (mm) bzw. geplanter Winkel (rad)
+    float real;     //gefahrene Strecke bzw. gedrehter Winkel
+} TaskCompletion_t;
+static bool taskCompleted = 0;
+static TaskCompletion_t completion;
+
+//Für das Geschwindigkeitsprofil der COORDINATES- und ANGLE-Tasks
+static bool useMotionProfile = 1;
+static bool profileActive = 0;
+static MotionProfile_t profile;
+
+//Ereignis: Task beendet/übersprungen, Queue gestartet oder neuer Task => Queue sofort weiterschalten
+static bool advancePending = 0;
+
+//wird aufgerufen, wenn die Queue beim Weiterschalten leer ist
+static TasksFinishedCallback tasksFinishedCallback = NULL;
 
 
 //----- Debug- & Hilfsmethoden -----//
@@ -77,6 +123,38 @@ void setBreakTime(uint16_t breakTime){
     timerBeforeNextTask_time = breakTime;
 }
 
+uint16_t getBreakTime(){
+    return timerBeforeNextTask_time;
+}
+
+void setSettleDetection(bool on){
+    settleDetection = on;
+}
+
+bool isSettleDetection(){
+    return settleDetection;
+}
+
+void setTaskBlending(bool on){
+    taskBlending = on;
+}
+
+bool isTaskBlending(){
+    return taskBlending;
+}
+
+void setMotionProfile(bool on){
+    useMotionProfile = on;
+}
+
+bool isMotionProfile(){
+    return useMotionProfile;
+}
+
+void setTasksFinishedCallback(TasksFinishedCallback callback){
+    tasksFinishedCallback = callback;
+}
+
 void setPoseCorrection(bool on){
     poseCorrection = on;
 }
@@ -92,18 +170,22 @@ void logVariables(){
 void init_durationTask(uint16_t duration){
     if(logQueue) communication_log_P(LEVEL_INFO, PSTR(""));
     if(logQueue) communication_log_P(LEVEL_INFO, PSTR("----- init_durationTask. duration:%i -----"));
+    control_lock();
     timedTask_time = duration;
 
     timedTask_flag = 1;
+    control_unlock();
 }
 
 void init_distanceTask(uint16_t distance){
     if(logQueue) communication_log_P(LEVEL_INFO, PSTR(""));
     if(logQueue) communication_log_P(LEVEL_INFO, PSTR("----- init_distanceTask. distance:%i -----"), distance);
 
+    control_lock();
     distanceTask_distanceValue = distance;
 
     distanceTask_flag = 1;
+    control_unlock();
 }
 
 void init_angleTask(float angle){
@@ -120,9 +202,11 @@ void init_angleTask(float angle){
         communication_log(LEVEL_SEVERE, "!!! Falsches Argument als Winkel übergeben !!!");
     }
 
+    control_lock();
     angleTask_abortAngle = deltaAngle;
 
     angleTask_flag = 1;
+    control_unlock();
 }
 
 /**
@@ -170,16 +254,21 @@ void startNextTask() {
     //free(currentTask);
 }
 
+/**
+ * Task ist vollendet (Abbruchbedingung erfüllt): Queue im selben Durchlauf weiterschalten
+*/
+static void finishTask() {
+    taskDone = 1;
+    advancePending = 1;
+}
 
 
-void stopCurrentTask() {
-    if(logQueue) communication_log_P(LEVEL_INFO, PSTR(""));
-    if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  -- stopCurrentTask --"));
-    
-    if(hasCurrentTask()){
-        stopDrive();
-    }
 
+/**
+ * Setzt die Abbruchbedingungen des momentanen Tasks zurück
+*/
+static void resetCancelConditions() {
+    control_lock();
     timedTask_time = 0;
     timedTask_flag = 0;
     timedTask_counter = 0;
@@ -193,8 +282,317 @@ void stopCurrentTask() {
     distanceTask_startY = 0;
     distanceTask_distanceValue = 0;
 
+    profileActive = 0;
+    taskCompleted = 0; //noch nicht bearbeitetes Vollenden verwerfen (z.B. nach abortTasks())
+    control_unlock();
+
     timerBeforeNextTask_flag = 1;
-    timerBeforeNextTask_counter = 0;
+}
+
+void stopCurrentTask() {
+    if(logQueue) communication_log_P(LEVEL_INFO, PSTR(""));
+    if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  -- stopCurrentTask --"));
+    
+    if(hasCurrentTask()){
+        stopDrive();
+    }
+
+    resetCancelConditions();
+}
+
+static bool isDriveForward(Task* task) {
+    return task->startMethod == getMethod_driveForward() || task->startMethod == getMethod_driveForward_withFixedValue();
+}
+
+/**
+ * Prüft, ob der nächste Task ohne Anhalten übernommen werden kann: Vorwärtsfahrt -> Vorwärtsfahrt in dieselbe
+ * Kardinalrichtung. Drehungen beginnen immer aus dem Stand (auf der Stelle in der Kachelmitte, damit der Roboter
+ * im Raster bleibt).
+*/
+static bool canBlend() {
+    if(!taskBlending || !queue_iterating || skip || !hasCurrentTask()){
+        return 0;
+    }
+    Task* current = getCurrentTask();
+    Task* next = peekTask();
+    if(next == NULL || !isDriveForward(current) || !isDriveForward(next)){
+        return 0;
+    }
+    return next->startParameters->direction == current->startParameters->direction;
+}
+
+static bool isTileMove(Task* task) {
+    return isDriveForward(task) && task->cancelParameters->type == COORDINATES;
+}
+
+static bool isRotation(Task* task) {
+    return task->cancelParameters->type == ANGLE;
+}
+
+/**
+ * Gibt einen aus der Queue entfernten Task frei
+*/
+static void freeTask(Task* task) {
+    free(task->startParameters);
+    free(task->cancelParameters);
+    free(task);
+}
+
+/**
+ * @returns Ausrichtung des Roboters nach dem Task (heading: Ausrichtung vor dem Task)
+*/
+static float headingAfter(Task* task, float heading) {
+    if(isRotation(task)){
+        return task->cancelParameters->abortPar_1;
+    }
+    if(isDriveForward(task)){
+        return getAngle_forCardinalDirection(task->startParameters->direction);
+    }
+    return heading;
+}
+
+/**
+ * Schätzt die Drehrate aus den Encoder-Deltas (alle ANGULAR_RATE_INTERVAL ms, geglättet mit ANGULAR_RATE_ALPHA),
+ * Regelungsebene
+ *
+ * @param reset 1: Schätzung neu beginnen (Roboter steht)
+*/
+static void updateAngularRate(uint16_t uptime, bool reset) {
+    const ControlInputs_t* inputs = control_getInputs();
+    uint16_t dt = uptime - angularRate_time;
+    if(!reset && dt < ANGULAR_RATE_INTERVAL){
+        return;
+    }
+    if(reset){
+        angularRate = 0.0f;
+    } else {
+        int16_t deltaRight = inputs->encoder1Total - angularRate_encoder1; //Differenzen über Überlauf hinweg korrekt
+        int16_t deltaLeft = inputs->encoder2Total - angularRate_encoder2;
+        float rate = (deltaRight * pose_getMmPerTick_right() - deltaLeft * pose_getMmPerTick_left()) / achsenlaenge / dt;
+        angularRate += ANGULAR_RATE_ALPHA * (rate - angularRate);
+    }
+    angularRate_encoder1 = inputs->encoder1Total;
+    angularRate_encoder2 = inputs->encoder2Total;
+    angularRate_time = uptime;
+}
+
+/**
+ * Misst, wie weit die letzte Drehung über das Ziel hinaus (bzw. zu kurz) gegangen ist, und passt den Vorhalt
+ * für diese Drehrichtung an
+*/
+static void learnOvershoot() {
+    control_lock();
+    bool measure = overshoot_flag;
+    overshoot_flag = 0;
+    float startAngle = overshoot_startAngle;
+    float abortAngle = overshoot_abortAngle;
+    control_unlock();
+    if(!measure){
+        return;
+    }
+
+    uint8_t dir = abortAngle < 0.0f;
+    float overshoot = fabs(angle_subtract(getPose()->theta, startAngle)) - fabs(abortAngle);
+    float correction = overshootCorrection[dir] + OVERSHOOT_LEARN_RATE * overshoot;
+    if(correction > OVERSHOOT_CORRECTION_MAX){
+        correction = OVERSHOOT_CORRECTION_MAX;
+    } else if(correction < -OVERSHOOT_CORRECTION_MAX){
+        correction = -OVERSHOOT_CORRECTION_MAX;
+    }
+    control_lock();
+    overshootCorrection[dir] = correction;
+    control_unlock();
+    if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Überschwingen: %.3f rad, Vorhalt %s: %.3f rad"), overshoot, dir ? "cw" : "ccw", correction);
+}
+
+/**
+ * Misst das Überschwingen spätestens OVERSHOOT_MEASURE_TIME ms nach dem Ende einer Drehung (Hauptschleife)
+*/
+static void check_overshoot() {
+    control_lock();
+    bool due = overshoot_flag && (uint16_t)(timeTask_getTaskUptime() - overshoot_time) >= OVERSHOOT_MEASURE_TIME;
+    control_unlock();
+    if(due){
+        learnOvershoot();
+    }
+}
+
+/**
+ * Startet den momentanen Task (nach der Pause bzw. beim Überblenden), Fahrten zu Koordinaten und Drehungen mit
+ * Geschwindigkeitsprofil
+ *
+ * @param initial momentane PWM (0: aus dem Stand)
+*/
+static void beginTask(uint16_t initial) {
+    Task* task = getCurrentTask();
+    learnOvershoot(); //Roboter steht (Pause vorbei)
+    bool useProfile = useMotionProfile && task != NULL && (isTileMove(task) || isRotation(task));
+    control_lock();
+    profileActive = 0;
+    if(useProfile){
+        motionProfile_start(&profile, timeTask_getTaskUptime(), task->startParameters->speed, initial, isRotation(task) ? PROFILE_DECEL_ROTATE : PROFILE_DECEL_DRIVE);
+    }
+    control_unlock();
+    initCurrentTask();
+    if(useProfile){
+        control_lock();
+        profileActive = 1;
+        setDriveSpeed(motionProfile_getSpeed(&profile, timeTask_getTaskUptime(), INFINITY));
+        control_unlock();
+    }
+}
+
+/**
+ * @returns verbleibende Strecke (mm) bzw. verbleibender Winkel (rad) des momentanen Tasks für das Geschwindigkeitsprofil
+ * (Regelungsebene)
+*/
+static float getRemaining() {
+    if(distanceTask_flag == 2){
+        //geht nahtlos in die nächste Fahrt in dieselbe Richtung über: nicht bremsen
+        if(blendAhead){
+            return INFINITY;
+        }
+        return distanceTask_distanceValue - getDistance(distanceTask_startX, distanceTask_startY, getPose()->x, getPose()->y);
+    }
+    if(angleTask_flag == 2){
+        return fabs(angleTask_abortAngle) - fabs(angle_subtract(getPose()->theta, angleTask_startAngle));
+    }
+    return INFINITY;
+}
+
+/**
+ * Ein Durchlauf von optimizeTaskQueue() über die wartenden Tasks
+ *
+ * @returns Anzahl der entfernten Tasks
+*/
+static uint8_t optimizeTaskQueue_pass() {
+    Queue* queue = getTaskQueue();
+    uint8_t removed = 0;
+
+    //Ausrichtung vor dem ersten wartenden Task: nach dem laufenden Task bzw. momentane Ausrichtung
+    float heading = getPose()->theta;
+    if(hasCurrentTask() && !taskDone){
+        heading = headingAfter(getCurrentTask(), heading);
+    }
+
+    TaskNode* prev = NULL;
+    TaskNode* node = queue->front;
+    while(node != NULL){
+        Task* task = node->task;
+        TaskNode* next = node->next;
+
+        if(isRotation(task) && next != NULL && isRotation(next->task)){
+            //Drehungen hintereinander (Zielwinkel absolut): nur die letzte zählt
+            freeTask(removeAfter(queue, prev));
+            removed++;
+            node = next;
+            continue;
+        }
+        if(isRotation(task) && fabs(angle_subtract(task->cancelParameters->abortPar_1, heading)) < ROTATION_NOOP_TOLERANCE){
+            //Drehung würde sofort wieder abgebrochen (siehe check_conditionalAbort())
+            freeTask(removeAfter(queue, prev));
+            removed++;
+            node = next;
+            continue;
+        }
+        if(isTileMove(task) && next != NULL && isTileMove(next->task) && next->task->startParameters->direction == task->startParameters->direction){
+            //Kachel-Fahrten in dieselbe Richtung: eine Fahrt bis zum Ziel der zweiten
+            task->cancelParameters->abortPar_1 = next->task->cancelParameters->abortPar_1;
+            task->cancelParameters->abortPar_2 = next->task->cancelParameters->abortPar_2;
+            freeTask(removeAfter(queue, node));
+            removed++;
+            continue;
+        }
+
+        heading = headingAfter(task, heading);
+        prev = node;
+        node = next;
+    }
+    return removed;
+}
+
+uint8_t optimizeTaskQueue() {
+    //nach dem Entfernen einer Drehung können die Tasks davor und danach zusammenpassen (z.B. [R,D,R,D]: die zweite
+    //Drehung entfällt, dann werden die Fahrten zusammengefasst), daher wiederholen, bis sich nichts mehr ändert
+    uint8_t removed = 0;
+    uint8_t passRemoved;
+    do {
+        passRemoved = optimizeTaskQueue_pass();
+        removed += passRemoved;
+    } while(passRemoved > 0);
+    return removed;
+}
+
+/**
+ * Abbruchbedingung des momentanen Tasks erfüllt (Regelungsebene): anhalten, außer der nächste Task wird übernommen
+ * (blendAhead, die Geschwindigkeit bleibt bis dahin). Geloggt und weitergeschaltet wird in check_taskCompleted().
+*/
+static void completeTask(CancelType type, float planned, float real) {
+    profileActive = 0;
+    if(!blendAhead){
+        stopDrive();
+    }
+    completion.type = type;
+    completion.blended = blendAhead;
+    completion.planned = planned;
+    completion.real = real;
+    taskCompleted = 1;
+}
+
+/**
+ * Bearbeitet einen in der Regelungsebene vollendeten Task: nächsten Task direkt übernehmen, falls kompatibel,
+ * ansonsten die Queue weiterschalten (mit Pause)
+*/
+static void check_taskCompleted() {
+    control_lock();
+    bool completed = taskCompleted;
+    taskCompleted = 0;
+    TaskCompletion_t info = completion;
+    control_unlock();
+    if(!completed){
+        return;
+    }
+
+    if(logQueue){
+        switch(info.type){
+            case DURATION:
+                communication_log_P(LEVEL_INFO, PSTR("  ->Timed Task vollendet"));
+                break;
+            case COORDINATES:
+                communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Distance Task vollendet. Differenz-geplant: %i, Differenz-real: %i"), (int)info.planned, (int)info.real);
+                break;
+            case ANGLE:
+                communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Angle Task vollendet. Differenz-geplant: %i, Differenz-real: %.3f"), (int)(info.planned*100), info.real);
+                break;
+            default:
+                break;
+        }
+    }
+
+    if(info.blended && canBlend()){
+        if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Nächster Task wird ohne Anhalten übernommen"));
+        uint16_t speed = abs(getSpeed_left());
+        resetCancelConditions();
+        startNextTask();
+        timerBeforeNextTask_flag = 1; //keine Pause
+        beginTask(speed);
+        taskStopped = 0;
+        return;
+    }
+    if(info.blended){
+        stopDrive(); //Queue hat sich seitdem geändert
+    }
+    finishTask();
+}
+
+/**
+ * Gibt der Regelungsebene vor, ob der momentane Task beim Vollenden überblendet wird
+*/
+static void updateBlending() {
+    bool blend = canBlend();
+    control_lock();
+    blendAhead = blend;
+    control_unlock();
 }
 
 
@@ -219,6 +617,7 @@ void unpauseTasks(){
     if(pause_forAprilTag) {
         communication_log_P(LEVEL_INFO, PSTR("  ->queue_iterating wird wieder auf 1 gesetzt"));
         queue_iterating = 1;
+        advancePending = 1; //evtl. während der Pause vollendeten Task weiterschalten
     }
 }
 
@@ -226,11 +625,31 @@ bool isTaskQueueIterating() {
     return queue_iterating;
 }
 
+float getTileMoveRemaining() {
+    if(!queue_iterating || !hasCurrentTask() || taskDone || !isTileMove(getCurrentTask())){
+        return -1.0f;
+    }
+    control_lock();
+    bool running = distanceTask_flag == 2;
+    float startX = distanceTask_startX;
+    float startY = distanceTask_startY;
+    uint16_t distanceValue = distanceTask_distanceValue;
+    control_unlock();
+    if(!running){
+        return -1.0f;
+    }
+    return distanceValue - getDistance(startX, startY, getPose()->x, getPose()->y);
+}
+
 void startQueue(Direction_t dir) {
     if(logQueue) communication_log_P(LEVEL_INFO, PSTR(""));
     communication_log_P(LEVEL_INFO, PSTR("----- startQueue. dir:%s -----"), cardStr(dir));
+    uint8_t removed = optimizeTaskQueue();
+    if(logQueue && removed) communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  %i Tasks zusammengefasst bzw. entfernt, Queue size: %i"), removed, getTaskQueueSize());
+
     queue_iterating = 1;
     currentDir = dir;
+    advancePending = 1;
 }
 
 void stopQueue() {
@@ -253,12 +672,14 @@ void addTask_task(Task* task){
     if(logQueue) communication_log_P(LEVEL_INFO, PSTR(""));
     if(logQueue) communication_log_P(LEVEL_INFO, PSTR("----- addTask_task -----"));
     addTaskToQueue(task);
+    advancePending = 1; //falls die Queue schon leer gelaufen ist
     if(logQueue) communication_log(LEVEL_FINE, "  ->Task hinzugefügt. Queue size: %i", getTaskQueueSize());
 }
 
 void skipTask(){
     if(queue_iterating == 1){
         skip = 1;
+        advancePending = 1;
     }
 }
 
@@ -274,6 +695,20 @@ void resetQueue(){
     setTaskQueue(createQueue());
 }
 
+void abortTasks(){
+    if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  -- abortTasks --"));
+
+    stopCurrentTask();
+    stopDrive(); //auch Fahrten ohne Task (z.B. User Commands)
+
+    Task* task;
+    while((task = dequeue(getTaskQueue())) != NULL){
+        freeTask(task);
+    }
+    skip = 0;
+    taskDone = 1;
+}
+
 void removeLastTask(){
     removeLastTaskInQueue();
 }
@@ -284,28 +719,40 @@ uint16_t getTaskQueueSize(){
 
 uint16_t queueIterationDebugCounter = 0;
 
+/**
+ * Schaltet die Queue weiter, wenn ein Ereignis anliegt (statt alle 150ms zu prüfen).
+ * Pro Durchlauf höchstens ein Ereignis, ein vom Callback ausgelöstes wird im nächsten Durchlauf bearbeitet.
+*/
 void check_queueIteration() {
-    TIMETASK(QUEUE_ITERATION_TASK, 150) {
-        if(queue_iterating == 1){ //Schlange soll iteriert werden
-            queueIterationDebugCounter++;
-            if(skip == 1 || taskDone == 1) { //Prüfen, ob Task gewechselt werden soll (entweder manuell oder cancelCondition)
+    if(!advancePending){
+        return;
+    }
+    advancePending = 0;
+
+    if(queue_iterating == 1){ //Schlange soll iteriert werden
+        queueIterationDebugCounter++;
+        if(skip == 1 || taskDone == 1) { //Prüfen, ob Task gewechselt werden soll (entweder manuell oder cancelCondition)
+            skip = 0;
+
+            if(!isQueueEmpty()) { //Queue hat neue Tasks
+                communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Nächster Task wird bearbeitet"));
 
-                if(!isQueueEmpty()) { //Queue hat neue Tasks
-                    communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Nächster Task wird bearbeitet"));
+                stopCurrentTask();
+                startNextTask();
 
+                taskStopped = 0;
+            } else { //Keine neuen Tasks verfügbar
+                if(queueIterationDebugCounter == 10){
+                    queueIterationDebugCounter = 0;
+                }
+                if(!taskStopped) {
+                    communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Keine neuen Tasks verfügbar"));
                     stopCurrentTask();
-                    startNextTask();
-
-                    taskStopped = 0;
-                } else { //Keine neuen Tasks verfügbar
-                    if(queueIterationDebugCounter == 10){
-                        queueIterationDebugCounter = 0;
-                    }
-                    if(!taskStopped) {
-                        communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Keine neuen Tasks verfügbar"));
-                        stopCurrentTask();
-                        taskStopped = 1;
-                    }
+                    taskStopped = 1;
+                }
+                //z.B. Explorer: nächsten Schritt sofort planen
+                if(tasksFinishedCallback){
+                    tasksFinishedCallback();
                 }
             }
         }
@@ -314,140 +761,184 @@ void check_queueIteration() {
 
 
 
-uint16_t debugCounter = 0;
-
 void check_conditionalAbort(){
-    TIMETASK(TIMED_TASK, 2) {
+    uint16_t uptime = control_getInputs()->uptime;
+
+    //----- Abort by Duration -----//
+    if(timedTask_flag == 2) {
+        timedTask_counter = timedTask_counter + 1;
+    }
+    if (timedTask_flag == 1) {
+        //Beim ersten Mal einschalten counter auf 0 zurücksetzen
+        timedTask_counter = 0;
+        timedTask_flag = 2;
+    } else if (timedTask_flag == 2 && timedTask_counter >= (timedTask_time / CONTROL_INTERVAL)) { //ein Schritt alle CONTROL_INTERVAL ms
+        timedTask_counter = 0;
+        timedTask_flag = 0;
+        completeTask(DURATION, timedTask_time, 0.0f);
+    }
 
-        //----- Abort by Duration -----//
-        if(timedTask_flag == 2) {
-            timedTask_counter = timedTask_counter + 1;
-        }
-        if(timedTask_counter % 1000 == 0 && timedTask_counter != 0){
-            if(logQueue){
-                communication_log_P(LEVEL_INFO, PSTR("  ->%i seconds passed"), timedTask_counter / 100);
-            }
-        }
-        if (timedTask_flag == 1) {
-            //Beim ersten Mal einschalten counter auf 0 zurücksetzen (Ist dies auch möglich, wenn nur im else if?)
-            if(logQueue){
-                communication_log_P(LEVEL_INFO, PSTR("  ->timedTask Flag auf 1, Timer wird gestellt"));
-            }
-            timedTask_counter = 0;
-            timedTask_flag = 2;
-        } else if (timedTask_flag == 2 && timedTask_counter == (timedTask_time / 10)) {
-            //if(timedTask != NULL){ //<- funktioniert nicht (deshalb parameter timedTaskNull eingeführt)
-            if(logQueue){
-                communication_log_P(LEVEL_INFO, PSTR("  ->Timed Task vollendet"));
-            }
-            stopDrive();
 
-            timedTask_counter = 0;
-            timedTask_flag = 0;
-            taskDone = 1;
+    
+    //----- Abort by Angle -----//
+    if(angleTask_flag == 1){
+        angleTask_startAngle = getPose()->theta;
+        angleTask_flag = 2;
+        startMeasuring_thetaDiff();
+        updateAngularRate(uptime, 1);
+    }
+    if(angleTask_flag == 2){
+        //Vorhalt: Winkel, um den sich der Roboter nach dem Anhalten noch weiterdreht (Drehrate * Nachlaufzeit + gelernt)
+        updateAngularRate(uptime, 0);
+        float stopLead = fabs(angularRate) * ANGLE_STOP_TIME + overshootCorrection[angleTask_abortAngle < 0.0f];
+        if(stopLead < 0.0f){
+            stopLead = 0.0f;
         }
 
+        //Er soll sich um 3,13 drehen 
+        //thetaDiff mehr als 3,13, 3,15 -> -3,13
+        float turned = fabs(angle_subtract(getPose()->theta, angleTask_startAngle));
+        if(turned > fabs(angleTask_abortAngle) -0.01f - stopLead){
+            angleTask_flag = 0;
 
-        
-        //----- Abort by Angle -----//
-        if(angleTask_flag == 1){
-            angleTask_startAngle = getPose()->theta;
-            angleTask_flag = 2;
-            startMeasuring_thetaDiff();
+            overshoot_flag = 1;
+            overshoot_time = uptime;
+            overshoot_startAngle = angleTask_startAngle;
+            overshoot_abortAngle = angleTask_abortAngle;
 
-            debugCounter = 0;
+            completeTask(ANGLE, angleTask_abortAngle, turned);
         }
-        if(angleTask_flag == 2){
-            if(logQueue) debugCounter++;
-
-            if(debugCounter == 1000){
-                debugCounter = 0;
-                if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement  Startwinkel: %i, Zielwinkel: %i, Momentanwinkel: %i, Winkeldiff: %.3f"), (int)(angleTask_startAngle*100), (int)(angleTask_abortAngle*100), (int)(getPose()->theta*100), fabs(angle_subtract(getPose()->theta, angleTask_startAngle)));
-            }
+    }
 
-            //Er soll sich um 3,13 drehen 
-            //thetaDiff mehr als 3,13, 3,15 -> -3,13
-            if(fabs(angle_subtract(getPose()->theta, angleTask_startAngle)) > fabs(angleTask_abortAngle) -0.01f){
-                if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Angle Task vollendet. Differenz-geplant: %i, Differenz-real: %.3f"), (int)(angleTask_abortAngle*100), fabs(angle_subtract(getPose()->theta, angleTask_startAngle)));
 
-                angleTask_flag = 0;
+    //----- Abort by Distance -----//
+    if(distanceTask_flag == 1){
+        distanceTask_startX = getPose()->x;
+        distanceTask_startY = getPose()->y;
+        distanceTask_flag = 2;
+        startMeasuring_distDiff();
+    }
+    if(distanceTask_flag == 2) {
+        float distance = getDistance(distanceTask_startX, distanceTask_startY, getPose()->x, getPose()->y);
+        if(abs((int)distance) >= distanceTask_distanceValue) {
+            distanceTask_flag = 0;
 
-                stopDrive();
-                taskDone = 1;
-            }
+            completeTask(COORDINATES, distanceTask_distanceValue, distance);
         }
+    }
 
 
-        //----- Abort by Distance -----//
-        if(distanceTask_flag == 1){
-            distanceTask_startX = getPose()->x;
-            distanceTask_startY = getPose()->y;
-            distanceTask_flag = 2;
-            startMeasuring_distDiff();
-        }
-        if(distanceTask_flag == 2) {
-            //Für die Pose-Korrektur
-            poseCorrectionCounter++;
-            if(poseCorrection && poseCorrectionValue_withWalls() != -1 && switch_poseCorrection && poseCorrectionCounter >= 100) {
-                poseCorrectionCounter = 0;
-                
-                float poseCorrectionValue = 0.0f;
-                switch(currentDir){
-                    case DIRECTION_NORTH:
-                    case DIRECTION_SOUTH:
-                        poseCorrectionValue = getTile_x(robot_getColumn()) - poseCorrectionValue_withWalls();
-                        break;
-                    case DIRECTION_EAST:
-                    case DIRECTION_WEST:
-                        poseCorrectionValue = getTile_y(robot_getRow()) - poseCorrectionValue_withWalls();
-                        break;
-                }
-                
-                if(logPoseCorrection) communication_log_P(LEVEL_INFO, PSTR("  -> !! Pose-Korrektur. currentDir: %s, poseCorrectionValue: %.3f !!"), cardStr(currentDir), poseCorrectionValue);
-                correctPose(currentDir, poseCorrectionValue);
-            }
-
-            if(logQueue) debugCounter++;
+    //----- Geschwindigkeitsprofil -----//
+    if(profileActive){
+        setDriveSpeed(motionProfile_getSpeed(&profile, uptime, getRemaining()));
+    }
+}
 
-            if(debugCounter == 1000){
-                debugCounter = 0;
-                if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement  Zieldistanz: %i, Momentandistanz: %i, DistDiff: %i"), distanceTask_distanceValue, (int)getDistance(distanceTask_startX, distanceTask_startY, getPose()->x, getPose()->y), abs((int)getDistDiff()));
+/**
+ * Korrigiert während einer Fahrt die Pose anhand der Wände (Hauptschleife, braucht die Infrarotsensoren)
+*/
+static void check_poseCorrection() {
+    TIMETASK(POSE_CORRECTION_TASK, 200) {
+        if(distanceTask_flag == 2 && poseCorrection && switch_poseCorrection && poseCorrectionValue_withWalls() != -1) {
+            float poseCorrectionValue = 0.0f;
+            switch(currentDir){
+                case DIRECTION_NORTH:
+                case DIRECTION_SOUTH:
+                    poseCorrectionValue = getTile_x(robot_getColumn()) - poseCorrectionValue_withWalls();
+                    break;
+                case DIRECTION_EAST:
+                case DIRECTION_WEST:
+                    poseCorrectionValue = getTile_y(robot_getRow()) - poseCorrectionValue_withWalls();
+                    break;
             }
+            
+            if(logPoseCorrection) communication_log_P(LEVEL_INFO, PSTR("  -> !! Pose-Korrektur. currentDir: %s, poseCorrectionValue: %.3f !!"), cardStr(currentDir), poseCorrectionValue);
+            correctPose(currentDir, poseCorrectionValue);
+        }
+    }
+}
 
-            if(abs((int)getDistance(distanceTask_startX, distanceTask_startY, getPose()->x, getPose()->y)) >= distanceTask_distanceValue) {
-                if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Distance Task vollendet. Differenz-geplant: %i, Differenz-real: %i"), (int)distanceTask_distanceValue, (int)getDistance(distanceTask_startX, distanceTask_startY, getPose()->x, getPose()->y));
-
-                distanceTask_flag = 0;
-
-                stopDrive();
-
-                taskDone = 1;
-
-            }
+/**
+ * Loggt den Fortschritt des laufenden Tasks (logQueue, Hauptschleife)
+*/
+static void logTaskProgress() {
+    TIMETASK(TASK_PROGRESS_TASK, 2000) {
+        if(!logQueue){
+            return;
+        }
+        control_lock();
+        uint8_t timedFlag = timedTask_flag;
+        uint16_t timedCounter = timedTask_counter;
+        uint8_t angleFlag = angleTask_flag;
+        float startAngle = angleTask_startAngle;
+        float abortAngle = angleTask_abortAngle;
+        uint8_t distanceFlag = distanceTask_flag;
+        float startX = distanceTask_startX;
+        float startY = distanceTask_startY;
+        uint16_t distanceValue = distanceTask_distanceValue;
+        control_unlock();
+
+        if(timedFlag == 2){
+            communication_log_P(LEVEL_INFO, PSTR("  ->%i seconds passed"), timedCounter / (1000 / CONTROL_INTERVAL));
         }
+        if(angleFlag == 2){
+            communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement  Startwinkel: %i, Zielwinkel: %i, Momentanwinkel: %i, Winkeldiff: %.3f"), (int)(startAngle*100), (int)(abortAngle*100), (int)(getPose()->theta*100), fabs(angle_subtract(getPose()->theta, startAngle)));
+        }
+        if(distanceFlag == 2){
+            communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement  Zieldistanz: %i, Momentandistanz: %i, DistDiff: %i"), distanceValue, (int)getDistance(startX, startY, getPose()->x, getPose()->y), abs((int)getDistDiff()));
+        }
+    }
+}
+
+/**
+ * Prüft, ob der Roboter ruht: beide Encoder seit SETTLE_TIME ms unverändert und theta (auch nach einer
+ * Korrektur durch die April Tags) innerhalb von SETTLE_THETA_TOLERANCE
+*/
+static bool isSettled(uint16_t uptime){
+    const SensorInputs_t* inputs = getSensorInputs();
+    float theta = getPose()->theta;
+
+    if(inputs->encoder1Total != settle_encoder1 || inputs->encoder2Total != settle_encoder2
+            || fabs(angle_subtract(theta, settle_theta)) > SETTLE_THETA_TOLERANCE){
+        settle_encoder1 = inputs->encoder1Total;
+        settle_encoder2 = inputs->encoder2Total;
+        settle_theta = theta;
+        settle_since = uptime;
+        return 0;
     }
+    return (uint16_t)(uptime - settle_since) >= SETTLE_TIME;
 }
 
 void check_breakBetweenTasks(){
-    TIMETASK(TIMERBEFORENEXTTASK_TASK, 100){
-        if(timerBeforeNextTask_flag == 0){
-            timerBeforeNextTask_counter = 0;
-            timerBeforeNextTask_flag = 2;
-        }
-        if(timerBeforeNextTask_flag == 2){
-            timerBeforeNextTask_counter++;
-            if(timerBeforeNextTask_counter == (timerBeforeNextTask_time / 100)){
-                timerBeforeNextTask_flag = 1;
-                initCurrentTask();
-            }
+    uint16_t uptime = timeTask_getTaskUptime();
+    if(timerBeforeNextTask_flag == 0){
+        timerBeforeNextTask_start = uptime;
+        timerBeforeNextTask_flag = 2;
+        isSettled(uptime); //Referenz für den Stillstand setzen
+    }
+    if(timerBeforeNextTask_flag == 2){
+        //Pause auf die ms genau (unsigned-Vergleich wie bei TIMETASK robust gegen Überlauf der Uptime)
+        uint16_t elapsed = uptime - timerBeforeNextTask_start;
+        bool settled = settleDetection && isSettled(uptime);
+        if(settled || elapsed >= timerBeforeNextTask_time){
+            if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  ->TaskManagement:  Pause nach %u ms beendet (%s)"), elapsed, settled ? "Stillstand" : "Zeit");
+            timerBeforeNextTask_flag = 1;
+            beginTask(0);
         }
     }
 }
 
 void manageTasks() {
+    //vollendeter Task (check_conditionalAbort() in der Regelungsebene) => loggen und nächsten Task im selben Durchlauf
+    //starten (bei Pause 0 auch gleich losfahren)
+    check_taskCompleted();
+    check_overshoot();
+    check_poseCorrection();
+    logTaskProgress();
     check_queueIteration();
     check_breakBetweenTasks();
-    check_conditionalAbort();
+    //Queue kann sich geändert haben
+    updateBlending();
 }
 
 
@@ -499,6 +990,25 @@ void enqueue_rotateToCardinalDirection(uint16_t speed, Direction_t dir){
     
 }
 
+/**
+ * @returns letzte Kachel-Fahrt der wartenden Tasks (bzw. der laufende Task), nach der nur noch Drehungen folgen.
+ * NULL, falls keine vorhanden oder danach eine andere Fahrt folgt (Position dann unbekannt)
+*/
+static Task* getLastTileMove() {
+    Task* last = NULL;
+    if(hasCurrentTask() && !taskDone && isTileMove(getCurrentTask())){
+        last = getCurrentTask();
+    }
+    for(TaskNode* node = getTaskQueue()->front; node != NULL; node = node->next){
+        if(isTileMove(node->task)){
+            last = node->task;
+        } else if(!isRotation(node->task)){
+            last = NULL;
+        }
+    }
+    return last;
+}
+
 void enqueue_moveForward_oneTile(uint16_t speed, Direction_t dir){
     if(logQueue) communication_log_P(LEVEL_INFO, PSTR(""));
     if(logQueue) communication_log_P(LEVEL_INFO, PSTR("----- enqueue_moveForward_oneTile. speed:%i, dir:%s -----"), speed, cardStr(dir));
@@ -508,32 +1018,48 @@ void enqueue_moveForward_oneTile(uint16_t speed, Direction_t dir){
     float tile_x = 0.0f;
     float tile_y = 0.0f;
 
-    if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  -> column: %i, row: %i"), robot_getColumn(), robot_getRow());
+    uint16_t column = robot_getColumn();
+    uint16_t row = robot_getRow();
+    float pos_x = getPose()->x;
+    float pos_y = getPose()->y;
+
+    //Steht vor dieser Fahrt noch eine Kachel-Fahrt aus (ggf. gefolgt von Drehungen, z.B. aus robot_move()), beginnt
+    //die Kachel an deren Ziel statt an der momentanen Position (gleiche Richtung: kann mit optimizeTaskQueue() zu
+    //einer längeren Fahrt zusammengefasst werden)
+    Task* last = getLastTileMove();
+    if(last != NULL){
+        pos_x = last->cancelParameters->abortPar_1;
+        pos_y = last->cancelParameters->abortPar_2;
+        column = round((int16_t)pos_x / LABY_CELLSIZE) + 4; //wie robot_getColumn()
+        row = -(int16_t)round((int16_t)pos_y / LABY_CELLSIZE) + 4; //wie robot_getRow()
+    }
+
+    if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  -> column: %i, row: %i"), column, row);
 
     switch(dir){
         case DIRECTION_NORTH:
-            fixedValue = getTile_x(robot_getColumn());
+            fixedValue = getTile_x(column);
 
-            tile_x = getPose()->x;
-            tile_y = getTile_y(robot_getRow() - 1);
+            tile_x = pos_x;
+            tile_y = getTile_y(row - 1);
             break;
         case DIRECTION_EAST:
-            fixedValue = getTile_y(robot_getRow());
+            fixedValue = getTile_y(row);
 
-            tile_x = getTile_x(robot_getColumn() + 1);
-            tile_y = getPose()->y;
+            tile_x = getTile_x(column + 1);
+            tile_y = pos_y;
             break;
         case DIRECTION_SOUTH:
-            fixedValue = getTile_x(robot_getColumn());
+            fixedValue = getTile_x(column);
 
-            tile_x = getPose()->x;
-            tile_y = getTile_y(robot_getRow() + 1);
+            tile_x = pos_x;
+            tile_y = getTile_y(row + 1);
             break;
         case DIRECTION_WEST:
-            fixedValue = getTile_y(robot_getRow());
+            fixedValue = getTile_y(row);
 
-            tile_x = getTile_x(robot_getColumn() - 1);
-            tile_y = getPose()->y;
+            tile_x = getTile_x(column - 1);
+            tile_y = pos_y;
             break;
     }
     if(logQueue) communication_log_P(LEVEL_INFO, PSTR("  -> fixedValue: %i"), (int)fixedValue);
@@ -546,4 +1072,17 @@ void enqueue_moveForward_oneTile(uint16_t speed, Direction_t dir){
             tile_y, 
             fixedValue
     ));
-}
\ No newline at end of file
+}
+
+void enqueue_backOff(uint16_t speed, float distance){
+    if(logQueue) communication_log_P(LEVEL_INFO, PSTR(""));
+    if(logQueue) communication_log_P(LEVEL_INFO, PSTR("----- enqueue_backOff. speed:%i, distance:%i -----"), speed, (int)distance);
+
+    //Ziel: distance mm entgegen der momentanen Ausrichtung
+    float x = getPose()->x - distance * cos(getPose()->theta);
+    float y = getPose()->y - distance * sin(getPose()->theta);
+
+    Parameters *pars = createParameters(pose_getCurrentCardinalDirection(), speed, 0);
+    CancelParameters *cancelPars = createCancelParameters(COORDINATES, x, y);
+    addTask_task(createTask(getMethod_driveBackwards(), cancelPars, pars));
+}
@@ -19,11 +19,119 @@ Kümmert sich um:
 - Pause zwischen dem Ausführen der einzelnen Tasks
 - das bedingte Abbrechen eines Tasks (nach einer Zeit, Distanz, Winkel, ...)
 
+Die Queue wird ereignisgesteuert weitergeschaltet: sobald ein Task vollendet oder übersprungen wird, die Queue
+gestartet oder ein Task hinzugefügt wird, startet manageTasks() im selben Durchlauf den nächsten Task. Die Zeit
+zwischen zwei Tasks ist damit höchstens die Pause (setBreakTime()). Läuft die Queue leer, wird der mit
+setTasksFinishedCallback() registrierte Callback aufgerufen.
+
+Die Pause endet vorzeitig, sobald der Roboter ruht (beide Encoder seit SETTLE_TIME ms unverändert, theta
+stabil). Die feste Pause ist dann nur noch die obere Grenze (User Command 49 schaltet die Erkennung aus/ein).
+
+Ist beim Erreichen der Abbruchbedingung einer Vorwärtsfahrt der nächste Task eine Vorwärtsfahrt in dieselbe
+Richtung, wird er ohne Anhalten, ohne Bremsen und ohne Pause übernommen, ein gerader Gang wird so in einem Zug
+durchfahren (User Command 50 schaltet das Überblenden aus/ein). Drehungen werden nicht überblendet: sie beginnen
+immer aus dem Stand in der Kachelmitte, damit der Roboter im Raster bleibt. Der nächste Task muss vor dem Erreichen
+der Abbruchbedingung in der Queue stehen: der Explorer reiht im Gang die nächste Kachel kurz vor der Kachelmitte ein
+(getTileMoveRemaining(), siehe explorer.h).
+
+Fahrten zu Koordinaten und Drehungen folgen einem Geschwindigkeitsprofil (motionProfile.h): Beschleunigen,
+Reisegeschwindigkeit (speed des Tasks) und Bremsen aus der verbleibenden Strecke bzw. dem verbleibenden Winkel.
+Die PWM wird in check_conditionalAbort() nachgeführt (User Command 51 schaltet das Profil aus/ein).
+
+check_conditionalAbort() läuft in der Regelungsebene (driving/control.h), manageTasks() in der Hauptschleife. Die
+Regelungsebene hält beim Vollenden nur an (bzw. hält die Geschwindigkeit, falls überblendet wird) und setzt ein Flag,
+alles Weitere (Loggen, Queue, Überblenden, Lernen des Vorhalts) passiert in manageTasks().
 */
 //******************//
 
+/**
+ * So lange (ms) müssen beide Encoder unverändert sein, damit der Roboter als ruhend gilt
+*/
+#define SETTLE_TIME 150
+
+/**
+ * Maximale Änderung von theta (rad) während SETTLE_TIME
+*/
+#define SETTLE_THETA_TOLERANCE 0.005f
+
+/**
+ * Setzt die Pause zwischen zwei Tasks
+ *
+ * @param breakTime längste Pause in ms (0: nächster Task startet sofort)
+*/
 void setBreakTime(uint16_t breakTime);
 
+/**
+ * @returns längste Pause zwischen zwei Tasks in ms
+*/
+uint16_t getBreakTime();
+
+/**
+ * Schaltet die Erkennung des Stillstands ein oder aus (aus: immer die volle Pause)
+*/
+void setSettleDetection(bool on);
+
+bool isSettleDetection();
+
+/**
+ * Schaltet das Überblenden in den nächsten Task ohne Anhalten ein oder aus
+*/
+void setTaskBlending(bool on);
+
+bool isTaskBlending();
+
+/**
+ * Schaltet das Geschwindigkeitsprofil für Fahrten zu Koordinaten und Drehungen ein oder aus
+ * (aus: sofort volle Geschwindigkeit, am Ziel hartes Anhalten)
+*/
+void setMotionProfile(bool on);
+
+bool isMotionProfile();
+
+/**
+ * Drehungen, deren Ziel weniger als das von der Ausrichtung abweicht (rad), werden von optimizeTaskQueue() entfernt
+ * (sie würden in check_conditionalAbort() sofort abgebrochen)
+*/
+#define ROTATION_NOOP_TOLERANCE 0.01f
+
+/**
+ * Vorausschauendes Anhalten bei Angle Tasks: die Drehung wird um den Winkel früher beendet, um den sich der Roboter
+ * nach dem Anhalten noch weiterdreht (Drehrate aus den Encodern * ANGLE_STOP_TIME + gelernter Vorhalt je Drehrichtung).
+ * Der Vorhalt wird nach jeder Drehung um OVERSHOOT_LEARN_RATE * (tatsächlicher - geplanter Winkel) angepasst,
+ * gemessen beim Start des nächsten Tasks bzw. spätestens OVERSHOOT_MEASURE_TIME ms nach dem Anhalten.
+*/
+#define ANGULAR_RATE_INTERVAL 20     // ms zwischen zwei Schätzungen der Drehrate
+#define ANGULAR_RATE_ALPHA 0.5f      // Glättung der Drehrate (1: keine)
+#define ANGLE_STOP_TIME 30.0f        // Nachlaufzeit der Drehung nach dem Anhalten in ms
+#define OVERSHOOT_LEARN_RATE 0.3f
+#define OVERSHOOT_CORRECTION_MAX 0.2f // rad
+#define OVERSHOOT_MEASURE_TIME 500   // ms
+
+/**
+ * Optimiert die wartenden Tasks (wird von startQueue() aufgerufen):
+ * - aufeinanderfolgende Drehungen werden zu einer Drehung auf den letzten Zielwinkel zusammengefasst
+ * - Drehungen auf die Ausrichtung, die der Roboter an dieser Stelle ohnehin hat, werden entfernt
+ * - aufeinanderfolgende Kachel-Fahrten (COORDINATES) in dieselbe Richtung werden zu einer Fahrt zusammengefasst
+ * Die Regeln werden wiederholt angewendet, bis sich nichts mehr ändert.
+ *
+ * @returns Anzahl der entfernten Tasks
+*/
+uint8_t optimizeTaskQueue();
+
+/**
+ * Callback, wenn die Queue leer gelaufen ist
+*/
+typedef void (*TasksFinishedCallback)(void);
+
+/**
+ * Registriert den Callback, der aufgerufen wird, wenn beim Weiterschalten keine Tasks mehr in der Queue sind.
+ * Der Callback wird aus manageTasks() aufgerufen und darf neue Tasks hinzufügen bzw. die Queue starten,
+ * diese werden im nächsten Durchlauf gestartet.
+ *
+ * @param callback Callback oder NULL
+*/
+void setTasksFinishedCallback(TasksFinishedCallback callback);
+
 void setPoseCorrection(bool on);
 
 //----- Für die Probleme mit den April Tags folgende Methoden: -----//
@@ -43,6 +151,12 @@ void unpauseTasks();
 */
 bool isTaskQueueIterating();
 
+/**
+ * @returns verbleibende Strecke (mm) der laufenden Kachel-Fahrt bis zur Mitte der Zielkachel, negativ, falls gerade
+ * keine Kachel-Fahrt läuft
+*/
+float getTileMoveRemaining();
+
 
 
 /**
@@ -72,6 +186,12 @@ void addTask_task(Task *task);
 */
 void skipTask();
 
+/**
+ * Bricht den momentanen Task ab, hält den Roboter an und entfernt alle wartenden Tasks (z.B. nach einem Kontakt
+ * des Bumpers). Die Queue bleibt eingeschaltet, neu hinzugefügte Tasks werden sofort gestartet.
+*/
+void abortTasks();
+
 /**
  * Überschreibt die Task Queue
  * 
@@ -111,14 +231,34 @@ uint16_t getTaskQueueSize();
 void enqueue_rotateToCardinalDirection(uint16_t speed, Direction_t dir);
 
 /**
- * Lässt den Roboter eine Zelle nach vorne fahren
+ * Lässt den Roboter eine Zelle nach vorne fahren (ab dem Ziel einer noch ausstehenden Kachel-Fahrt, sonst ab der
+ * momentanen Position)
  * 
  * @param speed Fahrgeschwindigkeit
  * @param dir Richtung, in die nach vorne gefahren soll
 */
 void enqueue_moveForward_oneTile(uint16_t speed, Direction_t dir);
 
+/**
+ * Lässt den Roboter ein Stück entgegen seiner momentanen Ausrichtung zurücksetzen
+ *
+ * @param speed Fahrgeschwindigkeit
+ * @param distance Strecke in mm
+*/
+void enqueue_backOff(uint16_t speed, float distance);
+
 
+/**
+ * Prüft die Abbruchbedingung des laufenden Tasks und führt das Geschwindigkeitsprofil nach.
+ * Stufe der Regelungsebene (driving/control.h): loggt nicht, ein vollendeter Task wird in manageTasks() bearbeitet.
+*/
+void check_conditionalAbort();
+
+/**
+ * Bearbeitet und loggt in der Regelungsebene vollendete Tasks, schaltet die Queue weiter und startet nach der Pause
+ * den nächsten Task. Außerdem: Messung des Überschwingens, Pose-Korrektur an den Wänden und Fortschritt (logQueue).
+ * Einmal pro Durchlauf der Hauptschleife aufrufen.
+*/
 void manageTasks();
 
 #endif
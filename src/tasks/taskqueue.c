@@ -44,6 +44,10 @@ Task* nextTask(){
     return NULL;
 }
 
+Task* peekTask(){
+    return peek(getTaskQueue());
+}
+
 void initCurrentTask(){
     if(currentTask != NULL){
         communication_log_P(LEVEL_FINE, PSTR("taskqueue.c - initCurrentTask(): startTask"));
@@ -12,6 +12,7 @@ Bietet Funktionen für den Umgang mit der Schlange an:
  - getTaskQueue(): Gibt die Schlange zurück, welche verwaltet wird
  - getCurrentTask(): Gibt den momentanen Task zurück
  - nextTask(): Springt in der Schlange zum nächsten Task
+ - peekTask(): Gibt den nächsten Task zurück, ohne zu ihm zu springen
  - initCurrentTask(): Führt den momentanen Task aus
  - isQueueEmpty(): Gibt an, ob Schlange leer ist
  - addTaskToQueue(): Fügt der Schlange einen neuen Task hinzu
@@ -48,6 +49,13 @@ bool hasCurrentTask();
 */
 Task* nextTask();
 
+/**
+ * Gibt den nächsten Task in der Schlange zurück, ohne zu ihm zu springen.
+ * 
+ * @returns nächsten Task in der Schlange, NULL falls die Schlange leer ist
+*/
+Task* peekTask();
+
 /**
  * Führt den momentanen Task aus und kümmert sich um die Einzelheiten der Ausführung. (immer verwenden, nie Task händisch ausführen)
 */
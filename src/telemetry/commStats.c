@@ -0,0 +1,49 @@
+#include "commStats.h"
+
+#include <communication/communication.h>
+#include <tools/timeTask/timeTask.h>
+
+
+// maximale Größe des Pakets (Header und alle Kanäle)
+#define COMM_STATS_MAX_SIZE (sizeof(CommStats_t) + COMM_MAX_CHANNELS * sizeof(CommChannelStats_t))
+
+
+void checkCommStats() {
+    if (!communication_isChannelDue(CH_OUT_COMM_STATS))
+        return;
+
+    uint8_t packet[COMM_STATS_MAX_SIZE];
+    CommStats_t* header = (CommStats_t*)packet;
+    CommChannelStats_t* entry = (CommChannelStats_t*)(packet + sizeof(CommStats_t));
+
+    // Header: Zeitpunkt, Fehler und Wartezeit
+    timeTask_time_t now;
+    timeTask_getTimestamp(&now);
+    header->timestamp = now.time_ms;
+
+    CommHealth_t health;
+    communication_getHealth(&health);
+    for (uint8_t i = 0; i < COMM_ERR_COUNT; i++) {
+        header->errors[i] = health.errors[i];
+    }
+    header->txStalls = health.txStalls;
+    header->txStallTime = health.txStallTime;
+
+    // Kanäle mit Paketen in der Reihenfolge ihrer Nummern anhängen
+    header->channels = 0;
+    for (uint8_t channel = 0; channel < COMM_MAX_CHANNELS; channel++) {
+        ChannelStats_t stats;
+        communication_getChannelStats(channel, &stats);
+        if (!stats.sent && !stats.dropped && !stats.received)
+            continue;
+        header->channels |= (uint16_t)1 << channel;
+        entry->sent = stats.sent;
+        entry->dropped = stats.dropped;
+        entry->received = stats.received;
+        entry->sentBytes = stats.sentBytes;
+        entry->receivedBytes = stats.receivedBytes;
+        entry++;
+    }
+
+    communication_writePacket(CH_OUT_COMM_STATS, packet, (uint8_t*)entry - packet);
+}
@@ -0,0 +1,28 @@
+#ifndef COMMSTATS_H
+#define COMMSTATS_H
+
+//******************//
+/*
+Aufgabe:
+Sendet die Zähler der Kommunikation (communication_getHealth(), communication_getChannelStats()) als
+kompaktes Paket (CommStats_t mit CommChannelStats_t) auf CH_OUT_COMM_STATS: Anzahl jedes Fehlers
+(COMM_ERR_*), Wartezeit auf freien Platz im TX-Puffer sowie gesendete, verworfene und empfangene Pakete
+und Bytes pro Kanal. Kanäle ohne Pakete werden weggelassen.
+
+Die Zähler laufen seit dem Booten weiter, Raten ergeben sich aus der Differenz zweier Pakete (z.B. zur
+Wahl von Puffergrößen und Baudrate). User Command 43 setzt die Zähler zurück.
+
+Bietet folgende Funktionalitäten an:
+- checkCommStats(): Sendet die Zähler mit der Ausgaberate von CH_OUT_COMM_STATS (communication_setRate())
+
+ Wie verwenden?
+ - checkCommStats() in der Hauptschleife aufrufen
+*/
+//******************//
+
+/**
+ * Sendet die Zähler, falls laut communication_isChannelDue() fällig
+*/
+void checkCommStats();
+
+#endif
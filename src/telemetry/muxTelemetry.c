@@ -0,0 +1,93 @@
+#include "muxTelemetry.h"
+
+#include "../driving/driving.h"
+#include "../pose/pose.h"
+#include "../sensors/sensors.h"
+#include "../sensors/ISRCustom.h"
+#include "../tasks/taskManagement.h"
+
+#include <communication/communication.h>
+#include <pathFollower/pathFollower.h>
+#include <tools/timeTask/timeTask.h>
+
+#include <string.h>
+
+
+// maximale Größe des Frames (Header und alle Abschnitte)
+#define MUX_MAX_SIZE (sizeof(MuxTelemetry_t) + sizeof(Pose_t) + sizeof(MuxEncoders_t) + sizeof(MuxInfrared_t) \
+                      + sizeof(MuxPWM_t) + sizeof(MuxFollower_t) + sizeof(MuxQueue_t))
+
+// ausgewählte Abschnitte, 0: Frame abgeschaltet
+static uint8_t muxSections = 0;
+
+
+void muxTelemetry_setSections(uint8_t sections) {
+    muxSections = sections & MUX_ALL;
+}
+
+uint8_t muxTelemetry_getSections() {
+    return muxSections;
+}
+
+bool muxTelemetry_covers(uint8_t sections) {
+    return (muxSections & sections) == sections;
+}
+
+void sendMuxTelemetry() {
+    uint8_t frame[MUX_MAX_SIZE];
+    uint8_t* p = frame + sizeof(MuxTelemetry_t);
+
+    // Header: Zeitpunkt der Abtastung
+    timeTask_time_t now;
+    timeTask_getTimestamp(&now);
+    MuxTelemetry_t* header = (MuxTelemetry_t*)frame;
+    header->timestamp = now.time_ms;
+    header->sections = muxSections;
+
+    // Abschnitte in der Reihenfolge ihrer Bits anhängen
+    if (muxSections & MUX_POSE) {
+        memcpy(p, getPose(), sizeof(Pose_t));
+        p += sizeof(Pose_t);
+    }
+    if (muxSections & MUX_ENCODERS) {
+        MuxEncoders_t* encoders = (MuxEncoders_t*)p;
+        encoders->encoder1 = getEncoderVal1();
+        encoders->encoder2 = getEncoderVal2();
+        p += sizeof(MuxEncoders_t);
+    }
+    if (muxSections & MUX_INFRARED) {
+        MuxInfrared_t* infrared = (MuxInfrared_t*)p;
+        infrared->left = convertInfraredToMM(getInfrared(1));
+        infrared->right = convertInfraredToMM(getInfrared(0));
+        infrared->front = convertInfraredToMM(getInfrared(2));
+        p += sizeof(MuxInfrared_t);
+    }
+    if (muxSections & MUX_PWM) {
+        MuxPWM_t* pwm = (MuxPWM_t*)p;
+        pwm->left = getPWM_left();
+        pwm->right = getPWM_right();
+        p += sizeof(MuxPWM_t);
+    }
+    if (muxSections & MUX_FOLLOWER) {
+        const PathFollowerStatus_t* status = pathFollower_getStatus();
+        MuxFollower_t* follower = (MuxFollower_t*)p;
+        follower->enabled = status->enabled;
+        follower->lookahead = status->lookahead;
+        p += sizeof(MuxFollower_t);
+    }
+    if (muxSections & MUX_QUEUE) {
+        uint16_t size = getTaskQueueSize();
+        MuxQueue_t* queue = (MuxQueue_t*)p;
+        queue->size = size > 255 ? 255 : size;
+        queue->flags = (isTaskQueueIterating() ? 0x01 : 0) | (isTaskActive() ? 0x02 : 0);
+        p += sizeof(MuxQueue_t);
+    }
+
+    communication_writePacket(CH_OUT_MUX_TELEMETRY, frame, p - frame);
+}
+
+void checkMuxTelemetry() {
+    if (muxSections && communication_isChannelDue(CH_OUT_MUX_TELEMETRY)) {
+        sendMuxTelemetry();
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef MUXTELEMETRY_H
+#define MUXTELEMETRY_H
+
+#include <communication/packetTypes.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//******************//
+/*
+Aufgabe: 
+Sendet optional einen gemeinsamen Telemetrie-Frame (MuxTelemetry_t auf CH_OUT_MUX_TELEMETRY), der Pose,
+Encoder, Infrarot-Abstände, PWM der Motoren, Zustand des Path Followers und der Task-Queue zum selben
+Zeitpunkt abtastet. Der Overhead (Header, Prüfsumme, Delimiter) fällt so nur einmal an.
+
+Bietet folgende Funktionalitäten an:
+- muxTelemetry_setSections(): Wählt die Abschnitte des Frames aus (0: aus)
+- muxTelemetry_covers(): Gibt an, ob Abschnitte im Frame enthalten sind
+- checkMuxTelemetry(): Sendet den Frame mit der Ausgaberate von CH_OUT_MUX_TELEMETRY (communication_setRate())
+
+ Wie verwenden?
+ - checkMuxTelemetry() in der Hauptschleife aufrufen
+ - Einzelne Pakete (Pose, Telemetrie, Path Follower Status), deren Inhalt im Frame enthalten ist, werden
+   nicht mehr gesendet (muxTelemetry_covers() vor dem Senden prüfen). HWPCS zeigt diese dann nicht mehr an.
+*/
+//******************//
+
+/**
+ * Wählt die Abschnitte des Frames aus.
+ * 
+ * @param sections: Bitmaske aus MuxSection_t, 0 schaltet den Frame ab (Standard)
+*/
+void muxTelemetry_setSections(uint8_t sections);
+
+/**
+ * @returns Bitmaske der ausgewählten Abschnitte
+*/
+uint8_t muxTelemetry_getSections();
+
+/**
+ * @param sections: Bitmaske aus MuxSection_t
+ * 
+ * @returns true, falls alle angegebenen Abschnitte im Frame enthalten sind
+*/
+bool muxTelemetry_covers(uint8_t sections);
+
+/**
+ * Tastet alle ausgewählten Abschnitte ab und sendet sie als einen Frame
+*/
+void sendMuxTelemetry();
+
+/**
+ * Sendet den Frame, falls eingeschaltet und laut communication_isChannelDue() fällig
+*/
+void checkMuxTelemetry();
+
+#endif
@@ -0,0 +1,142 @@
+#include "ping.h"
+
+#include <communication/communication.h>
+#include <tools/timeTask/timeTask.h>
+
+
+static RttStats_t pingStats;
+static RttStats_t poseStats;
+
+// ausstehender Ping (nur einer gleichzeitig)
+static uint8_t pingSeq = 0;
+static bool pingOutstanding = false;
+static uint16_t pingSent = 0; // Uptime in ms
+
+// ausstehende Pose-Anfrage
+static uint8_t poseSeq = 0;
+static bool poseOutstanding = false;
+static uint16_t poseSent = 0; // Uptime in ms
+static timeTask_time_t poseTimestamp;
+static uint8_t poseSeqAccepted = 0; // Anfrage der zuletzt zugeordneten Antwort
+
+static bool poseSeqEnabled = false;
+
+
+static void addSample(RttStats_t* stats, uint32_t rtt) {
+    if (stats->count == UINT16_MAX || stats->sum + rtt < stats->sum)
+        return; // Statistik voll, ping_resetStats() aufrufen
+    if (stats->count == 0 || rtt < stats->min)
+        stats->min = rtt;
+    if (rtt > stats->max)
+        stats->max = rtt;
+    stats->sum += rtt;
+    stats->count++;
+}
+
+static void addLost(RttStats_t* stats) {
+    if (stats->lost < UINT16_MAX)
+        stats->lost++;
+}
+
+
+void commPing(const uint8_t* packet, const uint16_t size) {
+    if (size < sizeof(Ping_t))
+        return;
+    const Ping_t* ping = (const Ping_t*) packet;
+
+    if (!(ping->flags & PING_ECHO)) {
+        // Ping von HWPCS: unverändert als Echo zurückschicken
+        Ping_t echo = *ping;
+        echo.flags |= PING_ECHO;
+        communication_writePacket(CH_OUT_PING, (uint8_t*)&echo, sizeof(echo));
+        return;
+    }
+
+    // Echo eines eigenen Pings, verspätete Echos wurden schon als verloren gezählt
+    if (!pingOutstanding || ping->seq != pingSeq)
+        return;
+    timeTask_time_t sent = { ping->time_ms, ping->time_us };
+    timeTask_time_t now;
+    timeTask_getTimestamp(&now);
+    addSample(&pingStats, timeTask_getDuration(&sent, &now));
+    pingOutstanding = false;
+}
+
+void checkPing() {
+    uint16_t uptime = timeTask_getTaskUptime();
+
+    if (pingOutstanding && (uint16_t)(uptime - pingSent) > PING_TIMEOUT) {
+        addLost(&pingStats);
+        pingOutstanding = false;
+    }
+    if (poseOutstanding && (uint16_t)(uptime - poseSent) > PING_POSE_TIMEOUT) {
+        addLost(&poseStats);
+        poseOutstanding = false;
+    }
+
+    if (communication_isChannelDue(CH_OUT_PING)) {
+        if (pingOutstanding)
+            addLost(&pingStats);
+
+        timeTask_time_t now;
+        timeTask_getTimestamp(&now);
+        Ping_t ping = { 0, ++pingSeq, now.time_ms, now.time_us };
+        communication_writePacket(CH_OUT_PING, (uint8_t*)&ping, sizeof(ping));
+        pingOutstanding = true;
+        pingSent = uptime;
+    }
+}
+
+uint8_t ping_poseRequested() {
+    if (poseOutstanding)
+        addLost(&poseStats);
+    poseOutstanding = true;
+    poseSent = timeTask_getTaskUptime();
+    timeTask_getTimestamp(&poseTimestamp);
+    return ++poseSeq;
+}
+
+bool ping_poseReceived(const uint8_t* packet, const uint16_t size) {
+    if (!poseOutstanding)
+        return false; // unaufgeforderte oder verspätete Antwort
+    if (size >= sizeof(PoseSeq_t) && ((const PoseSeq_t*) packet)->seq != poseSeq)
+        return false; // Antwort auf eine ältere, schon als verloren gezählte Anfrage
+
+    timeTask_time_t now;
+    timeTask_getTimestamp(&now);
+    addSample(&poseStats, timeTask_getDuration(&poseTimestamp, &now));
+    poseOutstanding = false;
+    poseSeqAccepted = poseSeq;
+    return true;
+}
+
+uint8_t ping_getAcceptedPoseSeq() {
+    return poseSeqAccepted;
+}
+
+void ping_setPoseSeq(bool enable) {
+    poseSeqEnabled = enable;
+}
+
+bool ping_isPoseSeqEnabled() {
+    return poseSeqEnabled;
+}
+
+const RttStats_t* ping_getStats() {
+    return &pingStats;
+}
+
+const RttStats_t* ping_getPoseStats() {
+    return &poseStats;
+}
+
+float ping_getAverage() {
+    if (pingStats.count == 0)
+        return 0.0f;
+    return pingStats.sum / (float)pingStats.count / 1000.0f;
+}
+
+void ping_resetStats() {
+    pingStats = (RttStats_t) { 0 };
+    poseStats = (RttStats_t) { 0 };
+}
@@ -0,0 +1,121 @@
+#ifndef PING_H
+#define PING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//******************//
+/*
+Aufgabe:
+Misst die Umlaufzeit (Round Trip Time) und die Verluste der Verbindung zu HWPCS.
+- Ping: mit der Ausgaberate von CH_OUT_PING wird ein Ping_t (Sequenznummer und Zeitstempel von
+  timeTask_getTimestamp()) gesendet, HWPCS schickt es als Echo auf CH_IN_PING zurück. Ein Ping ohne Echo
+  bis zum nächsten Ping bzw. nach PING_TIMEOUT zählt als verloren.
+- Pose-Anfragen: die Zeit von GetPose_t bis zur Antwort auf CH_IN_POSE. Eine Anfrage ohne Antwort bis zur
+  nächsten Anfrage bzw. nach PING_POSE_TIMEOUT zählt als verloren. Optional (ping_setPoseSeq()) wird die
+  Anfrage mit Sequenznummer gesendet (GetPoseSeq_t), damit verspätete Antworten nicht einer neueren Anfrage
+  zugeordnet werden.
+- Pings von HWPCS auf CH_IN_PING werden als Echo auf CH_OUT_PING zurückgeschickt.
+
+Minimum/Durchschnitt/Maximum und Verluste werden laufend gezählt, über Telemetry_t gesendet (user1: verlorene
+Pings, user2: durchschnittliche Umlaufzeit der Pings in ms) und mit User Command 47 ausgegeben.
+
+Bietet folgende Funktionalitäten an:
+- commPing(): Callback für CH_IN_PING
+- checkPing(): Sendet den nächsten Ping, falls laut communication_isChannelDue() fällig
+- ping_poseRequested() / ping_poseReceived(): Messung der Pose-Anfragen (von pose.c aufgerufen)
+- ping_getAcceptedPoseSeq(): Zu welcher Anfrage gehört die zuletzt zugeordnete Antwort?
+- ping_getStats() / ping_getPoseStats() / ping_resetStats(): Statistik
+
+ Wie verwenden?
+ - commPing() als Callback für CH_IN_PING registrieren
+ - checkPing() in der Hauptschleife aufrufen, Abstand der Pings über die Ausgaberate von CH_OUT_PING
+   (communication_setRate(), abgeschaltet: keine Pings)
+*/
+//******************//
+
+/**
+ * Nach dieser Zeit (ms) ohne Echo zählt ein Ping als verloren
+*/
+#define PING_TIMEOUT 1000
+
+/**
+ * Nach dieser Zeit (ms) ohne Antwort zählt eine Pose-Anfrage als verloren
+*/
+#define PING_POSE_TIMEOUT 2000
+
+/**
+ * Umlaufzeiten und Verluste (Zeiten in us)
+*/
+typedef struct {
+    uint16_t count;   // beantwortete Pings bzw. Anfragen
+    uint16_t lost;    // verlorene Pings bzw. Anfragen
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;     // Summe für den Durchschnitt (sum / count)
+} RttStats_t;
+
+/**
+ * Callback für CH_IN_PING: Echo eines eigenen Pings auswerten bzw. Ping von HWPCS zurückschicken
+*/
+void commPing(const uint8_t* packet, const uint16_t size);
+
+/**
+ * Zählt ausstehende Pings nach PING_TIMEOUT als verloren und sendet den nächsten Ping, falls fällig
+*/
+void checkPing();
+
+/**
+ * Merkt sich den Zeitpunkt einer Pose-Anfrage (APRIL_TAG_MAIN). Direkt vor dem Senden aufrufen.
+ *
+ * @returns Sequenznummer der Anfrage (für GetPoseSeq_t)
+*/
+uint8_t ping_poseRequested();
+
+/**
+ * Wertet eine Antwort auf CH_IN_POSE aus (Pose_t oder PoseSeq_t).
+ *
+ * @returns true, falls die Antwort zur ausstehenden Anfrage gehört. false für unaufgeforderte, verspätete
+ * (schon als verloren gezählte) Antworten und Antworten auf ältere Anfragen. Nur für die Statistik und für
+ * ping_getAcceptedPoseSeq(), die Pose selbst wird trotzdem übernommen.
+*/
+bool ping_poseReceived(const uint8_t* packet, const uint16_t size);
+
+/**
+ * @returns Sequenznummer der Anfrage, der zuletzt eine Antwort zugeordnet wurde (ping_poseReceived() true, ohne
+ * GetPoseSeq_t die Anfrage, die beim Empfang ausstand)
+*/
+uint8_t ping_getAcceptedPoseSeq();
+
+/**
+ * Schaltet Pose-Anfragen mit Sequenznummer (GetPoseSeq_t) ein oder aus.
+ * Nur einschalten, wenn der Empfänger GetPoseSeq_t unterstützt (z.B. tools/hwpcs).
+*/
+void ping_setPoseSeq(bool enable);
+
+/**
+ * @returns true, falls Pose-Anfragen mit Sequenznummer gesendet werden
+*/
+bool ping_isPoseSeqEnabled();
+
+/**
+ * @returns Statistik der Pings
+*/
+const RttStats_t* ping_getStats();
+
+/**
+ * @returns Statistik der Pose-Anfragen
+*/
+const RttStats_t* ping_getPoseStats();
+
+/**
+ * @returns durchschnittliche Umlaufzeit der Pings in ms (0, solange kein Echo empfangen wurde)
+*/
+float ping_getAverage();
+
+/**
+ * Setzt beide Statistiken zurück
+*/
+void ping_resetStats();
+
+#endif
@@ -0,0 +1,131 @@
+#include "poseStream.h"
+
+#include "../pose/pose.h"
+
+#include <communication/communication.h>
+#include <tools/timeTask/timeTask.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+
+// Pose in Festkomma-Einheiten (0.1mm, 1mrad)
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int16_t theta;
+} QPose_t;
+
+static bool enabled = false;
+
+// zuletzt gesendeter, noch nicht bestätigter Keyframe
+static QPose_t pendingKeyframe;
+static uint8_t pendingSeq = 0;
+
+// zuletzt bestätigter Keyframe, auf den sich die Deltas beziehen
+static QPose_t reference;
+static uint8_t referenceSeq = 0;
+static bool hasReference = false;
+
+// zuletzt gesendete Pose und Zeitpunkte (Uptime in ms)
+static QPose_t lastSent;
+static uint16_t lastSendTime = 0;
+static uint16_t lastKeyframeTime = 0;
+
+
+static void quantize(const Pose_t* pose, QPose_t* q) {
+    q->x = lround(pose->x * 10.0f);
+    q->y = lround(pose->y * 10.0f);
+    q->theta = lround(pose->theta * 1000.0f);
+}
+
+// Differenz zweier Winkel in mrad, auf [-pi, pi) umgebrochen
+static int16_t thetaDiff(int16_t a, int16_t b) {
+    int16_t d = a - b;
+    if (d >= 3142)
+        d -= 6283;
+    else if (d < -3142)
+        d += 6283;
+    return d;
+}
+
+// hängt value zigzag- und varint-kodiert an p an, gibt das Ende zurück
+static uint8_t* putVarint(uint8_t* p, int32_t value) {
+    uint32_t v = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    while (v >= 0x80) {
+        *p++ = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static bool exceedsThreshold(const QPose_t* q) {
+    return labs(q->x - lastSent.x) > POSE_STREAM_THRESHOLD_POS
+        || labs(q->y - lastSent.y) > POSE_STREAM_THRESHOLD_POS
+        || abs(thetaDiff(q->theta, lastSent.theta)) > POSE_STREAM_THRESHOLD_THETA;
+}
+
+static void sendKeyframe(const QPose_t* q) {
+    pendingSeq = (pendingSeq + 1) & ~POSE_STREAM_KEYFRAME;
+    pendingKeyframe = *q;
+
+    PoseKeyframe_t keyframe;
+    keyframe.header = POSE_STREAM_KEYFRAME | pendingSeq;
+    keyframe.x = q->x;
+    keyframe.y = q->y;
+    keyframe.theta = q->theta;
+    communication_writePacket(CH_OUT_POSE_STREAM, (uint8_t*)&keyframe, sizeof(keyframe));
+}
+
+static void sendDelta(const QPose_t* q) {
+    uint8_t packet[1 + 3 * 5];
+    uint8_t* p = packet;
+    *p++ = referenceSeq;
+    p = putVarint(p, q->x - reference.x);
+    p = putVarint(p, q->y - reference.y);
+    p = putVarint(p, thetaDiff(q->theta, reference.theta));
+    communication_writePacket(CH_OUT_POSE_STREAM, packet, p - packet);
+}
+
+
+void poseStream_setEnabled(bool enable) {
+    enabled = enable;
+    hasReference = false;
+    // ersten Keyframe sofort senden
+    lastKeyframeTime = timeTask_getTaskUptime() - POSE_STREAM_KEYFRAME_INTERVAL;
+}
+
+bool poseStream_isEnabled() {
+    return enabled;
+}
+
+void poseStreamAck(const uint8_t* packet, __attribute__((unused)) const uint16_t size) {
+    PoseStreamAck_t* ack = (PoseStreamAck_t*) packet;
+    if (ack->seq == pendingSeq) {
+        reference = pendingKeyframe;
+        referenceSeq = pendingSeq;
+        hasReference = true;
+    }
+}
+
+void checkPoseStream() {
+    if (enabled && communication_isChannelDue(CH_OUT_POSE_STREAM)) {
+        QPose_t q;
+        quantize(getPose(), &q);
+        uint16_t now = timeTask_getTaskUptime();
+        bool due = exceedsThreshold(&q) || (uint16_t)(now - lastSendTime) >= POSE_STREAM_MAX_INTERVAL;
+
+        if ((uint16_t)(now - lastKeyframeTime) >= POSE_STREAM_KEYFRAME_INTERVAL || (!hasReference && due)) {
+            // periodischer Keyframe bzw. noch kein Keyframe bestätigt
+            sendKeyframe(&q);
+            lastKeyframeTime = now;
+        } else if (due) {
+            sendDelta(&q);
+        } else {
+            return;
+        }
+        lastSent = q;
+        lastSendTime = now;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef POSESTREAM_H
+#define POSESTREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//******************//
+/*
+Aufgabe: 
+Sendet die Pose als kompakten Datenstrom auf CH_OUT_POSE_STREAM statt als Pose_t alle 100ms auf CH_OUT_POSE.
+Gesendet werden Keyframes (PoseKeyframe_t) und Deltas als Varints (0.1mm / 1mrad) gegenüber dem letzten vom
+Empfänger bestätigten Keyframe (PoseStreamAck_t auf CH_IN_POSE_STREAM_ACK).
+
+Ein Paket wird nur gesendet, wenn sich die Pose um mehr als die Schwellwerte geändert hat oder
+POSE_STREAM_MAX_INTERVAL vergangen ist. Alle POSE_STREAM_KEYFRAME_INTERVAL wird ein neuer Keyframe gesendet.
+Solange kein Keyframe bestätigt ist, werden nur Keyframes gesendet.
+
+Bietet folgende Funktionalitäten an:
+- poseStream_setEnabled(): Schaltet den Datenstrom ein/aus
+- poseStream_isEnabled(): Gibt an, ob der Datenstrom eingeschaltet ist (dann kein Pose_t auf CH_OUT_POSE senden)
+- poseStreamAck(): Callback für CH_IN_POSE_STREAM_ACK
+- checkPoseStream(): Aktualisiert die Pose mit der Ausgaberate von CH_OUT_POSE_STREAM (communication_setRate()) und sendet ggf.
+
+ Wie verwenden?
+ - poseStreamAck() als Callback für CH_IN_POSE_STREAM_ACK registrieren
+ - checkPoseStream() in der Hauptschleife aufrufen
+*/
+//******************//
+
+/**
+ * Maximaler Abstand zwischen zwei Paketen, in ms
+*/
+#define POSE_STREAM_MAX_INTERVAL 1000
+
+/**
+ * Abstand zwischen zwei Keyframes, in ms
+*/
+#define POSE_STREAM_KEYFRAME_INTERVAL 5000
+
+/**
+ * Schwellwert für die Änderung von x oder y, in 0.1mm
+*/
+#define POSE_STREAM_THRESHOLD_POS 10
+
+/**
+ * Schwellwert für die Änderung von theta, in mrad
+*/
+#define POSE_STREAM_THRESHOLD_THETA 5
+
+/**
+ * Schaltet den Datenstrom ein oder aus. Beim Einschalten wird mit einem Keyframe begonnen.
+*/
+void poseStream_setEnabled(bool enable);
+
+/**
+ * @returns true, falls der Datenstrom eingeschaltet ist
+*/
+bool poseStream_isEnabled();
+
+/**
+ * Callback für CH_IN_POSE_STREAM_ACK: Empfänger bestätigt einen Keyframe (PoseStreamAck_t)
+*/
+void poseStreamAck(const uint8_t* packet, const uint16_t size);
+
+/**
+ * Aktualisiert die Pose und sendet den Datenstrom, falls eingeschaltet und laut communication_isChannelDue() fällig
+*/
+void checkPoseStream();
+
+#endif
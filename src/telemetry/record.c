@@ -0,0 +1,233 @@
+#include "record.h"
+
+#ifdef RECORD_INPUTS
+
+#include "../driving/driving.h"
+#include "../driving/control.h"
+#include "../sensors/sensors.h"
+#include "../tasks/taskManagement.h"
+
+#include <communication/communication.h>
+#include <tools/timeTask/timeTask.h>
+
+
+// Paketpuffer: RecordHeader_t und Ereignisse
+static uint8_t buffer[sizeof(RecordHeader_t) + RECORD_CHUNK];
+static uint8_t length = 0;
+static uint8_t seq = 0;
+
+static bool started = false;
+
+// Eingaben des vorherigen Durchlaufs
+static SensorInputs_t lastInputs;
+static uint16_t lastUptime = 0;
+
+// noch nicht geschriebene Durchläufe ohne Änderungen, currentIdle: der aktuelle Durchlauf ist mitgezählt
+static uint8_t idle = 0;
+static bool currentIdle = false;
+
+// Eingaben der Regelschritte: von der ISR geschrieben (head), von der Hauptschleife gelesen (tail)
+static ControlInputs_t controlRing[RECORD_CONTROL_RING];
+static volatile uint8_t controlHead = 0;
+static volatile uint8_t controlTail = 0;
+static volatile bool controlLost = false;
+static bool controlLostWritten = false;
+static ControlInputs_t lastControl; // zuletzt aufgezeichneter Schritt
+
+// zuletzt aufgezeichnete Entscheidungen
+static int16_t lastPwmLeft = 0;
+static int16_t lastPwmRight = 0;
+static uint16_t lastQueueSize = 0;
+static uint8_t lastState = 0;
+
+
+static void flush() {
+    if (length == 0)
+        return;
+    ((RecordHeader_t*)buffer)->seq = seq++;
+    communication_writePacket(CH_OUT_RECORD, buffer, sizeof(RecordHeader_t) + length);
+    length = 0;
+}
+
+static void put(uint8_t byte) {
+    buffer[sizeof(RecordHeader_t) + length++] = byte;
+    if (length == RECORD_CHUNK)
+        flush();
+}
+
+static void putVarint(uint32_t value) {
+    while (value >= 0x80) {
+        put((uint8_t)value | 0x80);
+        value >>= 7;
+    }
+    put((uint8_t)value);
+}
+
+static void putZigzag(int32_t value) {
+    putVarint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+static void flushIdle() {
+    if (idle) {
+        put(RECORD_IDLE | (idle - 1));
+        idle = 0;
+    }
+}
+
+// vor dem ersten weiteren Ereignis eines Durchlaufs ohne Änderungen: den Durchlauf doch als TICK schreiben
+static void beginEvent() {
+    if (currentIdle) {
+        currentIdle = false;
+        idle--;
+        flushIdle();
+        put(RECORD_TICK);
+    }
+}
+
+static void recordPacket(const Channel_t channel, const uint8_t* packet, const uint16_t size) {
+    if (!started)
+        return;
+    beginEvent();
+    put(RECORD_PACKET);
+    put(channel);
+    putVarint(size);
+    for (uint16_t i = 0; i < size; i++) {
+        put(packet[i]);
+    }
+}
+
+
+// gepufferte Regelschritte schreiben (Deltas zum vorherigen Schritt)
+static void recordControlSteps() {
+    while (controlTail != controlHead) {
+        const ControlInputs_t* step = &controlRing[controlTail];
+        beginEvent();
+        put(RECORD_CONTROL);
+        putVarint((uint16_t)(step->section - lastControl.section));
+        putZigzag((int16_t)(step->uptime - lastControl.uptime));
+        putZigzag((int16_t)(step->encoder1Total - lastControl.encoder1Total));
+        putZigzag((int16_t)(step->encoder2Total - lastControl.encoder2Total));
+        lastControl = *step;
+        controlTail = (controlTail + 1) % RECORD_CONTROL_RING;
+    }
+    if (controlLost && !controlLostWritten) {
+        controlLostWritten = true;
+        beginEvent();
+        put(RECORD_CONTROL_LOST);
+    }
+}
+
+
+void record_init() {
+    communication_setReceiveHook(recordPacket);
+}
+
+void record_beginIteration() {
+    const SensorInputs_t* inputs = getSensorInputs();
+    uint16_t uptime = timeTask_getTaskUptime();
+
+    if (!started) {
+        started = true;
+        put(RECORD_START);
+        putVarint(uptime);
+        putZigzag(inputs->encoder1Total);
+        putZigzag(inputs->encoder2Total);
+        putVarint(inputs->bumperTotal);
+        for (uint8_t i = 0; i < SENSORS_INFRARED_COUNT; i++) {
+            putVarint(inputs->infrared[i]);
+        }
+        // der erste Regelschritt bezieht sich auf den ersten Abschnitt und die Eingaben von RECORD_START
+        lastControl.section = 0;
+        lastControl.uptime = uptime;
+        lastControl.encoder1Total = inputs->encoder1Total;
+        lastControl.encoder2Total = inputs->encoder2Total;
+    } else {
+        uint8_t mask = 0;
+        if (uptime != lastUptime)
+            mask |= RECORD_INPUT_UPTIME;
+        if (inputs->encoder1Total != lastInputs.encoder1Total)
+            mask |= RECORD_INPUT_ENCODER1;
+        if (inputs->encoder2Total != lastInputs.encoder2Total)
+            mask |= RECORD_INPUT_ENCODER2;
+        if (inputs->bumperTotal != lastInputs.bumperTotal)
+            mask |= RECORD_INPUT_BUMPER;
+        for (uint8_t i = 0; i < SENSORS_INFRARED_COUNT; i++) {
+            if (inputs->infrared[i] != lastInputs.infrared[i])
+                mask |= RECORD_INPUT_IR0 << i;
+        }
+
+        if (mask == 0) {
+            // Leerlauf erst später schreiben (zusammengefasst oder doch als TICK, siehe beginEvent())
+            if (idle == 64)
+                flushIdle();
+            idle++;
+            currentIdle = true;
+        } else {
+            currentIdle = false;
+            flushIdle();
+            put(RECORD_TICK | mask);
+            if (mask & RECORD_INPUT_UPTIME)
+                putVarint((uint16_t)(uptime - lastUptime));
+            if (mask & RECORD_INPUT_ENCODER1)
+                putZigzag((int16_t)(inputs->encoder1Total - lastInputs.encoder1Total));
+            if (mask & RECORD_INPUT_ENCODER2)
+                putZigzag((int16_t)(inputs->encoder2Total - lastInputs.encoder2Total));
+            if (mask & RECORD_INPUT_BUMPER)
+                putVarint((uint16_t)(inputs->bumperTotal - lastInputs.bumperTotal));
+            for (uint8_t i = 0; i < SENSORS_INFRARED_COUNT; i++) {
+                if (mask & (RECORD_INPUT_IR0 << i))
+                    putZigzag((int16_t)(inputs->infrared[i] - lastInputs.infrared[i]));
+            }
+        }
+    }
+
+    lastInputs = *inputs;
+    lastUptime = uptime;
+
+    recordControlSteps();
+}
+
+void record_controlStep(const ControlInputs_t* inputs) {
+    uint8_t next = (controlHead + 1) % RECORD_CONTROL_RING;
+    if (next == controlTail) {
+        controlLost = true;
+        return;
+    }
+    controlRing[controlHead] = *inputs;
+    controlHead = next;
+}
+
+void record_endIteration() {
+    // letzter Abschnitt des Durchlaufs: spätere Regelschritte wirken sich erst auf den nächsten aus
+    control_lock();
+    int16_t pwmLeft = getPWM_left();
+    int16_t pwmRight = getPWM_right();
+    uint16_t queueSize = getTaskQueueSize();
+    uint8_t state = (isTaskQueueIterating() ? 0x01 : 0) | (isTaskActive() ? 0x02 : 0);
+    control_unlock();
+
+    if (pwmLeft != lastPwmLeft || pwmRight != lastPwmRight || queueSize != lastQueueSize || state != lastState) {
+        beginEvent();
+        put(RECORD_DECISION);
+        putZigzag(pwmLeft);
+        putZigzag(pwmRight);
+        putVarint(queueSize);
+        put(state);
+
+        lastPwmLeft = pwmLeft;
+        lastPwmRight = pwmRight;
+        lastQueueSize = queueSize;
+        lastState = state;
+    }
+
+    recordControlSteps();
+
+    currentIdle = false; // Durchlauf beendet, weitere Ereignisse gehören zum nächsten
+
+    TIMETASK(RECORD_FLUSH_TASK, RECORD_FLUSH_INTERVAL) {
+        flushIdle();
+        flush();
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../driving/control.h"
+
+//******************//
+/*
+Aufgabe:
+Zeichnet die Eingaben der Hauptschleife auf, damit ein Lauf im Labor auf dem PC exakt nachgespielt werden kann
+(tools/replay). Pro Durchlauf der Hauptschleife werden die von latchSensors() bzw. timeTask_latchUptime()
+eingelesenen Werte (Uptime, Encoder, Bumper, Infrarot) als Deltas, alle empfangenen Pakete (Kanal, Größe, Inhalt)
+sowie als Kontrollwerte die Entscheidungen (PWM, Task Queue) auf CH_OUT_RECORD gestreamt (Format siehe
+RecordHeader_t in packetTypes.h).
+
+Die Regelungsebene (driving/control.h) läuft im Interrupt von Timer 1 und damit zu beliebigen Zeitpunkten innerhalb
+eines Durchlaufs. Ihre Eingaben werden daher an der Grenze der ISR aufgezeichnet: die ISR legt die Eingaben jedes
+Schritts (Uptime, Encoder und die Nummer des nächsten Abschnitts der Hauptschleife) in einen Ringpuffer
+(record_controlStep()), die Hauptschleife schreibt sie am Anfang und Ende jedes Durchlaufs als Ereignisse. Der
+Nachbau führt jeden Schritt vor dem Abschnitt aus, vor dem er auf dem Roboter gelaufen ist. Läuft der Ringpuffer
+über, ist die Aufzeichnung ab dort nicht mehr nachspielbar (RECORD_CONTROL_LOST).
+
+Da ein Durchlauf nur von diesen Eingaben abhängt, trifft der Nachbau auf dem PC dieselben Entscheidungen
+in move() und in der Task-Verwaltung. Ohne Änderungen wird pro Durchlauf höchstens ein Byte gesendet
+(aufeinanderfolgende Leerläufe werden zusammengefasst), bei laufenden Motoren und verrauschtem Infrarot
+einige kB/s.
+
+Bietet folgende Funktionalitäten an:
+- record_init(): Registriert den Empfangs-Hook der Kommunikation
+- record_beginIteration(): Zeichnet die eingelesenen Eingaben des Durchlaufs auf
+- record_endIteration(): Zeichnet geänderte Entscheidungen auf und sendet gepufferte Ereignisse
+- record_controlStep(): Merkt sich die Eingaben eines Regelschritts (ISR)
+
+ Wie verwenden?
+ - RECORD_INPUTS definieren (nur dann wird aufgezeichnet, ansonsten sind alle Funktionen leer)
+ - Aufzeichnung läuft ab dem Booten, Mitschnitt der seriellen Verbindung (z.B. cat /dev/ttyUSB0 > capture.bin)
+   mit tools/replay nachspielen (replay capture.bin)
+ - die Aufzeichnung ist nur bis zum ersten verlorenen Paket (Lücke in RecordHeader_t.seq) nachspielbar
+*/
+//******************//
+
+//#define RECORD_INPUTS
+
+/**
+ * Spätestens nach dieser Zeit (ms) werden gepufferte Ereignisse gesendet
+*/
+#define RECORD_FLUSH_INTERVAL 100
+
+/**
+ * Regelschritte, die zwischen zwei Aufrufen von record_beginIteration()/record_endIteration() gepuffert werden
+ * (Zweierpotenz, 16 Schritte = 32ms Durchlauf)
+*/
+#define RECORD_CONTROL_RING 16
+
+#ifdef RECORD_INPUTS
+
+/**
+ * Registriert den Hook, über den empfangene Pakete aufgezeichnet werden.
+ * Nach communication_init() aufrufen.
+*/
+void record_init();
+
+/**
+ * Zeichnet die Eingaben des aktuellen Durchlaufs auf.
+ * Am Anfang jedes Durchlaufs direkt nach timeTask_latchUptime() und latchSensors() aufrufen.
+*/
+void record_beginIteration();
+
+/**
+ * Zeichnet PWM und Zustand der Task Queue auf, falls sie sich geändert haben.
+ * Am Ende jedes Durchlaufs aufrufen.
+*/
+void record_endIteration();
+
+/**
+ * Merkt sich die Eingaben eines Regelschritts bis zum nächsten record_beginIteration()/record_endIteration().
+ * Nur aus der ISR der Regelungsebene vor dem Schritt aufrufen.
+ *
+ * @param inputs Eingaben des Schritts
+*/
+void record_controlStep(const ControlInputs_t* inputs);
+
+#else
+
+static inline void record_init() {}
+static inline void record_beginIteration() {}
+static inline void record_endIteration() {}
+static inline void record_controlStep(__attribute__((unused)) const ControlInputs_t* inputs) {}
+
+#endif
+
+#endif
@@ -0,0 +1,139 @@
+#include "trace.h"
+
+#include "../driving/driving.h"
+#include "../driving/control.h"
+#include "../path/path.h"
+#include "../pose/pose.h"
+#include "../tasks/taskManagement.h"
+
+#include <communication/communication.h>
+#include <io/adc/adc.h>
+
+#include <math.h>
+
+#if (TRACE_SAMPLES < 1) || (TRACE_SAMPLES > 255)
+    #error TRACE_SAMPLES must be in the range 1 to 255
+#endif
+
+// Ringpuffer der Samples
+static TraceSample_t samples[TRACE_SAMPLES];
+
+// nächste Schreibposition und Anzahl gültiger Samples
+static uint8_t head = 0;
+static uint8_t count = 0;
+
+static uint16_t interval = TRACE_INTERVAL;
+
+// Zustand des Dumps (solange gesendet wird, zeichnet die Regelungsebene nicht auf)
+static volatile bool dumping = false;
+static uint8_t dumpIndex = 0;
+
+// Encoder-Zählerstände beim letzten Sample (Eingaben des Regelschritts)
+static int16_t lastEncoder1 = 0;
+static int16_t lastEncoder2 = 0;
+
+
+static int8_t saturate(int16_t value) {
+    if (value > INT8_MAX)
+        return INT8_MAX;
+    if (value < INT8_MIN)
+        return INT8_MIN;
+    return value;
+}
+
+static void record() {
+    TraceSample_t* sample = &samples[head];
+    const ControlInputs_t* inputs = control_getInputs();
+
+    sample->time = inputs->uptime;
+    sample->encoder1 = saturate(inputs->encoder1Total - lastEncoder1);
+    sample->encoder2 = saturate(inputs->encoder2Total - lastEncoder2);
+    sample->pwmLeft = getPWM_left();
+    sample->pwmRight = getPWM_right();
+    sample->theta = lround(getPose()->theta * 1000.0f);
+    sample->ir[0] = ADC_getLastValue(1) >> 2; //links
+    sample->ir[1] = ADC_getLastValue(0) >> 2; //rechts
+    sample->ir[2] = ADC_getLastValue(2) >> 2; //vorne
+    sample->state = (isTaskQueueIterating() ? 0x01 : 0) | (isTaskActive() ? 0x02 : 0) | (path_isActive() ? 0x04 : 0);
+
+    lastEncoder1 = inputs->encoder1Total;
+    lastEncoder2 = inputs->encoder2Total;
+
+    if (++head == TRACE_SAMPLES)
+        head = 0;
+    if (count < TRACE_SAMPLES)
+        count++;
+}
+
+// sendet die nächsten Samples des Dumps (älteste zuerst)
+static void sendChunk() {
+    uint8_t packet[sizeof(TraceDump_t) + TRACE_DUMP_CHUNK * sizeof(TraceSample_t)];
+    TraceDump_t* header = (TraceDump_t*)packet;
+    TraceSample_t* chunk = (TraceSample_t*)(packet + sizeof(TraceDump_t));
+
+    uint8_t n = count - dumpIndex;
+    if (n > TRACE_DUMP_CHUNK)
+        n = TRACE_DUMP_CHUNK;
+
+    header->index = dumpIndex;
+    header->total = count;
+
+    // ältestes Sample liegt bei head, falls der Puffer voll ist, sonst bei 0
+    uint8_t first = count < TRACE_SAMPLES ? 0 : head;
+    for (uint8_t i = 0; i < n; i++) {
+        uint16_t index = first + dumpIndex + i;
+        if (index >= TRACE_SAMPLES)
+            index -= TRACE_SAMPLES;
+        chunk[i] = samples[index];
+    }
+    communication_writePacket(CH_OUT_TRACE, packet, sizeof(TraceDump_t) + n * sizeof(TraceSample_t));
+
+    dumpIndex += n;
+}
+
+
+void trace_setInterval(uint16_t value) {
+    control_lock();
+    interval = value > CONTROL_INTERVAL ? value : CONTROL_INTERVAL;
+    control_unlock();
+}
+
+uint16_t trace_getInterval() {
+    return interval;
+}
+
+void trace_dump() {
+    dumping = true;
+    dumpIndex = 0;
+}
+
+bool trace_isDumping() {
+    return dumping;
+}
+
+void trace_sample() {
+    if (dumping)
+        return;
+
+    CONTROLTASK(TRACE_TASK, interval) {
+        record();
+    }
+}
+
+void checkTrace() {
+    if (!dumping)
+        return;
+
+    // pro Aufruf nur einen Teil senden, damit die Hauptschleife weiterläuft
+    sendChunk();
+    if (dumpIndex >= count) {
+        // Aufzeichnung neu beginnen
+        control_lock();
+        head = 0;
+        count = 0;
+        lastEncoder1 = control_getInputs()->encoder1Total;
+        lastEncoder2 = control_getInputs()->encoder2Total;
+        dumping = false;
+        control_unlock();
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//******************//
+/*
+Aufgabe: 
+Flugschreiber: zeichnet Regelgrößen (Encoder, PWM, theta, Infrarot, Task-Zustand) als TraceSample_t in einem
+Ringpuffer im RAM auf, ohne dabei über UART zu senden. Aufgezeichnet wird als letzte Stufe der Regelungsebene
+(driving/control.h) mit den Eingaben des Regelschritts, der Abstand der Samples hängt damit nicht von der Dauer eines
+Durchlaufs der Hauptschleife ab. Auf Anforderung wird der Puffer eingefroren und danach in der Hauptschleife in
+TraceDump_t-Paketen auf CH_OUT_TRACE gesendet. tools/framing (framing trace) wandelt einen Mitschnitt in CSV um.
+
+Bietet folgende Funktionalitäten an:
+- trace_setInterval() / trace_getInterval(): Abstand zwischen zwei Samples in ms (Vielfaches von CONTROL_INTERVAL,
+  User Command 57 schaltet zwischen CONTROL_INTERVAL und TRACE_INTERVAL_MAX um)
+- trace_dump(): Friert den Puffer ein und startet das Senden
+- trace_sample(): Stufe der Regelungsebene, zeichnet im eingestellten Abstand ein Sample auf
+- checkTrace(): Sendet beim Dump den nächsten Teil des Puffers
+
+ Wie verwenden?
+ - checkTrace() in der Hauptschleife aufrufen, trace_sample() wird von control_step() aufgerufen
+ - nach dem Senden wird die Aufzeichnung automatisch fortgesetzt
+ - der Puffer liegt fest im RAM (TRACE_SAMPLES * 14 Byte), für längere Aufzeichnungen lieber den Abstand erhöhen
+   oder TRACE_SAMPLES beim Übersetzen setzen (z.B. -DTRACE_SAMPLES=96) und den freien Speicher im Blick behalten
+*/
+//******************//
+
+/**
+ * Anzahl der Samples im Ringpuffer (14 Byte pro Sample, 1 bis 255), standardmäßig 2058 Byte. Statischer Speicher
+ * insgesamt damit ca. 4,6KB (davon Empfangsring 1028 Byte, Sendepuffer 256 Byte), für Stack (Log-Puffer und printf,
+ * Regelschritt in der ISR) und Heap (Task-Queue, Pfad) bleiben ca. 3,5KB.
+*/
+#ifndef TRACE_SAMPLES
+#define TRACE_SAMPLES 147
+#endif
+
+/**
+ * Standardabstand zwischen zwei Samples in ms (147 Samples * 8ms = 1,2s Aufzeichnung)
+*/
+#define TRACE_INTERVAL 8
+
+/**
+ * Größter Abstand für User Command 57 in ms (147 Samples * 32ms = 4,7s Aufzeichnung)
+*/
+#define TRACE_INTERVAL_MAX 32
+
+/**
+ * Setzt den Abstand zwischen zwei Samples.
+ * 
+ * @param interval: Abstand in ms (mind. CONTROL_INTERVAL, wird auf ein Vielfaches davon aufgerundet)
+*/
+void trace_setInterval(uint16_t interval);
+
+/**
+ * @returns Abstand zwischen zwei Samples in ms
+*/
+uint16_t trace_getInterval();
+
+/**
+ * Friert den Puffer ein und sendet ihn anschließend mit checkTrace() auf CH_OUT_TRACE.
+ * Während des Sendens wird nicht aufgezeichnet.
+*/
+void trace_dump();
+
+/**
+ * @returns true, solange der Puffer gesendet wird
+*/
+bool trace_isDumping();
+
+/**
+ * Stufe der Regelungsebene: zeichnet im eingestellten Abstand ein Sample auf, außer während des Dumps
+*/
+void trace_sample();
+
+/**
+ * Sendet beim Dump den nächsten Teil des Puffers (Hauptschleife)
+*/
+void checkTrace();
+
+#endif
@@ -2,9 +2,16 @@
 #include "../explorer/labyrinthState.h"
 #include "../sensors/vision.h"
 #include "../helper/mathHelper.h"
+#include "../tasks/snake.h"
+#include "../tasks/taskManagement.h"
+#include "../tasks/taskqueue.h"
+#include "../pose/pose.h"
 
 #include <communication/communication.h>
+#include <communication/cobs.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 char *angleTest(){
     if(checkAngle_greater(0.0f, -3*M_PI_4) != false){
@@ -220,10 +227,141 @@ char *visionTest(){
 }
 
 
+char *cobsTest(){
+    const uint8_t data[] = {0x00, 0x11, 0x2B, 0x00, 0x00, 0x42, 0xFF, 0x00};
+    uint8_t encoded[COBS_MAX_ENCODED_SIZE(sizeof(data))];
+    uint8_t decoded[sizeof(encoded)];
+    uint16_t decodedLen;
+
+    uint16_t encodedLen = cobs_encode(data, sizeof(data), encoded);
+    if(encodedLen != sizeof(data) + 1){
+        return "cobsTest - ERROR: cobs_encode() != sizeof(data) + 1";
+    }
+    if(memchr(encoded, 0, encodedLen) != NULL){
+        return "cobsTest - ERROR: encoded data contains zero byte";
+    }
+    if(!cobs_decode(encoded, encodedLen, decoded, &decodedLen)){
+        return "cobsTest - ERROR: cobs_decode() failed";
+    }
+    if(decodedLen != sizeof(data) || memcmp(data, decoded, sizeof(data)) != 0){
+        return "cobsTest - ERROR: decoded data != data";
+    }
+
+    return "cobsTest - FINE";
+}
+
+
+char *snakeTest(){
+    Queue* queue = createQueue();
+    Task* task1 = createTask(NULL, NULL, NULL);
+    Task* task2 = createTask(NULL, NULL, NULL);
+    Task* task3 = createTask(NULL, NULL, NULL);
+    char* result = "snakeTest - FINE";
+
+    enqueue(queue, task1);
+    enqueue(queue, task2);
+    enqueue(queue, task3);
+
+    if(peek(queue) != task1 || queueSize(queue) != 3){
+        result = "snakeTest - ERROR: peek() != task1 || queueSize() != 3";
+    } else if(removeAfter(queue, queue->front) != task2 || queueSize(queue) != 2){
+        result = "snakeTest - ERROR: removeAfter(front) != task2";
+    } else if(removeAfter(queue, queue->front) != task3 || queue->rear != queue->front){
+        result = "snakeTest - ERROR: removeAfter(front) != task3 || rear != front";
+    } else if(removeAfter(queue, queue->front) != NULL){
+        result = "snakeTest - ERROR: removeAfter(rear) != NULL";
+    } else if(removeAfter(queue, NULL) != task1 || !isEmpty(queue) || peek(queue) != NULL){
+        result = "snakeTest - ERROR: removeAfter(NULL) != task1 || !isEmpty()";
+    }
+
+    while(!isEmpty(queue)){
+        dequeue(queue);
+    }
+    free(task1);
+    free(task2);
+    free(task3);
+    free(queue);
+
+    return result;
+}
+
+
+//Ziel der Kachel-Fahrt tiles Zellen von der momentanen Zelle in Richtung dir (nur die Koordinate entlang der Fahrt)
+static bool isTileTarget(Task* task, Direction_t dir, int8_t tiles){
+    switch(dir){
+        case DIRECTION_NORTH:
+            return task->cancelParameters->abortPar_2 == getTile_y(robot_getRow() - tiles);
+        case DIRECTION_EAST:
+            return task->cancelParameters->abortPar_1 == getTile_x(robot_getColumn() + tiles);
+        case DIRECTION_SOUTH:
+            return task->cancelParameters->abortPar_2 == getTile_y(robot_getRow() + tiles);
+        default:
+            return task->cancelParameters->abortPar_1 == getTile_x(robot_getColumn() - tiles);
+    }
+}
+
+char *optimizeTaskQueueTest(){
+    if(getTaskQueueSize() != 0){
+        return "optimizeTaskQueueTest - ERROR: Task Queue nicht leer";
+    }
+    //quer zur momentanen Ausrichtung: Drehungen in diese Richtung sind nicht überflüssig
+    Direction_t dir = getTotalOrientation(1, pose_getCurrentCardinalDirection());
+    Direction_t other = getTotalOrientation(2, dir);
+    char* result = "optimizeTaskQueueTest - FINE";
+
+    //[R,R]: nur die letzte Drehung bleibt
+    enqueue_rotateToCardinalDirection(1000, other);
+    enqueue_rotateToCardinalDirection(1000, dir);
+    if(optimizeTaskQueue() != 1 || getTaskQueueSize() != 1){
+        result = "optimizeTaskQueueTest - ERROR: [R,R] != [R]";
+    } else if(getTaskQueue()->front->task->cancelParameters->abortPar_1 != getAngle_forCardinalDirection(dir)){
+        result = "optimizeTaskQueueTest - ERROR: [R,R]: Zielwinkel != letzte Drehung";
+    }
+    abortTasks();
+
+    //[D,R]: Drehung auf die Ausrichtung nach der Fahrt entfällt
+    if(getTaskQueueSize() == 0){
+        enqueue_moveForward_oneTile(1000, dir);
+        enqueue_rotateToCardinalDirection(1000, dir);
+        if(optimizeTaskQueue() != 1 || getTaskQueueSize() != 1 || !isTileTarget(getTaskQueue()->front->task, dir, 1)){
+            result = "optimizeTaskQueueTest - ERROR: [D,R] != [D]";
+        }
+        abortTasks();
+    }
+
+    //[D,D]: eine Fahrt über zwei Zellen
+    if(getTaskQueueSize() == 0){
+        enqueue_moveForward_oneTile(1000, dir);
+        enqueue_moveForward_oneTile(1000, dir);
+        if(optimizeTaskQueue() != 1 || getTaskQueueSize() != 1 || !isTileTarget(getTaskQueue()->front->task, dir, 2)){
+            result = "optimizeTaskQueueTest - ERROR: [D,D] != [D] über zwei Zellen";
+        }
+        abortTasks();
+    }
+
+    //[R,D,R,D] (zweimal robot_move(FORWARD)): zweite Drehung entfällt, dann eine Fahrt über zwei Zellen
+    if(getTaskQueueSize() == 0){
+        enqueue_rotateToCardinalDirection(1000, dir);
+        enqueue_moveForward_oneTile(1000, dir);
+        enqueue_rotateToCardinalDirection(1000, dir);
+        enqueue_moveForward_oneTile(1000, dir);
+        if(optimizeTaskQueue() != 2 || getTaskQueueSize() != 2 || !isTileTarget(getTaskQueue()->rear->task, dir, 2)){
+            result = "optimizeTaskQueueTest - ERROR: [R,D,R,D] != [R,D] über zwei Zellen";
+        }
+        abortTasks();
+    }
+
+    return result;
+}
+
+
 void testAll(){
     communication_log(LEVEL_INFO, totalOrientationTest());
     //communication_log(LEVEL_INFO, isExitTest());
     communication_log(LEVEL_INFO, visionTest());
     communication_log(LEVEL_INFO, test_getTileCoordinates());
     communication_log(LEVEL_INFO, angleTest());
+    communication_log(LEVEL_INFO, cobsTest());
+    communication_log(LEVEL_INFO, snakeTest());
+    communication_log(LEVEL_INFO, optimizeTaskQueueTest());
 }
\ No newline at end of file
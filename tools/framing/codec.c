@@ -0,0 +1,129 @@
+#include "codec.h"
+
+#include <communication/cobs.h>
+#include <communication/framing.h>
+
+#include <string.h>
+
+
+bool codec_parseFraming(const char* name, Framing_t* framing) {
+    if (strcmp(name, "escape") == 0) {
+        *framing = FRAMING_ESCAPE;
+        return true;
+    }
+    if (strcmp(name, "cobs") == 0) {
+        *framing = FRAMING_COBS;
+        return true;
+    }
+    return false;
+}
+
+
+// Place size, header byte, payload and checksum of a packet in out
+static size_t buildPacket(uint8_t channel, const uint8_t* payload, uint16_t size, uint8_t* out) {
+    uint8_t chksum = (uint8_t)size ^ (uint8_t)(size >> 8);
+    out[0] = (uint8_t)size;
+    out[1] = (uint8_t)(size >> 8);
+    out[2] = (((chksum << 4) & 0xFF) ^ (chksum & 0xF0)) | (channel & 0x0F);
+    chksum ^= out[2];
+    for (uint16_t i = 0; i < size; i++) {
+        out[3 + i] = payload[i];
+        chksum ^= payload[i];
+    }
+    out[3 + size] = chksum;
+    return (size_t)size + 4;
+}
+
+
+size_t codec_encode(Framing_t framing, uint8_t channel, const uint8_t* payload, uint16_t size, uint8_t* out) {
+    static uint8_t packet[CODEC_MAX_PAYLOAD + 4];
+    size_t len = buildPacket(channel, payload, size, packet);
+    size_t n = 0;
+
+    if (framing == FRAMING_COBS) {
+        n = cobs_encode(packet, (uint16_t)len, out);
+        out[n++] = 0;
+        return n;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = packet[i];
+        if ((byte == COMM_ESC) || (byte == COMM_DELIM))
+            out[n++] = COMM_ESC;
+        out[n++] = byte;
+    }
+    out[n++] = COMM_DELIM;
+    return n;
+}
+
+
+void codec_decoderInit(Decoder_t* decoder, Framing_t framing) {
+    decoder->framing = framing;
+    decoder->len = 0;
+    decoder->isESC = false;
+    decoder->packets = 0;
+    decoder->errors = 0;
+}
+
+
+// Validate the packet in buf and execute the handler
+static void processPacket(Decoder_t* decoder, const uint8_t* buf, size_t len, PacketHandler_t handler, void* ctx) {
+    if (len < 4) {
+        decoder->errors++;
+        return;
+    }
+
+    uint16_t size = buf[0] | ((uint16_t)buf[1] << 8);
+    uint8_t chksumSize = buf[0] ^ buf[1];
+    chksumSize = (chksumSize >> 4) ^ (chksumSize & 0x0F);
+
+    uint8_t chksum = 0;
+    for (size_t i = 0; i < len; i++)
+        chksum ^= buf[i];
+
+    if (((buf[2] >> 4) != chksumSize) || (size != len - 4) || (chksum != 0)) {
+        decoder->errors++;
+        return;
+    }
+
+    decoder->packets++;
+    if (handler)
+        handler(ctx, buf[2] & 0x0F, buf + 3, size);
+}
+
+
+void codec_decode(Decoder_t* decoder, const uint8_t* data, size_t len, PacketHandler_t handler, void* ctx) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+
+        if (decoder->framing == FRAMING_COBS) {
+            if (byte == 0) {
+                uint16_t decodedLen;
+                if (cobs_decode(decoder->buf, (uint16_t)decoder->len, decoder->buf, &decodedLen))
+                    processPacket(decoder, decoder->buf, decodedLen, handler, ctx);
+                else
+                    decoder->errors++;
+                decoder->len = 0;
+                continue;
+            }
+        } else {
+            if (decoder->isESC) {
+                decoder->isESC = false;
+            } else if (byte == COMM_ESC) {
+                decoder->isESC = true;
+                continue;
+            } else if (byte == COMM_DELIM) {
+                processPacket(decoder, decoder->buf, decoder->len, handler, ctx);
+                decoder->len = 0;
+                continue;
+            }
+        }
+
+        if (decoder->len == sizeof(decoder->buf)) {
+            // packet too large, discard it
+            decoder->errors++;
+            decoder->len = 0;
+        }
+        decoder->buf[decoder->len++] = byte;
+    }
+}
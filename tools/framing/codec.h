@@ -0,0 +1,109 @@
+/**
+ * @file codec.h
+ *
+ * Host implementation of the packet framing of the communication library
+ * (lib/communication/communication.c) for tools running on the PC.
+ *
+ * Both framings are supported: escape characters (default of the robot and
+ * HWPCS) and COBS (see COMM_FRAMING_COBS in src/cfg/io/uart/uart_cfg.h).
+ */
+
+#ifndef CODEC_H_
+#define CODEC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/**
+ * Framing of packets on the serial link
+ */
+typedef enum {
+    FRAMING_ESCAPE = 0, ///< escape characters and '+' as packet delimiter
+    FRAMING_COBS = 1 ///< COBS encoded packet terminated by a zero byte
+} Framing_t;
+
+
+/**
+ * Maximum size of a packet payload
+ */
+#define CODEC_MAX_PAYLOAD 65535
+
+/**
+ * Maximum size of a framed packet with <code>size</code> bytes of payload
+ * (worst case of both framings)
+ */
+#define CODEC_MAX_FRAME_SIZE(size) (2 * ((size_t)(size) + 4) + 1)
+
+
+/**
+ * Callback function for decoded packets
+ *
+ * @param   ctx       user pointer passed to codec_decode()
+ * @param   channel   channel of the packet
+ * @param   payload   payload of the packet
+ * @param   size      size of the payload
+ */
+typedef void (*PacketHandler_t)(void* ctx, uint8_t channel, const uint8_t* payload, uint16_t size);
+
+
+/**
+ * State of a stream decoder
+ */
+typedef struct {
+    Framing_t framing; ///< framing of the stream
+    uint8_t buf[CODEC_MAX_PAYLOAD + 8]; ///< bytes of the current packet
+    size_t len; ///< number of bytes in buf
+    bool isESC; ///< last byte was an escape character (FRAMING_ESCAPE)
+    uint32_t packets; ///< number of valid packets
+    uint32_t errors; ///< number of invalid packets
+} Decoder_t;
+
+
+/**
+ * Parse the name of a framing ("escape" or "cobs").
+ *
+ * @param   name      name of the framing
+ * @param   framing   receives the framing
+ * @return  true if the name is valid
+ */
+bool codec_parseFraming(const char* name, Framing_t* framing);
+
+
+/**
+ * Frame a packet.
+ *
+ * @param   framing   framing to be used
+ * @param   channel   channel of the packet (0..15)
+ * @param   payload   payload of the packet
+ * @param   size      size of the payload
+ * @param   out       buffer for the framed packet, at least
+ *                    #CODEC_MAX_FRAME_SIZE(size) bytes
+ * @return  number of bytes written to out
+ */
+size_t codec_encode(Framing_t framing, uint8_t channel, const uint8_t* payload, uint16_t size, uint8_t* out);
+
+
+/**
+ * Initialize a stream decoder.
+ *
+ * @param   decoder   decoder to be initialized
+ * @param   framing   framing of the stream
+ */
+void codec_decoderInit(Decoder_t* decoder, Framing_t framing);
+
+
+/**
+ * Decode bytes of a stream and execute the handler for each complete and valid
+ * packet. Incomplete packets are kept for the next call.
+ *
+ * @param   decoder   stream decoder
+ * @param   data      received bytes
+ * @param   len       number of received bytes
+ * @param   handler   callback function for decoded packets
+ * @param   ctx       user pointer passed to the handler
+ */
+void codec_decode(Decoder_t* decoder, const uint8_t* data, size_t len, PacketHandler_t handler, void* ctx);
+
+#endif /* CODEC_H_ */
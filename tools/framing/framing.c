@@ -0,0 +1,290 @@
+/**
+ * @file framing.c
+ *
+ * Command line tool for the packet framings of the communication library.
+ *
+ * Usage:
+ *   framing encode <escape|cobs> <channel> [payload file]
+ *       frame the payload (stdin if no file is given) and write it to stdout
+ *   framing decode <escape|cobs> [stream file]
+ *       print channel, size and payload of all packets of a framed stream
+ *   framing convert <escape|cobs> <escape|cobs> [stream file]
+ *       re-frame all packets of a stream with the second framing
+ *   framing bench [capture file]
+ *       compare size and encode/decode throughput of both framings on a capture
+ *       of the serial link (escape framing, e.g. recorded with
+ *       <code>cat /dev/ttyUSB0 > capture.bin</code>) or on synthetic traffic
+ *   framing trace <escape|cobs> [stream file]
+ *       print the flight recorder dumps (channel CH_OUT_TRACE) of a capture as CSV
+ */
+
+#include "codec.h"
+
+#include <communication/packetTypes.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+// Baud rate of the serial link, 10 bits per byte (start bit, 8 data bits, stop bit)
+#define LINK_BAUD_RATE 500000.0
+
+// Number of encode/decode passes over the traffic in the benchmark
+#define BENCH_PASSES 200
+
+
+// List of packets, used by the benchmark
+typedef struct {
+    uint8_t channel;
+    uint16_t size;
+    uint8_t* payload;
+} Packet_t;
+
+typedef struct {
+    Packet_t* packets;
+    size_t count;
+    size_t capacity;
+} PacketList_t;
+
+
+static uint8_t* readAll(const char* path, size_t* len) {
+    FILE* f = path ? fopen(path, "rb") : stdin;
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    size_t capacity = 4096;
+    uint8_t* data = malloc(capacity);
+    *len = 0;
+    size_t n;
+    while ((n = fread(data + *len, 1, capacity - *len, f)) > 0) {
+        *len += n;
+        if (*len == capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity);
+        }
+    }
+    if (path)
+        fclose(f);
+    return data;
+}
+
+
+static void printPacket(void* ctx, uint8_t channel, const uint8_t* payload, uint16_t size) {
+    (void)ctx;
+    printf("channel %2u, size %5u:", channel, size);
+    for (uint16_t i = 0; i < size; i++)
+        printf(" %02x", payload[i]);
+    printf("\n");
+}
+
+
+static void writePacket(void* ctx, uint8_t channel, const uint8_t* payload, uint16_t size) {
+    static uint8_t frame[CODEC_MAX_FRAME_SIZE(CODEC_MAX_PAYLOAD)];
+    size_t len = codec_encode(*(Framing_t*)ctx, channel, payload, size, frame);
+    fwrite(frame, 1, len, stdout);
+}
+
+
+static void printTrace(void* ctx, uint8_t channel, const uint8_t* payload, uint16_t size) {
+    unsigned* dumps = ctx;
+    if (channel != CH_OUT_TRACE || size < sizeof(TraceDump_t))
+        return;
+
+    TraceDump_t header;
+    memcpy(&header, payload, sizeof(header));
+    if (header.index == 0)
+        (*dumps)++;
+
+    uint16_t n = (size - sizeof(TraceDump_t)) / sizeof(TraceSample_t);
+    for (uint16_t i = 0; i < n; i++) {
+        TraceSample_t s;
+        memcpy(&s, payload + sizeof(TraceDump_t) + i * sizeof(TraceSample_t), sizeof(s));
+        printf("%u,%u,%u,%d,%d,%d,%d,%d,%u,%u,%u,%u,%u,%u\n", *dumps, header.index + i, s.time,
+               s.encoder1, s.encoder2, s.pwmLeft, s.pwmRight, s.theta, s.ir[0], s.ir[1], s.ir[2],
+               s.state & 0x01, (s.state >> 1) & 0x01, (s.state >> 2) & 0x01);
+    }
+}
+
+
+static void addPacket(void* ctx, uint8_t channel, const uint8_t* payload, uint16_t size) {
+    PacketList_t* list = ctx;
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 256;
+        list->packets = realloc(list->packets, list->capacity * sizeof(Packet_t));
+    }
+    Packet_t* p = &list->packets[list->count++];
+    p->channel = channel;
+    p->size = size;
+    p->payload = malloc(size ? size : 1);
+    memcpy(p->payload, payload, size);
+}
+
+
+// Synthetic traffic resembling a driving robot: pose every 100 ms, path
+// follower status every 10 ms, telemetry every 300 ms and some log messages
+static void syntheticTraffic(PacketList_t* list) {
+    srand(1);
+    for (int t = 0; t < 60000; t += 10) {
+        float s = t / 1000.0f;
+
+        PathFollowerStatus_t status = { .enabled = true };
+        status.segStart.x = 300; status.segStart.y = 300;
+        status.segEnd.x = 900; status.segEnd.y = 300;
+        status.lookahead.x = 300.0f + 10.0f * s;
+        status.lookahead.y = 300.0f + (rand() % 100) / 50.0f;
+        addPacket(list, CH_OUT_PATH_FOLLOW_STATUS, (uint8_t*)&status, sizeof(status));
+
+        if (t % 100 == 0) {
+            Pose_t pose = { .x = 300.0f + 10.0f * s, .y = 300.0f + (rand() % 100) / 50.0f, .theta = (rand() % 1000) / 1000.0f - 0.5f };
+            addPacket(list, CH_OUT_POSE, (uint8_t*)&pose, sizeof(pose));
+        }
+        if (t % 300 == 0) {
+            Telemetry_t telemetry = { .encoder1 = (int16_t)(t / 7), .encoder2 = (int16_t)(t / 7 + 3), .infrared1 = (uint16_t)(rand() % 800), .infrared2 = (uint16_t)(rand() % 800), .infrared3 = (uint16_t)(rand() % 800), .infrared4 = (uint16_t)(rand() % 800), .infrared5 = (uint16_t)(rand() % 800), .user1 = 20, .user2 = 42.42f };
+            addPacket(list, CH_OUT_TELEMETRY, (uint8_t*)&telemetry, sizeof(telemetry));
+        }
+        if (t % 1000 == 0) {
+            char log[64];
+            int n = snprintf(log + 1, sizeof(log) - 1, "Queue On, queue size: %d", t / 1000 % 5);
+            log[0] = 2; // LEVEL_INFO
+            addPacket(list, CH_OUT_DEBUG, (uint8_t*)log, (uint16_t)(n + 1));
+        }
+    }
+}
+
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void bench(const PacketList_t* list) {
+    size_t payloadBytes = 0;
+    size_t maxFrame = 0;
+    for (size_t i = 0; i < list->count; i++) {
+        payloadBytes += list->packets[i].size;
+        if (CODEC_MAX_FRAME_SIZE(list->packets[i].size) > maxFrame)
+            maxFrame = CODEC_MAX_FRAME_SIZE(list->packets[i].size);
+    }
+    printf("%zu packets, %zu payload bytes\n\n", list->count, payloadBytes);
+    printf("%-8s %12s %10s %12s %14s %14s\n", "framing", "link bytes", "overhead", "link time", "encode MB/s", "decode MB/s");
+
+    uint8_t* frame = malloc(maxFrame);
+    for (int f = FRAMING_ESCAPE; f <= FRAMING_COBS; f++) {
+        // framed stream of all packets
+        size_t streamLen = 0;
+        for (size_t i = 0; i < list->count; i++)
+            streamLen += codec_encode(f, list->packets[i].channel, list->packets[i].payload, list->packets[i].size, frame);
+        uint8_t* stream = malloc(streamLen);
+        size_t pos = 0;
+        for (size_t i = 0; i < list->count; i++)
+            pos += codec_encode(f, list->packets[i].channel, list->packets[i].payload, list->packets[i].size, stream + pos);
+
+        double start = now();
+        for (int pass = 0; pass < BENCH_PASSES; pass++)
+            for (size_t i = 0; i < list->count; i++)
+                codec_encode(f, list->packets[i].channel, list->packets[i].payload, list->packets[i].size, frame);
+        double encodeTime = now() - start;
+
+        static Decoder_t decoder;
+        start = now();
+        for (int pass = 0; pass < BENCH_PASSES; pass++) {
+            codec_decoderInit(&decoder, f);
+            codec_decode(&decoder, stream, streamLen, NULL, NULL);
+        }
+        double decodeTime = now() - start;
+        if (decoder.packets != list->count || decoder.errors != 0)
+            fprintf(stderr, "warning: decoded %u packets with %u errors\n", decoder.packets, decoder.errors);
+
+        double mb = (double)streamLen * BENCH_PASSES / 1e6;
+        printf("%-8s %12zu %9.1f%% %10.3f s %14.1f %14.1f\n", f == FRAMING_COBS ? "cobs" : "escape", streamLen,
+               100.0 * (streamLen - payloadBytes) / (payloadBytes ? payloadBytes : 1),
+               streamLen * 10.0 / LINK_BAUD_RATE, mb / encodeTime, mb / decodeTime);
+        free(stream);
+    }
+    free(frame);
+}
+
+
+static void usage(void) {
+    fprintf(stderr,
+        "usage: framing encode <escape|cobs> <channel> [payload file]\n"
+        "       framing decode <escape|cobs> [stream file]\n"
+        "       framing convert <escape|cobs> <escape|cobs> [stream file]\n"
+        "       framing bench [capture file]\n"
+        "       framing trace <escape|cobs> [stream file]\n");
+    exit(2);
+}
+
+
+int main(int argc, char** argv) {
+    static Decoder_t decoder;
+    Framing_t framing, target;
+    size_t len;
+
+    if (argc < 2)
+        usage();
+
+    if (strcmp(argv[1], "encode") == 0 && argc >= 4 && codec_parseFraming(argv[2], &framing)) {
+        uint8_t* payload = readAll(argc > 4 ? argv[4] : NULL, &len);
+        if (len > CODEC_MAX_PAYLOAD) {
+            fprintf(stderr, "payload exceeds %d bytes\n", CODEC_MAX_PAYLOAD);
+            return 1;
+        }
+        writePacket(&framing, (uint8_t)atoi(argv[3]), payload, (uint16_t)len);
+        free(payload);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "decode") == 0 && argc >= 3 && codec_parseFraming(argv[2], &framing)) {
+        uint8_t* data = readAll(argc > 3 ? argv[3] : NULL, &len);
+        codec_decoderInit(&decoder, framing);
+        codec_decode(&decoder, data, len, printPacket, NULL);
+        fprintf(stderr, "%u packets, %u errors\n", decoder.packets, decoder.errors);
+        free(data);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "convert") == 0 && argc >= 4 && codec_parseFraming(argv[2], &framing) && codec_parseFraming(argv[3], &target)) {
+        uint8_t* data = readAll(argc > 4 ? argv[4] : NULL, &len);
+        codec_decoderInit(&decoder, framing);
+        codec_decode(&decoder, data, len, writePacket, &target);
+        fprintf(stderr, "%u packets, %u errors\n", decoder.packets, decoder.errors);
+        free(data);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "trace") == 0 && argc >= 3 && codec_parseFraming(argv[2], &framing)) {
+        unsigned dumps = 0;
+        uint8_t* data = readAll(argc > 3 ? argv[3] : NULL, &len);
+        printf("dump,sample,time_ms,encoder1,encoder2,pwm_left,pwm_right,theta_mrad,ir_left,ir_right,ir_front,queue_iterating,task_active,follower_enabled\n");
+        codec_decoderInit(&decoder, framing);
+        codec_decode(&decoder, data, len, printTrace, &dumps);
+        fprintf(stderr, "%u dumps, %u packets, %u errors\n", dumps, decoder.packets, decoder.errors);
+        free(data);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "bench") == 0) {
+        PacketList_t list = { 0 };
+        if (argc > 2) {
+            uint8_t* data = readAll(argv[2], &len);
+            codec_decoderInit(&decoder, FRAMING_ESCAPE);
+            codec_decode(&decoder, data, len, addPacket, &list);
+            free(data);
+            printf("capture %s: ", argv[2]);
+        } else {
+            syntheticTraffic(&list);
+            printf("synthetic traffic (60 s): ");
+        }
+        bench(&list);
+        return 0;
+    }
+
+    usage();
+    return 2;
+}
@@ -0,0 +1,596 @@
+/**
+ * @file hwpcs.c
+ *
+ * Stand-in for HWPCS on the PC: speaks the framed protocol of the
+ * communication library on a serial port or on a pseudo-terminal (e.g. for the
+ * host build of the firmware, tools/replay/robot) for testing and
+ * benchmarking the link without the lab PC.
+ *
+ * Usage:
+ *   hwpcs [options] pty
+ *       create a pseudo-terminal and print the name of its slave device, e.g.
+ *       for <code>tools/replay/robot /dev/pts/3</code>
+ *   hwpcs [options] <serial device>
+ *       use a serial port at 500000 baud, e.g. /dev/ttyUSB0
+ *
+ * Options:
+ *   -f escape|cobs   framing of the link (default: escape)
+ *   -l <ms>          latency of the answers to GetPose_t (default: 100)
+ *   -p <x,y,theta>   pose answered to GetPose_t in mm and rad (default: 0,0,0)
+ *   -r <ms>          interval of the round-trip probes, 0 for none (default: 1000)
+ *   -s <s>           interval of the statistics, 0 for only at exit (default: 5)
+ *   -v               print all decoded packets, not only log messages
+ *
+ * Commands on stdin:
+ *   cmd <id>                  send UserCommand_t
+ *   drive <speed> <steering>  send DriveCommand_t
+ *   path <x,y> [<x,y> ...]    upload a path to the path follower (mm)
+ *   follow start|pause|reset  control the path follower
+ *   pose <x> <y> <theta>      set the pose answered to GetPose_t
+ *   latency <ms>              set the latency of the answers to GetPose_t
+ *   stats                     print the statistics
+ *   quit                      exit (as well as end of stdin or Ctrl-C)
+ *
+ * Round-trip probes (Ping_t) are sent on CH_IN_PING and echoed by the robot on
+ * CH_OUT_PING. Probes of the robot on CH_OUT_PING are echoed immediately. Pose
+ * requests with sequence number (GetPoseSeq_t) are answered with PoseSeq_t.
+ */
+
+#define _GNU_SOURCE
+
+#include "../framing/codec.h"
+
+#include <communication/packetTypes.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// Number of communication channels per direction
+#define CHANNELS 16
+
+// Maximum number of GetPose_t requests waiting for their answer
+#define MAX_PENDING_POSES 16
+
+// Maximum number of path points per upload
+#define MAX_PATH_POINTS 64
+
+// Probes not answered within this time (ms) are counted as lost
+#define PROBE_TIMEOUT 1000
+
+
+// Packet and payload byte counters of one channel
+typedef struct {
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t errors; // packets with a payload size not matching the channel
+} Counter_t;
+
+typedef struct {
+    double due; // ms
+    AprilTagType_t type;
+    int seq; // sequence number of GetPoseSeq_t, -1 for GetPose_t
+} PendingPose_t;
+
+
+static int fd = -1;
+static Framing_t framing = FRAMING_ESCAPE;
+static bool verbose = false;
+static volatile sig_atomic_t quit = 0;
+
+static Decoder_t decoder;
+
+// statistics: total and since the last report
+static Counter_t rxTotal[CHANNELS], rxInterval[CHANNELS];
+static Counter_t txTotal[CHANNELS], txInterval[CHANNELS];
+static double startTime, intervalStart;
+
+// answers to GetPose_t
+static Pose_t pose = { 0.0f, 0.0f, 0.0f };
+static double poseLatency = 100.0;
+static PendingPose_t pendingPoses[MAX_PENDING_POSES];
+static unsigned pendingPoseCount = 0;
+static uint64_t posesDropped = 0;
+
+// round-trip probes
+static double probeInterval = 1000.0;
+static bool probeOutstanding = false;
+static double probeSent = 0.0;
+static uint8_t probeSeq = 0;
+static uint64_t probesSent = 0, probesLost = 0, probesAnswered = 0, probesEchoed = 0;
+static double rttMin = 0.0, rttMax = 0.0, rttSum = 0.0;
+
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void onSignal(int sig) {
+    (void)sig;
+    quit = 1;
+}
+
+
+static void writeAll(const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n > 0) {
+            data += n;
+            len -= n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            struct pollfd p = { fd, POLLOUT, 0 };
+            poll(&p, 1, 100);
+        } else {
+            perror("write");
+            exit(1);
+        }
+    }
+}
+
+static void sendPacket(uint8_t channel, const void* payload, uint16_t size) {
+    static uint8_t frame[CODEC_MAX_FRAME_SIZE(CODEC_MAX_PAYLOAD)];
+    writeAll(frame, codec_encode(framing, channel, payload, size, frame));
+    txTotal[channel].packets++;
+    txTotal[channel].bytes += size;
+    txInterval[channel].packets++;
+    txInterval[channel].bytes += size;
+}
+
+
+// Check the payload size of packets from the robot, channels with variable size are not checked
+static bool isValidSize(uint8_t channel, const uint8_t* payload, uint16_t size) {
+    switch (channel) {
+        case CH_OUT_TELEMETRY:
+            return size == sizeof(Telemetry_t);
+        case CH_OUT_POSE:
+            return size == sizeof(Pose_t);
+        case CH_OUT_PATH_FOLLOW_STATUS:
+            return size == sizeof(PathFollowerStatus_t);
+        case CH_OUT_GET_POSE:
+            return size == sizeof(GetPose_t) || size == sizeof(GetPoseSeq_t);
+        case CH_OUT_PING:
+            return size == sizeof(Ping_t);
+        case CH_OUT_COMM_STATS: {
+            if (size < sizeof(CommStats_t))
+                return false;
+            CommStats_t stats;
+            memcpy(&stats, payload, sizeof(stats));
+            return size == sizeof(CommStats_t) + __builtin_popcount(stats.channels) * sizeof(CommChannelStats_t);
+        }
+        default:
+            return true;
+    }
+}
+
+static void handleLog(const uint8_t* payload, uint16_t size) {
+    static const char* levels[] = { "SEVERE", "WARNING", "INFO", "FINE", "FINER", "FINEST" };
+    if (size < 1)
+        return;
+    char text[260];
+    size_t len = (size_t)size - 1 < sizeof(text) - 1 ? (size_t)size - 1 : sizeof(text) - 1;
+    memcpy(text, payload + 1, len);
+    text[len] = '\0';
+    printf("[%s] %s\n", payload[0] < 6 ? levels[payload[0]] : "?", text);
+}
+
+static void handlePing(const uint8_t* payload) {
+    Ping_t ping;
+    memcpy(&ping, payload, sizeof(ping));
+
+    if (!(ping.flags & PING_ECHO)) {
+        // probe of the robot
+        ping.flags |= PING_ECHO;
+        sendPacket(CH_IN_PING, &ping, sizeof(ping));
+        probesEchoed++;
+        return;
+    }
+    // echo of our probe, late echoes were already counted as lost
+    if (!probeOutstanding || ping.seq != probeSeq)
+        return;
+    double rtt = now() - (ping.time_ms + ping.time_us / 1000.0);
+    if (probesAnswered == 0 || rtt < rttMin)
+        rttMin = rtt;
+    if (rtt > rttMax)
+        rttMax = rtt;
+    rttSum += rtt;
+    probesAnswered++;
+    probeOutstanding = false;
+    if (verbose)
+        printf("ping %u: %.3f ms\n", ping.seq, rtt);
+}
+
+static void handleCommStats(const uint8_t* payload) {
+    static const char* errors[] = { "buffer full", "too small", "header checksum", "size mismatch",
+                                    "checksum", "unregistered channel", "out of memory", "rx overflow" };
+    CommStats_t stats;
+    memcpy(&stats, payload, sizeof(stats));
+    printf("robot stats at %u ms: tx stalls %u (%.3f ms)", stats.timestamp, stats.txStalls, stats.txStallTime / 1000.0);
+    for (int i = 0; i < 8; i++) {
+        if (stats.errors[i])
+            printf(", %s %u", errors[i], stats.errors[i]);
+    }
+    printf("\n");
+
+    const uint8_t* p = payload + sizeof(stats);
+    for (int ch = 0; ch < CHANNELS; ch++) {
+        if (!(stats.channels & (1 << ch)))
+            continue;
+        CommChannelStats_t c;
+        memcpy(&c, p, sizeof(c));
+        p += sizeof(c);
+        printf("  channel %d: sent %u (%u B), dropped %u, received %u (%u B)\n", ch, c.sent, c.sentBytes,
+               c.dropped, c.received, c.receivedBytes);
+    }
+}
+
+static void handlePacket(void* ctx, uint8_t channel, const uint8_t* payload, uint16_t size) {
+    (void)ctx;
+    rxTotal[channel].packets++;
+    rxTotal[channel].bytes += size;
+    rxInterval[channel].packets++;
+    rxInterval[channel].bytes += size;
+
+    if (!isValidSize(channel, payload, size)) {
+        rxTotal[channel].errors++;
+        rxInterval[channel].errors++;
+        return;
+    }
+
+    switch (channel) {
+        case CH_OUT_DEBUG:
+            handleLog(payload, size);
+            break;
+        case CH_OUT_PING:
+            handlePing(payload);
+            break;
+        case CH_OUT_COMM_STATS:
+            if (verbose)
+                handleCommStats(payload);
+            break;
+        case CH_OUT_GET_POSE: {
+            GetPoseSeq_t request;
+            memcpy(&request, payload, size);
+            if (pendingPoseCount < MAX_PENDING_POSES) {
+                pendingPoses[pendingPoseCount].due = now() + poseLatency;
+                pendingPoses[pendingPoseCount].type = request.aprilTagType;
+                pendingPoses[pendingPoseCount].seq = size == sizeof(GetPoseSeq_t) ? request.seq : -1;
+                pendingPoseCount++;
+            } else {
+                posesDropped++;
+            }
+            if (verbose)
+                printf("pose request (%s)\n", request.aprilTagType == APRIL_TAG_MAIN ? "main" : "additional");
+            break;
+        }
+        case CH_OUT_TELEMETRY:
+            if (verbose) {
+                Telemetry_t t;
+                memcpy(&t, payload, sizeof(t));
+                printf("telemetry: contacts %u, encoders %d/%d, infrared %u/%u/%u mm, user %d/%g\n", t.contacts,
+                       t.encoder1, t.encoder2, t.infrared1, t.infrared2, t.infrared3, t.user1, t.user2);
+            }
+            break;
+        case CH_OUT_POSE:
+            if (verbose) {
+                Pose_t p;
+                memcpy(&p, payload, sizeof(p));
+                printf("pose: x %.1f mm, y %.1f mm, theta %.3f rad\n", p.x, p.y, p.theta);
+            }
+            break;
+        case CH_OUT_PATH_FOLLOW_STATUS:
+            if (verbose) {
+                PathFollowerStatus_t s;
+                memcpy(&s, payload, sizeof(s));
+                printf("path follower: %s, segment (%d,%d)-(%d,%d), lookahead (%.1f,%.1f)\n",
+                       s.enabled ? "enabled" : "disabled", s.segStart.x, s.segStart.y, s.segEnd.x,
+                       s.segEnd.y, s.lookahead.x, s.lookahead.y);
+            }
+            break;
+        default:
+            if (verbose)
+                printf("channel %u: %u bytes\n", channel, size);
+            break;
+    }
+}
+
+
+static void answerPoses(double t) {
+    unsigned kept = 0;
+    for (unsigned i = 0; i < pendingPoseCount; i++) {
+        if (pendingPoses[i].due <= t) {
+            uint8_t channel = pendingPoses[i].type == APRIL_TAG_MAIN ? CH_IN_POSE : CH_IN_ADDITIONAL_POSE;
+            if (pendingPoses[i].seq >= 0) {
+                PoseSeq_t answer = { pose, (uint8_t)pendingPoses[i].seq };
+                sendPacket(channel, &answer, sizeof(answer));
+            } else {
+                sendPacket(channel, &pose, sizeof(pose));
+            }
+        } else
+            pendingPoses[kept++] = pendingPoses[i];
+    }
+    pendingPoseCount = kept;
+}
+
+static void sendProbe(double t) {
+    if (probeOutstanding)
+        probesLost++;
+    Ping_t ping = { 0, ++probeSeq, (uint32_t)t, (uint16_t)((t - (uint32_t)t) * 1000.0) };
+    sendPacket(CH_IN_PING, &ping, sizeof(ping));
+    probeOutstanding = true;
+    probeSent = t;
+    probesSent++;
+}
+
+static void printStats(bool total) {
+    double t = now();
+    double seconds = (t - (total ? startTime : intervalStart)) / 1000.0;
+    Counter_t* rx = total ? rxTotal : rxInterval;
+    Counter_t* tx = total ? txTotal : txInterval;
+
+    fprintf(stderr, "--- %s %.1f s ---\n", total ? "total" : "last", seconds);
+    fprintf(stderr, " ch   rx packets   rx B/s  errors   tx packets   tx B/s\n");
+    for (int ch = 0; ch < CHANNELS; ch++) {
+        if (!rx[ch].packets && !tx[ch].packets)
+            continue;
+        fprintf(stderr, "%3d %12llu %8.0f %7llu %12llu %8.0f\n", ch, (unsigned long long)rx[ch].packets,
+                rx[ch].bytes / seconds, (unsigned long long)rx[ch].errors,
+                (unsigned long long)tx[ch].packets, tx[ch].bytes / seconds);
+    }
+    fprintf(stderr, "invalid frames %u, unanswered pose requests %llu\n", decoder.errors,
+            (unsigned long long)posesDropped);
+    if (probesAnswered)
+        fprintf(stderr, "round trip min/avg/max %.2f/%.2f/%.2f ms, probes %llu, lost %llu\n", rttMin,
+                rttSum / probesAnswered, rttMax, (unsigned long long)probesSent, (unsigned long long)probesLost);
+    else if (probesSent)
+        fprintf(stderr, "round trip: no answer to %llu probes\n", (unsigned long long)probesSent);
+    if (probesEchoed)
+        fprintf(stderr, "echoed probes of the robot %llu\n", (unsigned long long)probesEchoed);
+
+    if (!total) {
+        memset(rxInterval, 0, sizeof(rxInterval));
+        memset(txInterval, 0, sizeof(txInterval));
+        intervalStart = t;
+    }
+}
+
+
+static void handleCommand(char* line) {
+    char* cmd = strtok(line, " \t\r\n");
+    if (!cmd)
+        return;
+
+    if (strcmp(cmd, "cmd") == 0) {
+        char* arg = strtok(NULL, " \t\r\n");
+        if (arg) {
+            UserCommand_t c = { (uint8_t)atoi(arg) };
+            sendPacket(CH_IN_USER_COMMAND, &c, sizeof(c));
+            return;
+        }
+    } else if (strcmp(cmd, "drive") == 0) {
+        char* speed = strtok(NULL, " \t\r\n");
+        char* steering = strtok(NULL, " \t\r\n");
+        if (speed && steering) {
+            DriveCommand_t d = { (int16_t)atoi(speed), (int16_t)atoi(steering) };
+            sendPacket(CH_IN_DRIVE, &d, sizeof(d));
+            return;
+        }
+    } else if (strcmp(cmd, "path") == 0) {
+        uint8_t buf[sizeof(PathFollowerControl_t) + MAX_PATH_POINTS * sizeof(Point_t)];
+        PathFollowerControl_t* ctrl = (PathFollowerControl_t*)buf;
+        ctrl->cmd = FOLLOWER_CMD_NEWPATH;
+        ctrl->pathLength = 0;
+        char* point;
+        while ((point = strtok(NULL, " \t\r\n")) && ctrl->pathLength < MAX_PATH_POINTS) {
+            int x, y;
+            if (sscanf(point, "%d,%d", &x, &y) != 2)
+                break;
+            Point_t p = { (int16_t)x, (int16_t)y };
+            memcpy(&ctrl->points[ctrl->pathLength++], &p, sizeof(p));
+        }
+        if (ctrl->pathLength > 0) {
+            sendPacket(CH_IN_PATH_FOLLOW_CTRL, buf, sizeof(PathFollowerControl_t) + ctrl->pathLength * sizeof(Point_t));
+            return;
+        }
+    } else if (strcmp(cmd, "follow") == 0) {
+        char* arg = strtok(NULL, " \t\r\n");
+        PathFollowerControl_t ctrl = { FOLLOWER_CMD_START, 0 };
+        if (arg && (strcmp(arg, "start") == 0 || strcmp(arg, "pause") == 0 || strcmp(arg, "reset") == 0)) {
+            ctrl.cmd = arg[0] == 's' ? FOLLOWER_CMD_START : arg[0] == 'p' ? FOLLOWER_CMD_PAUSE : FOLLOWER_CMD_RESET;
+            sendPacket(CH_IN_PATH_FOLLOW_CTRL, &ctrl, sizeof(ctrl));
+            return;
+        }
+    } else if (strcmp(cmd, "pose") == 0) {
+        char* x = strtok(NULL, " \t\r\n");
+        char* y = strtok(NULL, " \t\r\n");
+        char* theta = strtok(NULL, " \t\r\n");
+        if (x && y && theta) {
+            pose.x = atof(x);
+            pose.y = atof(y);
+            pose.theta = atof(theta);
+            return;
+        }
+    } else if (strcmp(cmd, "latency") == 0) {
+        char* arg = strtok(NULL, " \t\r\n");
+        if (arg) {
+            poseLatency = atof(arg);
+            return;
+        }
+    } else if (strcmp(cmd, "stats") == 0) {
+        printStats(true);
+        return;
+    } else if (strcmp(cmd, "quit") == 0) {
+        quit = 1;
+        return;
+    }
+    fprintf(stderr, "invalid command: %s\n", cmd);
+}
+
+
+static void setRaw(int tty, bool serial) {
+    struct termios tio;
+    if (tcgetattr(tty, &tio) != 0) {
+        perror("tcgetattr");
+        exit(1);
+    }
+    cfmakeraw(&tio);
+    if (serial)
+        cfsetspeed(&tio, B500000);
+    if (tcsetattr(tty, TCSANOW, &tio) != 0) {
+        perror("tcsetattr");
+        exit(1);
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: hwpcs [-f escape|cobs] [-l ms] [-p x,y,theta] [-r ms] [-s s] [-v] pty|<serial device>\n");
+    exit(2);
+}
+
+
+int main(int argc, char** argv) {
+    double statsInterval = 5000.0;
+    const char* device = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            device = argv[i];
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else if (i + 1 < argc) {
+            const char* arg = argv[++i];
+            if (strcmp(argv[i - 1], "-f") == 0) {
+                if (!codec_parseFraming(arg, &framing))
+                    usage();
+            } else if (strcmp(argv[i - 1], "-l") == 0) {
+                poseLatency = atof(arg);
+            } else if (strcmp(argv[i - 1], "-p") == 0) {
+                if (sscanf(arg, "%f,%f,%f", &pose.x, &pose.y, &pose.theta) != 3)
+                    usage();
+            } else if (strcmp(argv[i - 1], "-r") == 0) {
+                probeInterval = atof(arg);
+            } else if (strcmp(argv[i - 1], "-s") == 0) {
+                statsInterval = atof(arg) * 1000.0;
+            } else {
+                usage();
+            }
+        } else {
+            usage();
+        }
+    }
+    if (!device)
+        usage();
+
+    int slave = -1;
+    if (strcmp(device, "pty") == 0) {
+        fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+            perror("pty");
+            return 1;
+        }
+        // keep the slave open, so that the link survives restarts of the robot
+        slave = open(ptsname(fd), O_RDWR | O_NOCTTY);
+        if (slave < 0) {
+            perror(ptsname(fd));
+            return 1;
+        }
+        setRaw(slave, false);
+        fprintf(stderr, "robot link: %s\n", ptsname(fd));
+    } else {
+        fd = open(device, O_RDWR | O_NOCTTY);
+        if (fd < 0) {
+            perror(device);
+            return 1;
+        }
+        setRaw(fd, true);
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    codec_decoderInit(&decoder, framing);
+    startTime = intervalStart = now();
+    double nextProbe = startTime + probeInterval;
+    double nextStats = startTime + statsInterval;
+
+    char line[1024];
+    size_t lineLen = 0;
+    bool stdinOpen = true;
+
+    while (!quit) {
+        double t = now();
+        answerPoses(t);
+        if (probeOutstanding && t - probeSent > PROBE_TIMEOUT) {
+            probesLost++;
+            probeOutstanding = false;
+        }
+        if (probeInterval > 0 && t >= nextProbe) {
+            sendProbe(t);
+            nextProbe += probeInterval;
+        }
+        if (statsInterval > 0 && t >= nextStats) {
+            printStats(false);
+            nextStats += statsInterval;
+        }
+
+        // sleep until the next answer, probe or report is due
+        double wait = 100.0;
+        for (unsigned i = 0; i < pendingPoseCount; i++) {
+            if (pendingPoses[i].due - t < wait)
+                wait = pendingPoses[i].due - t;
+        }
+        if (probeInterval > 0 && nextProbe - t < wait)
+            wait = nextProbe - t;
+        if (statsInterval > 0 && nextStats - t < wait)
+            wait = nextStats - t;
+
+        struct pollfd fds[2] = { { fd, POLLIN, 0 }, { STDIN_FILENO, POLLIN, 0 } };
+        if (poll(fds, stdinOpen ? 2 : 1, wait > 0 ? (int)wait + 1 : 0) < 0)
+            continue; // interrupted by a signal
+
+        if (fds[0].revents & POLLIN) {
+            uint8_t buf[4096];
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n > 0)
+                codec_decode(&decoder, buf, n, handlePacket, NULL);
+        } else if (fds[0].revents & (POLLHUP | POLLERR)) {
+            fprintf(stderr, "link closed\n");
+            break;
+        }
+
+        if (stdinOpen && (fds[1].revents & (POLLIN | POLLHUP))) {
+            ssize_t n = read(STDIN_FILENO, line + lineLen, sizeof(line) - 1 - lineLen);
+            if (n <= 0) {
+                stdinOpen = false;
+                quit = 1;
+            } else {
+                lineLen += n;
+                char* end;
+                while ((end = memchr(line, '\n', lineLen)) != NULL) {
+                    *end = '\0';
+                    handleCommand(line);
+                    lineLen -= end + 1 - line;
+                    memmove(line, end + 1, lineLen);
+                }
+                if (lineLen == sizeof(line) - 1)
+                    lineLen = 0; // line too long
+            }
+        }
+    }
+
+    printStats(true);
+    if (slave >= 0)
+        close(slave);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file hardware.c
+ *
+ * Host replacement of the hardware used by the firmware, see hardware.h.
+ */
+
+#include "hardware.h"
+
+#include <io/uart/uart.h>
+#include <io/adc/adc.h>
+#include <motor/motor.h>
+#include <tools/timeTask/timeTask.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+volatile uint8_t replay_io[20];
+volatile uint16_t replay_io16[2];
+
+uint16_t replay_uptime = 0;
+uint16_t replay_adc[3];
+int16_t replay_pwm[2];
+
+// RX buffer of the communication UART
+static uint8_t* rxBuf = NULL;
+static size_t rxLen = 0;
+static size_t rxPos = 0;
+static size_t rxCapacity = 0;
+
+static uint64_t transmitted = 0;
+static void (*transmitHandler)(const uint8_t* data, size_t len) = NULL;
+
+// emulated TX buffer, see replay_setLinkRate()
+static uint16_t linkRate = 0;
+static uint32_t txPending = 0;
+static uint16_t txDrainTime = 0;
+
+
+void replay_receive(const uint8_t* data, size_t len) {
+    if (rxPos == rxLen)
+        rxPos = rxLen = 0;
+    if (rxLen + len > rxCapacity) {
+        rxCapacity = (rxLen + len) * 2;
+        rxBuf = realloc(rxBuf, rxCapacity);
+        if (!rxBuf)
+            abort();
+    }
+    memcpy(rxBuf + rxLen, data, len);
+    rxLen += len;
+}
+
+uint64_t replay_getTransmitted(void) {
+    return transmitted;
+}
+
+void replay_setTransmitHandler(void (*handler)(const uint8_t* data, size_t len)) {
+    transmitHandler = handler;
+}
+
+void replay_setLinkRate(uint16_t bytesPerMs) {
+    linkRate = bytesPerMs;
+    txPending = 0;
+    txDrainTime = replay_uptime;
+}
+
+static void drainTX(void) {
+    uint32_t drained = (uint32_t)(uint16_t)(replay_uptime - txDrainTime) * linkRate;
+    txDrainTime = replay_uptime;
+    txPending = drained >= txPending ? 0 : txPending - drained;
+}
+
+
+// UART: without link rate, the TX buffer never fills up, as the host is
+// infinitely fast compared to the serial link
+void uart_init(void) {
+}
+
+uint8_t uart_read1(void) {
+    return rxPos < rxLen ? rxBuf[rxPos++] : 0;
+}
+
+bool uart_available1(void) {
+    return rxPos < rxLen;
+}
+
+void uart_write1(const uint8_t data) {
+    if (transmitHandler)
+        transmitHandler(&data, 1);
+    transmitted++;
+    if (linkRate)
+        txPending++;
+}
+
+bool uart_writeBlock1(const uint8_t* data, const uint8_t len) {
+    if (transmitHandler)
+        transmitHandler(data, len);
+    transmitted += len;
+    if (linkRate)
+        txPending += len;
+    return true;
+}
+
+uint8_t uart_getTXBufSpace1(void) {
+    if (!linkRate)
+        return UART1_TX_BUFFER_SIZE - 1;
+    drainTX();
+    return txPending >= UART1_TX_BUFFER_SIZE - 1 ? 0 : UART1_TX_BUFFER_SIZE - 1 - txPending;
+}
+
+bool uart_isRXBufOverflow1(void) {
+    return false;
+}
+
+
+// motors
+void Motor_init(void) {
+}
+
+void Motor_setPWM_A(const int16_t pwm) {
+    replay_pwm[0] = pwm;
+}
+
+void Motor_setPWM_B(const int16_t pwm) {
+    replay_pwm[1] = pwm;
+}
+
+void Motor_setPWM(const int16_t pwmA, const int16_t pwmB) {
+    replay_pwm[0] = pwmA;
+    replay_pwm[1] = pwmB;
+}
+
+void Motor_stopA(void) {
+    replay_pwm[0] = 0;
+}
+
+void Motor_stopB(void) {
+    replay_pwm[1] = 0;
+}
+
+void Motor_stopAll(void) {
+    replay_pwm[0] = replay_pwm[1] = 0;
+}
+
+
+// ADC
+void ADC_init(const bool disableJTAG) {
+    (void)disableJTAG;
+}
+
+uint16_t ADC_getFilteredValue(const uint8_t channel) {
+    return replay_adc[channel];
+}
+
+uint16_t ADC_getLastValue(const uint8_t channel) {
+    return replay_adc[channel];
+}
+
+
+// timer
+void timeTask_init(void) {
+}
+
+void timeTask_getTimestamp(timeTask_time_t* timestamp) {
+    timestamp->time_ms = replay_uptime;
+    timestamp->time_us = 0;
+}
+
+uint32_t timeTask_getDuration(const timeTask_time_t* startTime, const timeTask_time_t* stopTime) {
+    return ((stopTime->time_ms - startTime->time_ms) * 1000) + ((int16_t)stopTime->time_us - (int16_t)startTime->time_us);
+}
+
+
+// vsnprintf_P() of avr-libc, there is only one address space
+int vsnprintf_P(char* s, size_t n, const char* format, va_list ap) {
+    return vsnprintf(s, n, format, ap);
+}
+
+
+// rand() and srand() of avr-libc (the firmware is compiled with
+// -Drand=replay_rand -Dsrand=replay_srand), so that random decisions, e.g. of
+// the explorer, are the same as on the robot
+static unsigned long randNext = 1;
+
+int replay_rand(void) {
+    long x = randNext;
+    if (x == 0)
+        x = 123459876L;
+    long hi = x / 127773L;
+    long lo = x % 127773L;
+    x = 16807L * lo - 2836L * hi;
+    if (x < 0)
+        x += 0x7fffffffL;
+    randNext = x;
+    return x % (0x7fff + 1UL);
+}
+
+void replay_srand(unsigned int seed) {
+    randNext = seed;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file hardware.h
+ *
+ * Host replacement of the hardware used by the firmware (UART, motors, ADC,
+ * timer) for tools/replay. The replay sets the inputs below before each
+ * iteration of the main loop; the outputs (motor PWM) are taken from the
+ * firmware itself.
+ */
+
+#ifndef HARDWARE_H_
+#define HARDWARE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/**
+ * Uptime in milliseconds seen by the firmware (wraps like the real uptime)
+ */
+extern uint16_t replay_uptime;
+
+/**
+ * Filtered values of the ADC channels
+ */
+extern uint16_t replay_adc[3];
+
+/**
+ * PWM values last set for motor A (left) and B (right). Read these instead of
+ * getPWM_left()/getPWM_right() outside of robot_loop(): the getters begin a
+ * section of the main loop (src/driving/control.h), which is counted.
+ */
+extern int16_t replay_pwm[2];
+
+
+/**
+ * Compare ISR of Timer 1 in src/driving/control.c: one step of the control
+ * tier with the current uptime and encoder counts. robot.c calls it every
+ * CONTROL_INTERVAL ms of simulated time between two iterations; the replay
+ * runs the recorded steps instead.
+ */
+void TIMER1_COMPA_vect(void);
+
+
+/**
+ * Append bytes to the RX buffer of the communication UART. They are read by the
+ * next call of communication_readPackets().
+ *
+ * @param   data      received bytes
+ * @param   len       number of bytes
+ */
+void replay_receive(const uint8_t* data, size_t len);
+
+/**
+ * Number of bytes written to the communication UART so far
+ */
+uint64_t replay_getTransmitted(void);
+
+/**
+ * Set a handler for the bytes written to the communication UART, e.g. for
+ * forwarding them to a serial link (robot.c). Without handler, they are
+ * discarded.
+ *
+ * @param   handler   function receiving the written bytes, NULL to discard them
+ */
+void replay_setTransmitHandler(void (*handler)(const uint8_t* data, size_t len));
+
+/**
+ * Emulate the TX buffer of the UART draining at the rate of the serial link,
+ * so that the firmware drops packets like on the robot if the link is busy.
+ * By default (0) the TX buffer is always empty.
+ *
+ * @param   bytesPerMs   transmitted bytes per ms of uptime, e.g. 50 at 500000 baud
+ */
+void replay_setLinkRate(uint16_t bytesPerMs);
+
+#endif /* HARDWARE_H_ */
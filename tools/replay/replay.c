@@ -0,0 +1,368 @@
+/**
+ * @file replay.c
+ *
+ * Replays a recording of the inputs of the main loop (src/telemetry/record.h,
+ * firmware built with RECORD_INPUTS) on the PC.
+ *
+ * The firmware sources are compiled for the host and each recorded iteration
+ * is executed with robot_loop(): the recorded uptime, encoder and bumper
+ * counts and ADC values are set as inputs, the recorded packets are fed to the
+ * UART in the order the robot handled them. After each iteration the PWM
+ * values and the task queue state are compared with the recorded ones.
+ *
+ * The control tier runs in a timer interrupt on the robot (src/driving/
+ * control.h). Its recorded steps are not run between iterations but before
+ * the section of the main loop they preceded on the robot (section hook of
+ * the control tier), so they see and change the same state.
+ *
+ * Usage:
+ *   replay [-f escape|cobs] [-q] [capture file]
+ *       capture of the serial link (stdin if no file is given), e.g. recorded
+ *       with <code>cat /dev/ttyUSB0 > capture.bin</code>
+ *       -f   framing of the capture (default: escape)
+ *       -q   only report the result, no decision log
+ *
+ * Exit code: 0 if the replay reproduced all recorded decisions, 1 on the first
+ * divergence, 2 if the recording is invalid.
+ *
+ * Note that the host only approximates the AVR: int has 32 instead of 16 bits
+ * and transcendental functions (sin, atan2, ...) may differ in the last bit.
+ * Code depending on either shows up as a divergence.
+ */
+
+#include "hardware.h"
+#include "../framing/codec.h"
+
+#include <main.h>
+#include <driving/control.h>
+#include <sensors/ISRCustom.h>
+#include <sensors/sensors.h>
+#include <tasks/taskManagement.h>
+
+#include <communication/communication.h>
+#include <communication/packetTypes.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+// Events of the recording (payloads of CH_OUT_RECORD without RecordHeader_t)
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t capacity;
+    uint32_t packets;
+    bool started;
+    uint8_t seq;
+    bool lost; // sequence gap: events after the gap are ignored
+} Recording_t;
+
+// Decisions compared after each iteration
+typedef struct {
+    int32_t pwmLeft;
+    int32_t pwmRight;
+    uint32_t queueSize;
+    uint8_t state;
+} Decision_t;
+
+// Reader of the event stream
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+    bool truncated; // the stream ended within an event
+} Reader_t;
+
+
+// Recorded steps of the control tier which have not run yet
+static ControlInputs_t* pending = NULL;
+static size_t pendingHead = 0;
+static size_t pendingCount = 0;
+static size_t pendingCapacity = 0;
+
+
+static uint8_t* readAll(const char* path, size_t* len) {
+    FILE* f = path ? fopen(path, "rb") : stdin;
+    if (!f) {
+        perror(path);
+        exit(2);
+    }
+    size_t capacity = 4096;
+    uint8_t* data = malloc(capacity);
+    *len = 0;
+    size_t n;
+    while (data && (n = fread(data + *len, 1, capacity - *len, f)) > 0) {
+        *len += n;
+        if (*len == capacity)
+            data = realloc(data, capacity *= 2);
+    }
+    if (!data) {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+    if (path)
+        fclose(f);
+    return data;
+}
+
+static void collectRecord(void* ctx, uint8_t channel, const uint8_t* payload, uint16_t size) {
+    Recording_t* rec = ctx;
+    if (channel != CH_OUT_RECORD || size < sizeof(RecordHeader_t) || rec->lost)
+        return;
+    const RecordHeader_t* header = (const RecordHeader_t*)payload;
+    if (rec->started && header->seq != (uint8_t)(rec->seq + 1)) {
+        fprintf(stderr, "record packet %u lost, replaying up to packet %u\n", (uint8_t)(rec->seq + 1), rec->seq);
+        rec->lost = true;
+        return;
+    }
+    rec->started = true;
+    rec->seq = header->seq;
+    rec->packets++;
+
+    size -= sizeof(RecordHeader_t);
+    if (rec->len + size > rec->capacity) {
+        rec->capacity = (rec->len + size) * 2;
+        rec->data = realloc(rec->data, rec->capacity);
+        if (!rec->data) {
+            fprintf(stderr, "out of memory\n");
+            exit(2);
+        }
+    }
+    memcpy(rec->data + rec->len, payload + sizeof(RecordHeader_t), size);
+    rec->len += size;
+}
+
+
+static uint8_t getByte(Reader_t* r) {
+    if (r->pos >= r->len) {
+        r->truncated = true;
+        return 0;
+    }
+    return r->data[r->pos++];
+}
+
+static uint32_t getVarint(Reader_t* r) {
+    uint32_t value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        uint8_t byte = getByte(r);
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+    return value;
+}
+
+static int32_t getZigzag(Reader_t* r) {
+    uint32_t v = getVarint(r);
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+
+static void pushControlStep(const ControlInputs_t* step) {
+    if (pendingHead == pendingCount)
+        pendingHead = pendingCount = 0;
+    if (pendingCount == pendingCapacity) {
+        pendingCapacity = pendingCapacity ? pendingCapacity * 2 : 64;
+        pending = realloc(pending, pendingCapacity * sizeof(*pending));
+        if (!pending) {
+            fprintf(stderr, "out of memory\n");
+            exit(2);
+        }
+    }
+    pending[pendingCount++] = *step;
+}
+
+// section hook of the control tier: runs the steps which ran before this section on the robot
+static void runControlSteps(uint16_t section) {
+    while (pendingHead < pendingCount && (int16_t)(pending[pendingHead].section - section) <= 0) {
+        control_step(&pending[pendingHead++]);
+    }
+}
+
+
+// not getPWM_left()/getPWM_right(): they would begin a section of the main loop
+static void getDecision(Decision_t* d) {
+    d->pwmLeft = replay_pwm[0];
+    d->pwmRight = replay_pwm[1];
+    d->queueSize = getTaskQueueSize();
+    d->state = (isTaskQueueIterating() ? 0x01 : 0) | (isTaskActive() ? 0x02 : 0);
+}
+
+static bool equalDecision(const Decision_t* a, const Decision_t* b) {
+    return a->pwmLeft == b->pwmLeft && a->pwmRight == b->pwmRight
+        && a->queueSize == b->queueSize && a->state == b->state;
+}
+
+static void printDecision(const char* label, const Decision_t* d) {
+    printf("%s pwm %d/%d, queue %u, iterating %u, active %u\n", label, d->pwmLeft, d->pwmRight,
+           d->queueSize, d->state & 0x01, (d->state >> 1) & 0x01);
+}
+
+
+int main(int argc, char** argv) {
+    Framing_t framing = FRAMING_ESCAPE;
+    bool quiet = false;
+    const char* path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            if (!codec_parseFraming(argv[++i], &framing)) {
+                fprintf(stderr, "unknown framing: %s\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            fprintf(stderr, "usage: %s [-f escape|cobs] [-q] [capture file]\n", argv[0]);
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    // extract the event stream from the capture
+    size_t len;
+    uint8_t* capture = readAll(path, &len);
+    static Decoder_t decoder;
+    static Recording_t rec;
+    codec_decoderInit(&decoder, framing);
+    codec_decode(&decoder, capture, len, collectRecord, &rec);
+    free(capture);
+
+    Reader_t r = { rec.data, rec.len, 0, false };
+    if (getByte(&r) != RECORD_START) {
+        fprintf(stderr, "no recording found (%u packets, %u invalid)\n", decoder.packets, decoder.errors);
+        return 2;
+    }
+
+    // boot the firmware; all received packets are handled in the iteration
+    // they were recorded in, so the read budget must not split them
+    robot_init();
+    robot_setup();
+    communication_setReadBudget(0);
+    control_setSectionHook(runControlSteps);
+
+    replay_uptime = getVarint(&r);
+    counter1EncoderTotal = getZigzag(&r);
+    counter2EncoderTotal = getZigzag(&r);
+    counter1BumperTotal = getVarint(&r);
+    for (uint8_t i = 0; i < SENSORS_INFRARED_COUNT; i++) {
+        replay_adc[i] = getVarint(&r);
+    }
+    // the first control step refers to section 0 and the inputs of RECORD_START
+    ControlInputs_t step = { 0, replay_uptime, counter1EncoderTotal, counter2EncoderTotal };
+    bool controlLost = false;
+
+    Decision_t expected = { 0, 0, 0, 0 };
+    uint64_t iterations = 0;
+    uint32_t packets = 0;
+    uint32_t elapsed = 0; // recorded time in ms
+    uint32_t repeat = 1; // iterations of the current event (RECORD_IDLE)
+    static uint8_t frame[CODEC_MAX_FRAME_SIZE(CODEC_MAX_PAYLOAD)];
+
+    clock_t start = clock();
+
+    while (!r.truncated) {
+        // events of the iteration until the start of the next one
+        size_t iterationStart = r.pos;
+        bool decided = false;
+        while (r.pos < r.len && !r.truncated) {
+            uint8_t event = r.data[r.pos];
+            if (event < RECORD_PACKET)
+                break; // RECORD_TICK or RECORD_IDLE of the next iteration
+            r.pos++;
+            if (event == RECORD_PACKET) {
+                uint8_t channel = getByte(&r);
+                uint32_t size = getVarint(&r);
+                if (r.truncated || size > CODEC_MAX_PAYLOAD || r.len - r.pos < size) {
+                    r.truncated = true;
+                    break;
+                }
+                replay_receive(frame, codec_encode(FRAMING_ESCAPE, channel, r.data + r.pos, size, frame));
+                r.pos += size;
+                packets++;
+            } else if (event == RECORD_DECISION) {
+                Decision_t d;
+                d.pwmLeft = getZigzag(&r);
+                d.pwmRight = getZigzag(&r);
+                d.queueSize = getVarint(&r);
+                d.state = getByte(&r);
+                if (!r.truncated) {
+                    expected = d;
+                    decided = true;
+                }
+            } else if (event == RECORD_CONTROL) {
+                ControlInputs_t next;
+                next.section = step.section + getVarint(&r);
+                next.uptime = step.uptime + getZigzag(&r);
+                next.encoder1Total = step.encoder1Total + getZigzag(&r);
+                next.encoder2Total = step.encoder2Total + getZigzag(&r);
+                if (!r.truncated) {
+                    step = next;
+                    pushControlStep(&step);
+                }
+            } else if (event == RECORD_CONTROL_LOST) {
+                fprintf(stderr, "control steps lost at event offset %zu, replaying up to there\n", r.pos - 1);
+                controlLost = true;
+                break;
+            } else {
+                fprintf(stderr, "invalid event 0x%02X at offset %zu\n", event, r.pos - 1);
+                return 2;
+            }
+        }
+        // the last iteration of the capture may lack events which were still
+        // buffered on the robot, so only iterations followed by another one are replayed
+        if (r.truncated || r.pos >= r.len || controlLost)
+            break;
+
+        for (; repeat > 0; repeat--) {
+            robot_loop();
+            iterations++;
+
+            Decision_t actual;
+            getDecision(&actual);
+            if (!equalDecision(&actual, &expected)) {
+                printf("divergence in iteration %llu at uptime %u ms (%u ms after start, event offset %zu)\n",
+                       (unsigned long long)iterations, replay_uptime, elapsed, iterationStart);
+                printDecision("  recorded:", &expected);
+                printDecision("  replayed:", &actual);
+                return 1;
+            }
+        }
+        if (!quiet && decided) {
+            printf("%8u ms:", elapsed);
+            printDecision("", &expected);
+        }
+
+        // inputs of the next iteration
+        uint8_t event = getByte(&r);
+        if (event & RECORD_IDLE) {
+            repeat = (event & 0x3F) + 1;
+        } else {
+            repeat = 1;
+            if (event & RECORD_INPUT_UPTIME) {
+                uint16_t delta = getVarint(&r);
+                replay_uptime += delta;
+                elapsed += delta;
+            }
+            if (event & RECORD_INPUT_ENCODER1)
+                counter1EncoderTotal += getZigzag(&r);
+            if (event & RECORD_INPUT_ENCODER2)
+                counter2EncoderTotal += getZigzag(&r);
+            if (event & RECORD_INPUT_BUMPER)
+                counter1BumperTotal += getVarint(&r);
+            for (uint8_t i = 0; i < SENSORS_INFRARED_COUNT; i++) {
+                if (event & (RECORD_INPUT_IR0 << i))
+                    replay_adc[i] += getZigzag(&r);
+            }
+        }
+    }
+
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("replayed %llu iterations, %u packets, %.3f s of recording in %.3f s (%.0fx real time)%s\n",
+           (unsigned long long)iterations, packets, elapsed / 1000.0, seconds,
+           seconds > 0 ? elapsed / 1000.0 / seconds : 0.0, rec.lost || controlLost ? ", recording incomplete" : "");
+    return 0;
+}
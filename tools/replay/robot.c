@@ -0,0 +1,148 @@
+/**
+ * @file robot.c
+ *
+ * Runs the host build of the firmware in real time on a serial link, e.g. on
+ * the pseudo-terminal of tools/hwpcs, for testing and benchmarking the
+ * communication without the robot.
+ *
+ * Usage:
+ *   robot <tty>
+ *
+ * The uptime is the time since start. The motors are simulated by turning the
+ * PWM values into encoder tics (about 150mm/s at PWM 3000), the infrared
+ * sensors read a constant distance and the TX buffer drains at 500000 baud.
+ * The control tier runs every CONTROL_INTERVAL ms of simulated time between
+ * two iterations of the main loop.
+ */
+
+#include "hardware.h"
+
+#include <main.h>
+#include <driving/control.h>
+#include <sensors/ISRCustom.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// Encoder tics per ms and PWM unit: 150mm/s at PWM 3000 with 0.138mm per tic
+#define TICS_PER_MS_PWM (0.150 / 0.138 / 3000)
+
+// Raw ADC value of the infrared sensors (about 130mm)
+#define INFRARED_ADC 250
+
+// Transmitted bytes per ms at 500000 baud (10 bits per byte)
+#define LINK_BYTES_PER_MS 50
+
+// Pause between two iterations of the main loop in us
+#define LOOP_PAUSE 100
+
+
+static int fd = -1;
+
+// bytes written by the firmware during an iteration
+static uint8_t txBuf[64 * 1024];
+static size_t txLen = 0;
+
+
+static void collectTransmitted(const uint8_t* data, size_t len) {
+    if (txLen + len > sizeof(txBuf))
+        len = sizeof(txBuf) - txLen; // the link is hopelessly congested anyway
+    memcpy(txBuf + txLen, data, len);
+    txLen += len;
+}
+
+static void flushTransmitted(void) {
+    size_t pos = 0;
+    while (pos < txLen) {
+        ssize_t n = write(fd, txBuf + pos, txLen - pos);
+        if (n > 0) {
+            pos += n;
+        } else if (n < 0 && errno == EAGAIN) {
+            struct pollfd p = { fd, POLLOUT, 0 };
+            poll(&p, 1, 10);
+        } else {
+            perror("write");
+            exit(1);
+        }
+    }
+    txLen = 0;
+}
+
+static uint64_t getMillis(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <tty>\n", argv[0]);
+        return 2;
+    }
+
+    fd = open(argv[1], O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    replay_setTransmitHandler(collectTransmitted);
+    replay_setLinkRate(LINK_BYTES_PER_MS);
+    for (uint8_t i = 0; i < 3; i++) {
+        replay_adc[i] = INFRARED_ADC;
+    }
+
+    robot_init();
+    robot_setup();
+    flushTransmitted();
+
+    uint64_t start = getMillis();
+    uint64_t simulated = 0; // ms
+    double tics1 = 0, tics2 = 0;
+
+    for (;;) {
+        // advance uptime and encoders to the current time
+        uint64_t now = getMillis() - start;
+        for (; simulated < now; simulated++) {
+            replay_uptime++;
+            // the motors are mounted reversed: negative PWM drives forward
+            tics1 -= replay_pwm[1] * TICS_PER_MS_PWM;
+            tics2 -= replay_pwm[0] * TICS_PER_MS_PWM;
+            int16_t n1 = (int16_t)tics1, n2 = (int16_t)tics2;
+            counter1EncoderTotal += n1;
+            counter2EncoderTotal += n2;
+            tics1 -= n1;
+            tics2 -= n2;
+            // control tier (Timer 1)
+            if (replay_uptime % CONTROL_INTERVAL == 0)
+                TIMER1_COMPA_vect();
+        }
+
+        uint8_t rx[256];
+        ssize_t n = read(fd, rx, sizeof(rx));
+        if (n > 0) {
+            replay_receive(rx, n);
+        } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+            fprintf(stderr, "link closed\n");
+            return 0;
+        }
+
+        robot_loop();
+        flushTransmitted();
+        usleep(LOOP_PAUSE);
+    }
+}
@@ -0,0 +1,31 @@
+/**
+ * @file eeprom.h
+ *
+ * Host replacement of <avr/eeprom.h> for tools/replay: EEMEM variables are
+ * plain RAM, which starts without a valid parameter block like an erased
+ * EEPROM, and every write completes immediately.
+ */
+
+#ifndef REPLAY_AVR_EEPROM_H_
+#define REPLAY_AVR_EEPROM_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define EEMEM
+
+#define eeprom_is_ready() 1
+
+static inline uint8_t eeprom_read_byte(const uint8_t* address) {
+    return *address;
+}
+
+static inline void eeprom_update_byte(uint8_t* address, uint8_t value) {
+    *address = value;
+}
+
+static inline void eeprom_read_block(void* dst, const void* src, size_t n) {
+    memcpy(dst, src, n);
+}
+
+#endif /* REPLAY_AVR_EEPROM_H_ */
@@ -0,0 +1,20 @@
+/**
+ * @file interrupt.h
+ *
+ * Host replacement of <avr/interrupt.h> for tools/replay: ISRs become ordinary
+ * functions which are never called, the inputs they count are set by the
+ * replay instead. Exception: robot.c calls the compare ISR of Timer 1 (control
+ * tier, src/driving/control.h) in simulated time.
+ */
+
+#ifndef REPLAY_AVR_INTERRUPT_H_
+#define REPLAY_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR(vector, ...) void vector(void); void vector(void)
+
+#define sei()
+#define cli()
+
+#endif /* REPLAY_AVR_INTERRUPT_H_ */
@@ -0,0 +1,81 @@
+/**
+ * @file io.h
+ *
+ * Host replacement of <avr/io.h> for tools/replay: the I/O registers used by
+ * the firmware are plain variables without any function.
+ */
+
+#ifndef REPLAY_AVR_IO_H_
+#define REPLAY_AVR_IO_H_
+
+#include <stdint.h>
+
+#define _BV(bit) (1 << (bit))
+
+extern volatile uint8_t replay_io[20];
+extern volatile uint16_t replay_io16[2];
+
+#define GPIOR0  replay_io[0]
+#define PRR0    replay_io[1]
+#define PRR1    replay_io[2]
+#define DDRA    replay_io[3]
+#define PORTA   replay_io[4]
+#define PINB    replay_io[5]
+#define PINJ    replay_io[6]
+#define DDRD    replay_io[7]
+#define PORTD   replay_io[8]
+#define EICRA   replay_io[9]
+#define EIMSK   replay_io[10]
+#define PCICR   replay_io[11]
+#define PCMSK0  replay_io[12]
+#define PCMSK1  replay_io[13]
+#define PIND    replay_io[14]
+#define TCCR1A  replay_io[15]
+#define TCCR1B  replay_io[16]
+#define TIMSK1  replay_io[17]
+#define TIFR1   replay_io[18]
+#define TCCR1C  replay_io[19]
+#define TCNT1   replay_io16[0]
+#define OCR1A   replay_io16[1]
+
+#define PA6 6
+#define PA7 7
+#define PB0 0
+#define PB1 1
+#define PD0 0
+#define PD1 1
+#define DDD0 0
+#define DDD1 1
+#define PJ3 3
+#define PJ4 4
+#define ISC00 0
+#define ISC01 1
+#define ISC10 2
+#define ISC11 3
+#define INT0 0
+#define PCIE0 0
+#define PCIE1 1
+#define PCINT0 0
+#define PCINT1 1
+#define PCINT12 4
+#define PCINT13 5
+#define WGM12 3
+#define CS11 1
+#define OCIE1A 1
+#define OCF1A 1
+
+#define PRADC 0
+#define PRUSART0 1
+#define PRSPI 2
+#define PRTIM1 3
+#define PRTIM0 5
+#define PRTIM2 6
+#define PRTWI 7
+#define PRUSART1 0
+#define PRUSART2 1
+#define PRUSART3 2
+#define PRTIM3 3
+#define PRTIM4 4
+#define PRTIM5 5
+
+#endif /* REPLAY_AVR_IO_H_ */
@@ -0,0 +1,20 @@
+/**
+ * @file pgmspace.h
+ *
+ * Host replacement of <avr/pgmspace.h> for tools/replay: there is only one
+ * address space.
+ */
+
+#ifndef REPLAY_AVR_PGMSPACE_H_
+#define REPLAY_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define strlen_P strlen
+
+#endif /* REPLAY_AVR_PGMSPACE_H_ */
@@ -0,0 +1,25 @@
+/**
+ * @file uart_cfg.h
+ *
+ * UART configuration of the firmware for tools/replay (replaces
+ * src/cfg/io/uart/uart_cfg.h). Received packets are fed byte by byte with the
+ * escape framing, i.e. without COMM_RX_ISR_FRAMING, and are therefore handled
+ * in the order they were recorded.
+ */
+
+#ifndef UART_CFG_H_
+#define UART_CFG_H_
+
+#define USB         0
+#define WIFI        1
+
+#define COMM_UART WIFI
+
+#define COMM_RECV_BUFFER_SIZE 1024
+
+#define USE_UART1
+#define UART1_TX_BUFFER_SIZE 256
+#define UART1_RX_BUFFER_SIZE 128
+#define BAUD_RATE1 500000
+
+#endif /* UART_CFG_H_ */
@@ -0,0 +1,22 @@
+/**
+ * @file adc.h
+ *
+ * Host replacement of lib/io/adc/adc.h for tools/replay: the values of all
+ * channels are set by the replay (see replay_adc in hardware.h).
+ */
+
+#ifndef ADC_H_
+#define ADC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ADC_CHANNEL_COUNT 3
+
+void ADC_init(const bool disableJTAG);
+
+uint16_t ADC_getFilteredValue(const uint8_t channel);
+
+uint16_t ADC_getLastValue(const uint8_t channel);
+
+#endif /* ADC_H_ */
@@ -0,0 +1,17 @@
+/**
+ * @file math.h
+ *
+ * Host extension of <math.h> for tools/replay by the functions of avr-libc
+ * which are missing in the C library of the host.
+ */
+
+#ifndef REPLAY_MATH_H_
+#define REPLAY_MATH_H_
+
+#include_next <math.h>
+
+static inline double square(double x) {
+    return x * x;
+}
+
+#endif /* REPLAY_MATH_H_ */
@@ -0,0 +1,17 @@
+/**
+ * @file stdio.h
+ *
+ * Host extension of <stdio.h> for tools/replay by the functions of avr-libc
+ * which are missing in the C library of the host (see hardware.c).
+ */
+
+#ifndef REPLAY_STDIO_H_
+#define REPLAY_STDIO_H_
+
+#include_next <stdio.h>
+
+#include <stdarg.h>
+
+int vsnprintf_P(char* s, size_t n, const char* format, va_list ap);
+
+#endif /* REPLAY_STDIO_H_ */
@@ -0,0 +1,50 @@
+/**
+ * @file timeTask.h
+ *
+ * Host replacement of lib/tools/timeTask/timeTask.h for tools/replay: the
+ * uptime is the recorded uptime of the current iteration of the main loop
+ * (see replay_uptime in hardware.h), so timeTask_latchUptime() has nothing to
+ * do.
+ */
+
+#ifndef TIMETASK_H_
+#define TIMETASK_H_
+
+#include <stdint.h>
+
+#define CYCLETASK(name, cycles) static uint32_t name = 0; if (! (name = (name > cycles) ? 0 : (name + 1)))
+
+#define TIMETASK(name, interval_ms)                                      \
+    static uint16_t name = 0;                                            \
+    register uint16_t tt_uptime_##name = timeTask_getTaskUptime();       \
+    register uint8_t tt_ex_##name = 0;                                   \
+    if ((tt_uptime_##name - name) >= (uint16_t)interval_ms) {            \
+        name = tt_uptime_##name;                                         \
+        tt_ex_##name = 1;                                                \
+    }                                                                    \
+    if (tt_ex_##name)
+
+typedef struct {
+	uint32_t time_ms;
+	uint16_t time_us;
+} timeTask_time_t;
+
+void timeTask_init(void);
+
+static inline uint16_t timeTask_getUptime(void) {
+	extern uint16_t replay_uptime;
+	return replay_uptime;
+}
+
+static inline void timeTask_latchUptime(void) {
+}
+
+static inline uint16_t timeTask_getTaskUptime(void) {
+	return timeTask_getUptime();
+}
+
+void timeTask_getTimestamp(timeTask_time_t* timestamp);
+
+uint32_t timeTask_getDuration(const timeTask_time_t* startTime, const timeTask_time_t* stopTime);
+
+#endif /* TIMETASK_H_ */
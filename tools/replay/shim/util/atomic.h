@@ -0,0 +1,15 @@
+/**
+ * @file atomic.h
+ *
+ * Host replacement of <util/atomic.h> for tools/replay: there are no
+ * interrupts, so every block is atomic.
+ */
+
+#ifndef REPLAY_UTIL_ATOMIC_H_
+#define REPLAY_UTIL_ATOMIC_H_
+
+#define ATOMIC_BLOCK(type) for (int atomic_once = 1; atomic_once; atomic_once = 0)
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+
+#endif /* REPLAY_UTIL_ATOMIC_H_ */
@@ -0,0 +1,24 @@
+/**
+ * @file crc16.h
+ *
+ * Host replacement of <util/crc16.h> for tools/replay: the C equivalent of
+ * the CRC given in the avr-libc documentation.
+ */
+
+#ifndef REPLAY_UTIL_CRC16_H_
+#define REPLAY_UTIL_CRC16_H_
+
+#include <stdint.h>
+
+static inline uint16_t _crc16_update(uint16_t crc, uint8_t a) {
+    crc ^= a;
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (crc & 1)
+            crc = (crc >> 1) ^ 0xA001;
+        else
+            crc = (crc >> 1);
+    }
+    return crc;
+}
+
+#endif /* REPLAY_UTIL_CRC16_H_ */
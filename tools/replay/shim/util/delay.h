@@ -0,0 +1,13 @@
+/**
+ * @file delay.h
+ *
+ * Host replacement of <util/delay.h> for tools/replay: delays take no time.
+ */
+
+#ifndef REPLAY_UTIL_DELAY_H_
+#define REPLAY_UTIL_DELAY_H_
+
+#define _delay_ms(ms) ((void)(ms))
+#define _delay_us(us) ((void)(us))
+
+#endif /* REPLAY_UTIL_DELAY_H_ */